@@ -0,0 +1,181 @@
+/*
+ * BenchmarkProcessors.h
+ * LightHost - 基準測試用的合成處理器
+ *
+ * 功能說明：
+ * - 不依賴任何外掛格式，可在 CI 上組成 AudioProcessorGraph
+ * - Gain：最輕量的處理（近似只測量圖與回調的開銷）
+ * - Biquad：每通道一個二階濾波器（典型 EQ 負載）
+ * - Burn：每個樣本固定次數的運算（模擬較重的外掛）
+ * - 預設為立體聲，也可指定通道數（單聲道 / 立體聲 / 多通道），用於混合通道數的圖形
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <cmath>
+#include <vector>
+
+/**
+ * SyntheticProcessor 類別
+ * 輸入/輸出通道數相同（預設立體聲）、無編輯器、無狀態的處理器基底
+ */
+class SyntheticProcessor : public juce::AudioProcessor
+{
+public:
+    explicit SyntheticProcessor(const juce::String &processorName, int numChannels = 2)
+        : AudioProcessor(BusesProperties()
+                             .withInput("Input", getChannelSet(numChannels))
+                             .withOutput("Output", getChannelSet(numChannels))),
+          name(processorName)
+    {
+    }
+
+    static juce::AudioChannelSet getChannelSet(int numChannels)
+    {
+        return numChannels <= 2 ? juce::AudioChannelSet::canonicalChannelSet(juce::jmax(1, numChannels))
+                                : juce::AudioChannelSet::discreteChannels(numChannels);
+    }
+
+    const juce::String getName() const override { return name; }
+    void releaseResources() override {}
+
+    double getTailLengthSeconds() const override { return 0.0; }
+    bool acceptsMidi() const override { return false; }
+    bool producesMidi() const override { return false; }
+
+    juce::AudioProcessorEditor *createEditor() override { return nullptr; }
+    bool hasEditor() const override { return false; }
+
+    int getNumPrograms() override { return 1; }
+    int getCurrentProgram() override { return 0; }
+    void setCurrentProgram(int) override {}
+    const juce::String getProgramName(int) override { return {}; }
+    void changeProgramName(int, const juce::String &) override {}
+
+    void getStateInformation(juce::MemoryBlock &) override {}
+    void setStateInformation(const void *, int) override {}
+
+private:
+    juce::String name;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticProcessor)
+};
+
+//==============================================================================
+/** 固定增益 */
+class GainProcessor : public SyntheticProcessor
+{
+public:
+    explicit GainProcessor(float gainToUse = 0.9f, int numChannels = 2)
+        : SyntheticProcessor("Gain", numChannels), gain(gainToUse) {}
+
+    void prepareToPlay(double, int) override {}
+
+    void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &) override
+    {
+        buffer.applyGain(gain);
+    }
+
+private:
+    float gain;
+};
+
+//==============================================================================
+/** 每通道一個 1 kHz 低通二階濾波器（RBJ cookbook, Direct Form I） */
+class BiquadProcessor : public SyntheticProcessor
+{
+public:
+    explicit BiquadProcessor(int numChannels = 2) : SyntheticProcessor("Biquad", numChannels) {}
+
+    void prepareToPlay(double sampleRate, int) override
+    {
+        const double w0 = juce::MathConstants<double>::twoPi * 1000.0 / sampleRate;
+        const double alpha = std::sin(w0) / (2.0 * 0.7071);
+        const double cosW0 = std::cos(w0);
+        const double a0 = 1.0 + alpha;
+
+        b0 = (float)(((1.0 - cosW0) * 0.5) / a0);
+        b1 = (float)((1.0 - cosW0) / a0);
+        b2 = b0;
+        a1 = (float)((-2.0 * cosW0) / a0);
+        a2 = (float)((1.0 - alpha) / a0);
+
+        state.assign((size_t)getTotalNumOutputChannels(), {});
+    }
+
+    void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &) override
+    {
+        const int numChannels = juce::jmin(buffer.getNumChannels(), (int)state.size());
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto &s = state[(size_t)ch];
+            float *data = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const float x = data[i];
+                const float y = b0 * x + b1 * s.x1 + b2 * s.x2 - a1 * s.y1 - a2 * s.y2;
+                s.x2 = s.x1;
+                s.x1 = x;
+                s.y2 = s.y1;
+                s.y1 = y;
+                data[i] = y;
+            }
+        }
+    }
+
+private:
+    struct ChannelState
+    {
+        float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+    };
+
+    std::vector<ChannelState> state;
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+};
+
+//==============================================================================
+/** 每個樣本執行固定次數的非線性運算，模擬 CPU 負載較重的外掛 */
+class BurnProcessor : public SyntheticProcessor
+{
+public:
+    explicit BurnProcessor(int iterationsPerSample = 32, int numChannels = 2)
+        : SyntheticProcessor("Burn", numChannels), iterations(iterationsPerSample) {}
+
+    void prepareToPlay(double, int) override {}
+
+    void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &) override
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            float *data = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                float x = data[i];
+                for (int n = 0; n < iterations; ++n)
+                    x = 0.999f * std::tanh(x * 1.0001f);
+                data[i] = x;
+            }
+        }
+    }
+
+private:
+    int iterations;
+};
+
+//==============================================================================
+/**
+ * createBenchmarkProcessor() 函數
+ * 依名稱建立合成處理器（"gain" / "biquad" / "burn"），未知名稱回傳 nullptr
+ */
+inline std::unique_ptr<juce::AudioProcessor> createBenchmarkProcessor(const juce::String &kind)
+{
+    if (kind.equalsIgnoreCase("gain"))
+        return std::make_unique<GainProcessor>();
+    if (kind.equalsIgnoreCase("biquad"))
+        return std::make_unique<BiquadProcessor>();
+    if (kind.equalsIgnoreCase("burn"))
+        return std::make_unique<BurnProcessor>();
+    return nullptr;
+}
@@ -0,0 +1,309 @@
+/*
+ * CallbackBenchmark.cpp
+ * LightHost - Voicemeeter 回調基準測試（無 GUI）
+ *
+ * 功能說明：
+ * - 以 Voicemeeter Remote stand-in 驅動 VoicemeeterAudioIODevice
+ * - 回調經由 AudioProcessorPlayer 送入 AudioProcessorGraph（Input -> 合成處理器 -> Output）
+ * - 報告每個緩衝區的回調耗時百分位數、吞吐量與即時倍率
+ *
+ * 用法：
+ *   CallbackBenchmark [--seconds=5] [--type=3] [--sr=48000] [--nbs=480]
+ *                     [--nbi=0] [--nbo=0] [--device="Output A1"]
+ *                     [--plugins=biquad,gain,burn*2 | none] [--change-every=0]
+ *                     [--restart-every=0] [--restart-down=0.5]
+ *                     [--block=0] [--freerun] [--json]
+ *
+ * --freerun 時 stand-in 不依緩衝區週期節拍，可測得最大吞吐量；
+ * 預設的即時模式可觀察排程抖動與錯過期限的緩衝區數；
+ * --plugins=none 時圖形只有 Input -> Output，量測的是直通快速路徑；
+ * --block=B 時圖形固定以 B 個樣本處理（重新分塊）；
+ * --restart-every=S 每 S 秒模擬一次 Voicemeeter 重新啟動（離線 --restart-down 秒），
+ * 由設備的看門狗重新連線並報告音頻中斷時間
+ */
+
+#include "JuceHeader.h"
+#include "VoicemeeterAudioDevice.h"
+#include "VoicemeeterRemoteStandIn.h"
+#include "BenchmarkProcessors.h"
+#include "GraphAnalysis.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+    struct Options
+    {
+        double seconds = 5.0;
+        double changeEverySeconds = 0.0; // 0 = 不模擬 Voicemeeter 重新配置
+        double restartEverySeconds = 0.0; // 0 = 不模擬 Voicemeeter 重新啟動
+        double restartDownSeconds = 0.5;  // 每次重新啟動時伺服器離線的時間
+        int fixedBlockSize = 0;          // 0 = 跟隨 Voicemeeter 的緩衝區大小
+        juce::String deviceName;         // 空字串 = 第一個設備
+        juce::StringArray plugins;
+        bool json = false;
+        VoicemeeterStandIn::Config config;
+    };
+
+    Options parseOptions(const juce::ArgumentList &args)
+    {
+        Options options;
+
+        auto readValue = [&args](const juce::String &option, auto fallback)
+        {
+            if (!args.containsOption(option))
+                return fallback;
+            return (decltype(fallback))args.getValueForOption(option).getDoubleValue();
+        };
+
+        options.seconds = juce::jmax(0.1, readValue("--seconds", options.seconds));
+        options.changeEverySeconds = juce::jmax(0.0, readValue("--change-every", options.changeEverySeconds));
+        options.restartEverySeconds = juce::jmax(0.0, readValue("--restart-every", options.restartEverySeconds));
+        options.restartDownSeconds = juce::jmax(0.0, readValue("--restart-down", options.restartDownSeconds));
+        options.fixedBlockSize = juce::jmax(0, readValue("--block", options.fixedBlockSize));
+        options.json = args.containsOption("--json");
+
+        auto &config = options.config;
+        config.voicemeeterType = readValue("--type", config.voicemeeterType);
+        config.sampleRate = readValue("--sr", config.sampleRate);
+        config.samplesPerFrame = readValue("--nbs", config.samplesPerFrame);
+        config.numInputs = readValue("--nbi", config.numInputs);
+        config.numOutputs = readValue("--nbo", config.numOutputs);
+        config.realtime = !args.containsOption("--freerun");
+
+        if (args.containsOption("--device"))
+            options.deviceName = args.getValueForOption("--device").unquoted();
+
+        // "biquad,gain*4" -> biquad, gain, gain, gain, gain
+        const auto pluginList = args.containsOption("--plugins") ? args.getValueForOption("--plugins") : juce::String("biquad,gain");
+        for (auto entry : juce::StringArray::fromTokens(pluginList, ",", {}))
+        {
+            entry = entry.trim();
+            if (entry.isEmpty() || entry.equalsIgnoreCase("none"))
+                continue;
+
+            const int repeat = entry.containsChar('*') ? juce::jmax(1, entry.fromFirstOccurrenceOf("*", false, false).getIntValue()) : 1;
+            const auto kind = entry.upToFirstOccurrenceOf("*", false, false).trim();
+            for (int i = 0; i < repeat; ++i)
+                options.plugins.add(kind);
+        }
+
+        return options;
+    }
+
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        if (sorted.empty())
+            return 0.0;
+        const auto index = (size_t)std::llround(p * (double)(sorted.size() - 1));
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    /**
+     * buildGraph() 函數
+     * 建立 Input -> plugins... -> Output 的串聯鏈（通道 0、1）
+     */
+    juce::String buildGraph(juce::AudioProcessorGraph &graph, const juce::StringArray &plugins)
+    {
+        using IOProcessor = juce::AudioProcessorGraph::AudioGraphIOProcessor;
+        using UpdateKind = juce::AudioProcessorGraph::UpdateKind;
+
+        auto input = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioInputNode), {}, UpdateKind::none);
+        auto output = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioOutputNode), {}, UpdateKind::none);
+
+        auto previous = input->nodeID;
+        for (const auto &kind : plugins)
+        {
+            auto processor = createBenchmarkProcessor(kind);
+            if (processor == nullptr)
+                return "Unknown processor: " + kind;
+
+            auto node = graph.addNode(std::move(processor), {}, UpdateKind::none);
+            for (int ch = 0; ch < 2; ++ch)
+                graph.addConnection({{previous, ch}, {node->nodeID, ch}}, UpdateKind::none);
+            previous = node->nodeID;
+        }
+
+        for (int ch = 0; ch < 2; ++ch)
+            graph.addConnection({{previous, ch}, {output->nodeID, ch}}, UpdateKind::none);
+
+        graph.rebuild();
+        return {};
+    }
+
+    void report(const Options &options, const VoicemeeterStandIn::Timings &timings,
+                const VoicemeeterAudioIODevice::RecoveryStats &recovery,
+                const VoicemeeterAudioIODevice::ReconnectStats &reconnect,
+                const DeadlineMonitor::Snapshot &deadline)
+    {
+        std::vector<double> sorted = timings.callbackSeconds;
+        std::sort(sorted.begin(), sorted.end());
+
+        const double toMicros = 1.0e6;
+        const double mean = sorted.empty() ? 0.0 : std::accumulate(sorted.begin(), sorted.end(), 0.0) / (double)sorted.size();
+        const double period = timings.sampleRate > 0 ? (double)timings.samplesPerFrame / (double)timings.sampleRate : 0.0;
+        const double samplesPerSecond = timings.wallSeconds > 0.0
+                                            ? (double)timings.numBuffers * (double)timings.samplesPerFrame / timings.wallSeconds
+                                            : 0.0;
+        const double realtimeFactor = timings.sampleRate > 0 ? samplesPerSecond / (double)timings.sampleRate : 0.0;
+        const double dspLoad = period > 0.0 ? mean / period : 0.0;
+
+        if (options.json)
+        {
+            auto *result = new juce::DynamicObject();
+            result->setProperty("mode", options.config.realtime ? "realtime" : "freerun");
+            result->setProperty("voicemeeterType", (int)options.config.voicemeeterType);
+            result->setProperty("sampleRate", (int)timings.sampleRate);
+            result->setProperty("samplesPerFrame", (int)timings.samplesPerFrame);
+            result->setProperty("fixedBlockSize", options.fixedBlockSize);
+            result->setProperty("plugins", options.plugins.joinIntoString(","));
+            result->setProperty("buffers", (juce::int64)timings.numBuffers);
+            result->setProperty("lateBuffers", (juce::int64)timings.numLateBuffers);
+            result->setProperty("p50_us", percentile(sorted, 0.50) * toMicros);
+            result->setProperty("p90_us", percentile(sorted, 0.90) * toMicros);
+            result->setProperty("p99_us", percentile(sorted, 0.99) * toMicros);
+            result->setProperty("p999_us", percentile(sorted, 0.999) * toMicros);
+            result->setProperty("max_us", sorted.empty() ? 0.0 : sorted.back() * toMicros);
+            result->setProperty("mean_us", mean * toMicros);
+            result->setProperty("samplesPerSecond", samplesPerSecond);
+            result->setProperty("realtimeFactor", realtimeFactor);
+            result->setProperty("dspLoad", dspLoad);
+            result->setProperty("recoveries", recovery.numRecoveries);
+            result->setProperty("maxRecovery_ms", recovery.maxMilliseconds);
+            result->setProperty("reconnects", reconnect.numReconnects);
+            result->setProperty("reconnectAttempts", reconnect.numAttempts);
+            result->setProperty("maxGap_ms", reconnect.maxGapMilliseconds);
+            result->setProperty("deviceOverruns", (juce::int64)deadline.numOverruns);
+            result->setProperty("deviceP99Load", deadline.p99Load);
+            result->setProperty("deviceMaxLoad", deadline.maxLoad);
+            std::cout << juce::JSON::toString(juce::var(result)) << std::endl;
+            return;
+        }
+
+        auto micros = [&](double seconds)
+        { return juce::String(seconds * toMicros, 2); };
+
+        std::cout << "LightHost callback benchmark (" << (options.config.realtime ? "realtime" : "freerun") << ")\n"
+                  << "  type=" << options.config.voicemeeterType
+                  << " sr=" << timings.sampleRate
+                  << " nbs=" << timings.samplesPerFrame
+                  << (options.fixedBlockSize > 0 ? " block=" + juce::String(options.fixedBlockSize) : juce::String())
+                  << " plugins=[" << options.plugins.joinIntoString(",") << "]"
+                  << (options.plugins.isEmpty() ? " (pass-through)" : "") << "\n"
+                  << "  buffers=" << timings.numBuffers << " late=" << timings.numLateBuffers << "\n"
+                  << "  callback us: p50=" << micros(percentile(sorted, 0.50))
+                  << " p90=" << micros(percentile(sorted, 0.90))
+                  << " p99=" << micros(percentile(sorted, 0.99))
+                  << " p99.9=" << micros(percentile(sorted, 0.999))
+                  << " max=" << micros(sorted.empty() ? 0.0 : sorted.back())
+                  << " mean=" << micros(mean) << "\n"
+                  << "  throughput=" << juce::String(samplesPerSecond, 0) << " samples/s"
+                  << " realtime factor=" << juce::String(realtimeFactor, 2) << "x"
+                  << " dsp load=" << juce::String(dspLoad * 100.0, 2) << "%" << "\n"
+                  << "  device monitor: overruns=" << deadline.numOverruns << "/" << deadline.numBuffers
+                  << " load p99=" << juce::String(deadline.p99Load * 100.0, 1) << "%"
+                  << " p99.9=" << juce::String(deadline.p999Load * 100.0, 1) << "%"
+                  << " max=" << juce::String(deadline.maxLoad * 100.0, 1) << "%\n";
+
+        if (recovery.numRecoveries > 0)
+            std::cout << "  recoveries=" << recovery.numRecoveries
+                      << " last=" << juce::String(recovery.lastMilliseconds, 2) << " ms"
+                      << " max=" << juce::String(recovery.maxMilliseconds, 2) << " ms\n";
+        if (reconnect.numAttempts > 0)
+            std::cout << "  reconnects=" << reconnect.numReconnects << " attempts=" << reconnect.numAttempts
+                      << " gap last=" << juce::String(reconnect.lastGapMilliseconds, 1) << " ms"
+                      << " max=" << juce::String(reconnect.maxGapMilliseconds, 1) << " ms\n";
+        std::cout << std::flush;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto options = parseOptions(juce::ArgumentList(argc, argv));
+    VoicemeeterStandIn::setConfig(options.config);
+
+    // 即時模式的緩衝區數可預估；全速模式保留足夠大的上限，超出的緩衝區只計數不記錄
+    const double buffersPerSecond = (double)options.config.sampleRate / (double)juce::jmax(1L, options.config.samplesPerFrame);
+    const auto capacity = options.config.realtime ? (size_t)(options.seconds * buffersPerSecond * 1.25) + 64 : (size_t)4000000;
+    VoicemeeterStandIn::reserveTimings(capacity);
+
+    juce::AudioProcessorGraph graph;
+    if (auto error = buildGraph(graph, options.plugins); error.isNotEmpty())
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    juce::AudioProcessorPlayer player;
+    player.setProcessor(&graph);
+
+    VoicemeeterAudioIODeviceType deviceType;
+    deviceType.setFixedBlockSize(options.fixedBlockSize);
+    deviceType.scanForDevices();
+
+    const auto deviceNames = deviceType.getDeviceNames();
+    const auto deviceName = options.deviceName.isNotEmpty() ? options.deviceName : deviceNames[0];
+    std::unique_ptr<juce::AudioIODevice> device(deviceType.createDevice(deviceName, deviceName));
+    if (device == nullptr)
+    {
+        std::cerr << "Unknown device: " << deviceName << " (available: " << deviceNames.joinIntoString(", ") << ")" << std::endl;
+        return 1;
+    }
+
+    juce::BigInteger channels;
+    channels.setRange(0, 2, true);
+    if (auto error = device->open(channels, channels, (double)options.config.sampleRate, (int)options.config.samplesPerFrame); error.isNotEmpty())
+    {
+        std::cerr << "open() failed: " << error << std::endl;
+        return 1;
+    }
+
+    // Same decision IconMenu makes when the wiring changes
+    auto *voicemeeterDevice = dynamic_cast<VoicemeeterAudioIODevice *>(device.get());
+    if (voicemeeterDevice != nullptr)
+    {
+        voicemeeterDevice->setPassThrough(GraphAnalysis::isPassThrough(graph, channels.countNumberOfSetBits()));
+        voicemeeterDevice->setGraphLatencySamples(graph.getLatencySamples());
+    }
+
+    device->start(&player);
+
+    // 讓訊息執行緒持續運作：STARTING 的重新準備與 CHANGE 後的重新啟動都在訊息執行緒完成
+    auto *messageManager = juce::MessageManager::getInstance();
+    const auto endTime = juce::Time::getMillisecondCounterHiRes() + options.seconds * 1000.0;
+    auto nextChange = options.changeEverySeconds > 0.0 ? juce::Time::getMillisecondCounterHiRes() + options.changeEverySeconds * 1000.0
+                                                       : endTime;
+    auto nextRestart = options.restartEverySeconds > 0.0 ? juce::Time::getMillisecondCounterHiRes() + options.restartEverySeconds * 1000.0
+                                                         : endTime;
+
+    for (auto now = juce::Time::getMillisecondCounterHiRes(); now < endTime; now = juce::Time::getMillisecondCounterHiRes())
+    {
+        if (now >= nextChange)
+        {
+            VoicemeeterStandIn::triggerChange(options.config);
+            nextChange += options.changeEverySeconds * 1000.0;
+        }
+
+        if (now >= nextRestart)
+        {
+            VoicemeeterStandIn::triggerEngineRestart(options.restartDownSeconds);
+            nextRestart += options.restartEverySeconds * 1000.0;
+        }
+
+        messageManager->runDispatchLoopUntil((int)juce::jlimit(1.0, 100.0, juce::jmin(endTime, nextChange, nextRestart) - now));
+    }
+
+    const auto recovery = voicemeeterDevice != nullptr ? voicemeeterDevice->getRecoveryStats() : VoicemeeterAudioIODevice::RecoveryStats{};
+    const auto reconnect = voicemeeterDevice != nullptr ? voicemeeterDevice->getReconnectStats() : VoicemeeterAudioIODevice::ReconnectStats{};
+    const auto deadline = voicemeeterDevice != nullptr ? voicemeeterDevice->getDeadlineMonitor().getSnapshot() : DeadlineMonitor::Snapshot{};
+    device->stop();
+    device->close();
+    player.setProcessor(nullptr);
+
+    report(options, VoicemeeterStandIn::takeTimings(), recovery, reconnect, deadline);
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * ChannelMapBenchmark.cpp
+ * LightHost - 通道指標收集的微基準測試
+ *
+ * 比較兩種在每次 BUFFER 回調中建立 JUCE 通道指標陣列的方式：
+ * - legacy：逐一測試 juce::BigInteger 位元並重新計算 inBase / outBase / availableIn / availableOut
+ *           （VoicemeeterChannelMap 之前 handleVoicemeeterCallback 的做法）
+ * - map：  以 VoicemeeterChannelMap 預先計算的對照表收集指標
+ *
+ * 用法：
+ *   ChannelMapBenchmark [--iterations=20000000] [--json]
+ */
+
+#include "JuceHeader.h"
+#include "VoicemeeterChannelMap.h"
+#include "VoicemeeterLayout.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    constexpr int channelsPerBus = VoicemeeterChannelMap::channelsPerBus;
+
+    // Keeps the optimiser from discarding the gathered pointers
+    volatile std::uintptr_t sink = 0;
+
+    void consume(const float *const *inputs, int numInputs, float *const *outputs, int numOutputs)
+    {
+        std::uintptr_t acc = 0;
+        for (int i = 0; i < numInputs; ++i)
+            acc ^= (std::uintptr_t)inputs[i];
+        for (int i = 0; i < numOutputs; ++i)
+            acc ^= (std::uintptr_t)outputs[i];
+        sink = sink + acc;
+    }
+
+    /** 與舊版 handleVoicemeeterCallback 相同的逐位元做法 */
+    void gatherLegacy(const VBVMR_T_AUDIOBUFFER &buffer, int inputBusIndex, int outputBusIndex,
+                      const juce::BigInteger &activeInputChannels, const juce::BigInteger &activeOutputChannels)
+    {
+        const int nbi = buffer.audiobuffer_nbi;
+        const int nbo = buffer.audiobuffer_nbo;
+        const int inBase = inputBusIndex * channelsPerBus;
+        const int outBase = outputBusIndex * channelsPerBus;
+        const int availableIn = juce::jmin(channelsPerBus, juce::jmax(0, nbi - inBase));
+        const int availableOut = juce::jmin(channelsPerBus, juce::jmax(0, nbo - outBase));
+
+        if (availableIn <= 0 && availableOut <= 0)
+            return;
+
+        const float *inputPtrs[channelsPerBus] = {};
+        float *outputPtrs[channelsPerBus] = {};
+        int numActiveIn = 0;
+        int numActiveOut = 0;
+
+        for (int ch = 0; ch < channelsPerBus; ++ch)
+            if (activeInputChannels[ch])
+                inputPtrs[numActiveIn++] = ch < availableIn ? buffer.audiobuffer_r[inBase + ch] : nullptr;
+
+        for (int ch = 0; ch < channelsPerBus; ++ch)
+            if (activeOutputChannels[ch])
+                outputPtrs[numActiveOut++] = ch < availableOut ? buffer.audiobuffer_w[outBase + ch] : nullptr;
+
+        consume(inputPtrs, numActiveIn, outputPtrs, numActiveOut);
+    }
+
+    struct Scenario
+    {
+        const char *name;
+        int inputBusIndex;
+        int outputBusIndex;
+        std::uint32_t mask;
+    };
+
+    struct Result
+    {
+        double legacyNanos = 0.0;
+        double mapNanos = 0.0;
+    };
+
+    template <typename Body>
+    double nanosPerCall(std::int64_t iterations, Body &&body)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::int64_t i = 0; i < iterations; ++i)
+            body();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / (double)iterations;
+    }
+
+    Result run(const Scenario &scenario, VBVMR_T_AUDIOBUFFER &buffer, std::int64_t iterations)
+    {
+        juce::BigInteger activeChannels;
+        for (int ch = 0; ch < channelsPerBus; ++ch)
+            if ((scenario.mask & (1u << ch)) != 0)
+                activeChannels.setBit(ch);
+
+        VoicemeeterChannelMap map;
+        map.setSelection(scenario.inputBusIndex * channelsPerBus, scenario.outputBusIndex * channelsPerBus,
+                         scenario.mask, scenario.mask);
+        map.resolve(buffer.audiobuffer_nbi, buffer.audiobuffer_nbo);
+
+        static float silence[16] = {};
+        static float scratch[16] = {};
+
+        Result result;
+        result.legacyNanos = nanosPerCall(iterations, [&]
+                                          { gatherLegacy(buffer, scenario.inputBusIndex, scenario.outputBusIndex, activeChannels, activeChannels); });
+        result.mapNanos = nanosPerCall(iterations, [&]
+                                       {
+                                           const float *inputs[channelsPerBus];
+                                           float *outputs[channelsPerBus];
+                                           map.gather(buffer, inputs, outputs, silence, scratch);
+                                           consume(inputs, map.getInput().numActive, outputs, map.getOutput().numActive); });
+        return result;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const juce::ArgumentList args(argc, argv);
+    const auto iterations = args.containsOption("--iterations")
+                                ? juce::jmax((juce::int64)1, args.getValueForOption("--iterations").getLargeIntValue())
+                                : (juce::int64)20000000;
+    const bool json = args.containsOption("--json");
+
+    // Potato OUT-mode buffer: 8 buses x 8 channels in both directions
+    const int numChannels = VoicemeeterLayout::forType(3).getNumBusChannels();
+    std::vector<float> storage((size_t)numChannels * 2, 0.0f);
+    VBVMR_T_AUDIOBUFFER buffer{};
+    buffer.audiobuffer_sr = 48000;
+    buffer.audiobuffer_nbs = 1;
+    buffer.audiobuffer_nbi = numChannels;
+    buffer.audiobuffer_nbo = numChannels;
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        buffer.audiobuffer_r[ch] = storage.data() + ch;
+        buffer.audiobuffer_w[ch] = storage.data() + numChannels + ch;
+    }
+
+    const Scenario scenarios[] = {
+        {"stereo A1", 0, 0, 0x03u},
+        {"octet B1", 5, 5, 0xFFu},
+        {"sparse A3->B2", 2, 6, 0xA5u},
+    };
+
+    auto *jsonResults = json ? new juce::DynamicObject() : nullptr;
+    juce::var jsonVar(jsonResults);
+
+    for (const auto &scenario : scenarios)
+    {
+        const auto result = run(scenario, buffer, iterations);
+        const double speedup = result.mapNanos > 0.0 ? result.legacyNanos / result.mapNanos : 0.0;
+
+        if (jsonResults != nullptr)
+        {
+            auto *entry = new juce::DynamicObject();
+            entry->setProperty("legacy_ns", result.legacyNanos);
+            entry->setProperty("map_ns", result.mapNanos);
+            entry->setProperty("speedup", speedup);
+            jsonResults->setProperty(scenario.name, juce::var(entry));
+        }
+        else
+        {
+            std::cout << scenario.name << ": legacy=" << juce::String(result.legacyNanos, 2) << " ns"
+                      << " map=" << juce::String(result.mapNanos, 2) << " ns"
+                      << " speedup=" << juce::String(speedup, 2) << "x" << std::endl;
+        }
+    }
+
+    if (json)
+        std::cout << juce::JSON::toString(jsonVar) << std::endl;
+
+    return 0;
+}
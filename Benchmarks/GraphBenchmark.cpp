@@ -0,0 +1,379 @@
+/*
+ * GraphBenchmark.cpp
+ * LightHost - 圖形處理的基準測試套件（含回歸基準線）
+ *
+ * 以合成處理器組成的圖形，量測渲染器每個區塊的處理時間：
+ * - chain-N：  Input -> N 個處理器串接 -> Output（N 預設為 1, 2, 4, 8, 16, 32, 64）
+ * - fanout-N： Input -> N 條只有一個處理器的平行分支 -> 在 Output 匯流相加
+ * - mixed-N：  N 個處理器串接，通道數依序為 1 / 2 / 4 / 8（每個目的通道接來源的 ch % 來源通道數）
+ * 每個圖形在每種區塊大小（預設 32, 64, 128, 256, 480, 512, 1024）各量測一次
+ *
+ * 回歸基準線：
+ * - --save-baseline=<file> 把結果寫成 JSON
+ * - --baseline=<file> 與儲存的結果比較，任何一項的中位數比基準慢超過 --threshold 百分比
+ *   （預設 10）就以結束碼 3 結束；基準線中沒有的項目只列出、不比較
+ *
+ * 用法：
+ *   GraphBenchmark [--cases=chain,fanout,mixed] [--depths=1,2,4,8,16,32,64] [--widths=4,16,64]
+ *                  [--block-sizes=32,64,128,256,480,512,1024] [--processor=biquad] [--seconds=1]
+ *                  [--repeat=3] [--workers=0] [--renderer=plan|graph] [--json]
+ *                  [--save-baseline=<file>] [--baseline=<file>] [--threshold=10]
+ *
+ * --workers 預設為 0（計畫依序處理），讓基準線不受機器的核心數與排程影響；
+ * --renderer=graph 改用 AudioProcessorGraph::processBlock，可與 ParallelGraphProcessor 之前的做法比較
+ */
+
+#include "JuceHeader.h"
+#include "BenchmarkProcessors.h"
+#include "ParallelGraphProcessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+
+namespace
+{
+    using Graph = juce::AudioProcessorGraph;
+    using IOProcessor = Graph::AudioGraphIOProcessor;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int numIOChannels = 2;
+
+    struct Options
+    {
+        juce::StringArray cases{"chain", "fanout", "mixed"};
+        juce::Array<int> depths{1, 2, 4, 8, 16, 32, 64};
+        juce::Array<int> widths{4, 16, 64};
+        juce::Array<int> blockSizes{32, 64, 128, 256, 480, 512, 1024};
+        juce::String processor{"biquad"};
+        double seconds = 1.0; // Audio rendered per measurement
+        int repeat = 3;
+        int workers = 0;
+        bool useGraph = false;
+        bool json = false;
+        double thresholdPercent = 10.0;
+    };
+
+    struct Timing
+    {
+        double meanUs = 0.0;
+        double medianUs = 0.0;
+        double p99Us = 0.0;
+    };
+
+    /** 一個圖形：名稱與建立方式 */
+    struct Case
+    {
+        juce::String name;
+        std::function<void(Graph &)> build;
+    };
+
+    juce::Array<int> parseIntList(const juce::String &text)
+    {
+        juce::Array<int> values;
+        for (const auto &token : juce::StringArray::fromTokens(text, ",", {}))
+            if (token.getIntValue() > 0)
+                values.add(token.getIntValue());
+        return values;
+    }
+
+    std::unique_ptr<juce::AudioProcessor> createProcessor(const Options &options, int numChannels)
+    {
+        if (options.processor.equalsIgnoreCase("gain"))
+            return std::make_unique<GainProcessor>(0.9f, numChannels);
+        if (options.processor.equalsIgnoreCase("burn"))
+            return std::make_unique<BurnProcessor>(32, numChannels);
+        return std::make_unique<BiquadProcessor>(numChannels);
+    }
+
+    /** 每個目的通道接來源的 ch % 來源通道數 */
+    void connectChannels(Graph &graph, Graph::NodeID from, int fromChannels, Graph::NodeID to, int toChannels)
+    {
+        for (int ch = 0; ch < toChannels; ++ch)
+            graph.addConnection({{from, ch % fromChannels}, {to, ch}}, Graph::UpdateKind::none);
+    }
+
+    /** 串接 depth 個處理器；channelPattern 依序循環決定每個處理器的通道數 */
+    void buildChain(Graph &graph, const Options &options, int depth, const juce::Array<int> &channelPattern)
+    {
+        const auto input = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioInputNode))->nodeID;
+        const auto output = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioOutputNode))->nodeID;
+
+        auto previous = input;
+        int previousChannels = numIOChannels;
+        for (int i = 0; i < depth; ++i)
+        {
+            const int numChannels = channelPattern[i % channelPattern.size()];
+            const auto node = graph.addNode(createProcessor(options, numChannels), {}, Graph::UpdateKind::none)->nodeID;
+            connectChannels(graph, previous, previousChannels, node, numChannels);
+            previous = node;
+            previousChannels = numChannels;
+        }
+        connectChannels(graph, previous, previousChannels, output, numIOChannels);
+        graph.rebuild();
+    }
+
+    void buildFanOut(Graph &graph, const Options &options, int width)
+    {
+        const auto input = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioInputNode))->nodeID;
+        const auto output = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioOutputNode))->nodeID;
+
+        for (int branch = 0; branch < width; ++branch)
+        {
+            const auto node = graph.addNode(createProcessor(options, numIOChannels), {}, Graph::UpdateKind::none)->nodeID;
+            connectChannels(graph, input, numIOChannels, node, numIOChannels);
+            connectChannels(graph, node, numIOChannels, output, numIOChannels);
+        }
+        graph.rebuild();
+    }
+
+    std::vector<Case> makeCases(const Options &options)
+    {
+        std::vector<Case> cases;
+        for (const int depth : options.depths)
+        {
+            if (options.cases.contains("chain"))
+                cases.push_back({"chain-" + juce::String(depth), [&options, depth](Graph &graph)
+                                 { buildChain(graph, options, depth, {numIOChannels}); }});
+            if (options.cases.contains("mixed"))
+                cases.push_back({"mixed-" + juce::String(depth), [&options, depth](Graph &graph)
+                                 { buildChain(graph, options, depth, {1, 2, 4, 8}); }});
+        }
+        if (options.cases.contains("fanout"))
+            for (const int width : options.widths)
+                cases.push_back({"fanout-" + juce::String(width), [&options, width](Graph &graph)
+                                 { buildFanOut(graph, options, width); }});
+        return cases;
+    }
+
+    Timing measureOnce(const Options &options, const Case &benchmarkCase, int blockSize)
+    {
+        Graph graph;
+        graph.setPlayConfigDetails(numIOChannels, numIOChannels, sampleRate, blockSize);
+        benchmarkCase.build(graph);
+
+        ParallelGraphProcessor renderer(graph, options.workers);
+        std::function<void(juce::AudioBuffer<float> &, juce::MidiBuffer &)> render;
+        if (options.useGraph)
+        {
+            graph.prepareToPlay(sampleRate, blockSize);
+            render = [&graph](juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midi) { graph.processBlock(buffer, midi); };
+        }
+        else
+        {
+            renderer.setPlayConfigDetails(numIOChannels, numIOChannels, sampleRate, blockSize);
+            renderer.prepareToPlay(sampleRate, blockSize);
+            render = [&renderer](juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midi) { renderer.processBlock(buffer, midi); };
+        }
+
+        juce::AudioBuffer<float> source(numIOChannels, blockSize), buffer(numIOChannels, blockSize);
+        juce::Random random(0x4c48);
+        for (int ch = 0; ch < numIOChannels; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                source.setSample(ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+        // The same amount of audio at every block size, so small blocks are not measured on fewer samples
+        const int numBlocks = juce::jmax(64, juce::roundToInt(options.seconds * sampleRate / blockSize));
+        juce::MidiBuffer midi;
+        std::vector<double> microseconds;
+        microseconds.reserve((size_t)numBlocks);
+
+        // A few untimed blocks to warm the caches
+        for (int block = -16; block < numBlocks; ++block)
+        {
+            buffer.makeCopyOf(source, true);
+            const auto start = std::chrono::steady_clock::now();
+            render(buffer, midi);
+            const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            if (block >= 0)
+                microseconds.push_back(elapsed);
+        }
+
+        if (options.useGraph)
+            graph.releaseResources();
+        else
+            renderer.releaseResources();
+
+        Timing timing;
+        for (const auto value : microseconds)
+            timing.meanUs += value;
+        timing.meanUs /= (double)microseconds.size();
+        std::sort(microseconds.begin(), microseconds.end());
+        timing.medianUs = microseconds[microseconds.size() / 2];
+        timing.p99Us = microseconds[juce::jmin(microseconds.size() - 1, microseconds.size() * 99 / 100)];
+        return timing;
+    }
+
+    /** 重複量測，取中位數最小的一次（最不受其他程序干擾） */
+    Timing measure(const Options &options, const Case &benchmarkCase, int blockSize)
+    {
+        Timing best;
+        for (int run = 0; run < options.repeat; ++run)
+        {
+            const auto timing = measureOnce(options, benchmarkCase, blockSize);
+            if (run == 0 || timing.medianUs < best.medianUs)
+                best = timing;
+        }
+        return best;
+    }
+
+    juce::String getResultKey(const juce::var &result)
+    {
+        return result["case"].toString() + "@" + result["blockSize"].toString();
+    }
+
+    /**
+     * compareWithBaseline() 函數
+     * 列出比基準線慢超過門檻的項目
+     *
+     * @return 回歸的項目數
+     */
+    int compareWithBaseline(const juce::Array<juce::var> &results, const juce::var &baseline, double thresholdPercent)
+    {
+        std::map<juce::String, double> baselineMedians;
+        if (const auto *entries = baseline["results"].getArray())
+            for (const auto &entry : *entries)
+                baselineMedians[getResultKey(entry)] = (double)entry["median_us"];
+
+        int numRegressions = 0;
+        for (const auto &result : results)
+        {
+            const auto key = getResultKey(result);
+            const auto found = baselineMedians.find(key);
+            if (found == baselineMedians.end() || found->second <= 0.0)
+            {
+                std::cerr << "  " << key << ": not in the baseline" << std::endl;
+                continue;
+            }
+
+            const double changePercent = ((double)result["median_us"] / found->second - 1.0) * 100.0;
+            if (changePercent > thresholdPercent)
+            {
+                std::cerr << "  REGRESSION " << key << ": " << juce::String(found->second, 2) << " us -> "
+                          << juce::String((double)result["median_us"], 2) << " us (+" << juce::String(changePercent, 1) << "%)"
+                          << std::endl;
+                ++numRegressions;
+            }
+        }
+        return numRegressions;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::ArgumentList args(argc, argv);
+    auto readInt = [&args](const juce::String &option, int fallback)
+    { return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : fallback; };
+    auto readFile = [&args](const juce::String &option)
+    { return juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption(option).unquoted()); };
+
+    Options options;
+    if (args.containsOption("--cases"))
+        options.cases = juce::StringArray::fromTokens(args.getValueForOption("--cases").toLowerCase(), ",", {});
+    if (args.containsOption("--depths"))
+        options.depths = parseIntList(args.getValueForOption("--depths"));
+    if (args.containsOption("--widths"))
+        options.widths = parseIntList(args.getValueForOption("--widths"));
+    if (args.containsOption("--block-sizes"))
+        options.blockSizes = parseIntList(args.getValueForOption("--block-sizes"));
+    if (args.containsOption("--processor"))
+        options.processor = args.getValueForOption("--processor");
+    if (args.containsOption("--seconds"))
+        options.seconds = juce::jmax(0.01, args.getValueForOption("--seconds").getDoubleValue());
+    if (args.containsOption("--threshold"))
+        options.thresholdPercent = juce::jmax(0.0, args.getValueForOption("--threshold").getDoubleValue());
+    options.repeat = juce::jmax(1, readInt("--repeat", options.repeat));
+    options.workers = readInt("--workers", options.workers);
+    options.useGraph = args.getValueForOption("--renderer").equalsIgnoreCase("graph");
+    options.json = args.containsOption("--json");
+
+    if (createBenchmarkProcessor(options.processor) == nullptr)
+    {
+        std::cerr << "GraphBenchmark: unknown processor " << options.processor << " (gain, biquad or burn)" << std::endl;
+        return 1;
+    }
+
+    juce::var baseline;
+    if (args.containsOption("--baseline"))
+    {
+        const auto baselineFile = readFile("--baseline");
+        baseline = juce::JSON::parse(baselineFile);
+        if (baseline["results"].getArray() == nullptr)
+        {
+            std::cerr << "GraphBenchmark: cannot read baseline " << baselineFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    const int numWorkers = options.workers < 0 ? ParallelGraphExecutor::getDefaultNumWorkers() : options.workers;
+    const juce::String rendererName = options.useGraph ? "graph" : "plan";
+    if (!options.json)
+        std::cout << "LightHost graph benchmark (" << options.processor << " nodes, " << rendererName << " renderer, "
+                  << numWorkers << " workers, " << juce::SystemStats::getNumCpus() << " CPUs, median of the best of "
+                  << options.repeat << " runs)\n";
+
+    juce::Array<juce::var> results;
+    for (const auto &benchmarkCase : makeCases(options))
+    {
+        if (!options.json)
+            std::cout << "  " << benchmarkCase.name << ":";
+
+        for (const int blockSize : options.blockSizes)
+        {
+            const auto timing = measure(options, benchmarkCase, blockSize);
+            const double blockPeriodUs = blockSize * 1.0e6 / sampleRate;
+
+            auto *result = new juce::DynamicObject();
+            result->setProperty("case", benchmarkCase.name);
+            result->setProperty("blockSize", blockSize);
+            result->setProperty("median_us", timing.medianUs);
+            result->setProperty("mean_us", timing.meanUs);
+            result->setProperty("p99_us", timing.p99Us);
+            result->setProperty("ns_per_sample", timing.medianUs * 1000.0 / blockSize);
+            result->setProperty("load", timing.medianUs / blockPeriodUs);
+            results.add(juce::var(result));
+
+            if (!options.json)
+                std::cout << "  " << blockSize << "=" << juce::String(timing.medianUs, 1) << "us";
+        }
+        if (!options.json)
+            std::cout << std::endl;
+    }
+
+    auto *summary = new juce::DynamicObject();
+    summary->setProperty("benchmark", "GraphBenchmark");
+    summary->setProperty("processor", options.processor);
+    summary->setProperty("renderer", rendererName);
+    summary->setProperty("workers", numWorkers);
+    summary->setProperty("sampleRate", sampleRate);
+    summary->setProperty("cpus", juce::SystemStats::getNumCpus());
+    summary->setProperty("results", results);
+    const juce::var report(summary);
+
+    if (options.json)
+        std::cout << juce::JSON::toString(report) << std::endl;
+
+    if (args.containsOption("--save-baseline"))
+    {
+        const auto baselineFile = readFile("--save-baseline");
+        if (!baselineFile.replaceWithText(juce::JSON::toString(report)))
+        {
+            std::cerr << "GraphBenchmark: cannot write " << baselineFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!baseline.isVoid())
+    {
+        const int numRegressions = compareWithBaseline(results, baseline, options.thresholdPercent);
+        std::cerr << "GraphBenchmark: " << numRegressions << " regression(s) beyond " << juce::String(options.thresholdPercent, 1)
+                  << "% against the baseline" << std::endl;
+        if (numRegressions > 0)
+            return 3;
+    }
+    return 0;
+}
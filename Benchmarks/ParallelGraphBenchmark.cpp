@@ -0,0 +1,204 @@
+/*
+ * ParallelGraphBenchmark.cpp
+ * LightHost - 平行分支渲染的基準測試
+ *
+ * 圖形：Input -> B 條平行分支（每條 depth 個 Burn 處理器串接） -> Output（在 Output 匯流相加）
+ *
+ * 比較三種渲染方式，每個區塊的處理時間：
+ * - graph：    AudioProcessorGraph::processBlock（單一執行緒，ParallelGraphProcessor 之前的做法）
+ * - plan：     ParallelGraphProcessor，0 個工作執行緒（GraphRenderPlan 依序處理，量測計畫本身的開銷）
+ * - parallel： ParallelGraphProcessor，工作竊取執行緒池
+ *
+ * 用法：
+ *   ParallelGraphBenchmark [--branches=2,4,8] [--depth=2] [--iterations=32] [--blocks=1000]
+ *                          [--block=480] [--workers=-1] [--json]
+ */
+
+#include "JuceHeader.h"
+#include "BenchmarkProcessors.h"
+#include "ParallelGraphProcessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    using Graph = juce::AudioProcessorGraph;
+    using IOProcessor = Graph::AudioGraphIOProcessor;
+
+    constexpr double sampleRate = 48000.0;
+
+    struct Options
+    {
+        juce::Array<int> branches{2, 4, 8};
+        int depth = 2;
+        int iterations = 32;
+        int blocks = 1000;
+        int blockSize = 480;
+        int workers = -1;
+        bool json = false;
+    };
+
+    struct Timing
+    {
+        double meanUs = 0.0;
+        double medianUs = 0.0;
+    };
+
+    void buildBranches(Graph &graph, const Options &options, int numBranches)
+    {
+        graph.clear();
+        const auto input = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioInputNode))->nodeID;
+        const auto output = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioOutputNode))->nodeID;
+
+        for (int branch = 0; branch < numBranches; ++branch)
+        {
+            auto previous = input;
+            for (int i = 0; i < options.depth; ++i)
+            {
+                const auto node = graph.addNode(std::make_unique<BurnProcessor>(options.iterations), {}, Graph::UpdateKind::none)->nodeID;
+                for (int ch = 0; ch < 2; ++ch)
+                    graph.addConnection({{previous, ch}, {node, ch}}, Graph::UpdateKind::none);
+                previous = node;
+            }
+            for (int ch = 0; ch < 2; ++ch)
+                graph.addConnection({{previous, ch}, {output, ch}}, Graph::UpdateKind::none);
+        }
+        graph.rebuild();
+    }
+
+    template <typename Render>
+    Timing measure(const Options &options, Render &&render)
+    {
+        juce::AudioBuffer<float> source(2, options.blockSize), buffer(2, options.blockSize);
+        juce::Random random(0x4c48);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < options.blockSize; ++i)
+                source.setSample(ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+        juce::MidiBuffer midi;
+        std::vector<double> microseconds;
+        microseconds.reserve((size_t)options.blocks);
+
+        // A few untimed blocks to wake the workers and warm the caches
+        for (int block = -16; block < options.blocks; ++block)
+        {
+            buffer.makeCopyOf(source, true);
+            const auto start = std::chrono::steady_clock::now();
+            render(buffer, midi);
+            const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            if (block >= 0)
+                microseconds.push_back(elapsed);
+        }
+
+        Timing timing;
+        for (const auto value : microseconds)
+            timing.meanUs += value;
+        timing.meanUs /= (double)juce::jmax((size_t)1, microseconds.size());
+        std::sort(microseconds.begin(), microseconds.end());
+        timing.medianUs = microseconds.empty() ? 0.0 : microseconds[microseconds.size() / 2];
+        return timing;
+    }
+
+    Timing measureGraph(const Options &options, int numBranches)
+    {
+        Graph graph;
+        graph.setPlayConfigDetails(2, 2, sampleRate, options.blockSize);
+        buildBranches(graph, options, numBranches);
+        graph.prepareToPlay(sampleRate, options.blockSize);
+
+        const auto timing = measure(options, [&graph](juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midi)
+                                    { graph.processBlock(buffer, midi); });
+        graph.releaseResources();
+        return timing;
+    }
+
+    Timing measureRenderer(const Options &options, int numBranches, int numWorkers, bool &ranInParallel)
+    {
+        Graph graph;
+        buildBranches(graph, options, numBranches);
+
+        ParallelGraphProcessor renderer(graph, numWorkers);
+        renderer.setPlayConfigDetails(2, 2, sampleRate, options.blockSize);
+        renderer.prepareToPlay(sampleRate, options.blockSize);
+        ranInParallel = renderer.isRenderingInParallel();
+
+        const auto timing = measure(options, [&renderer](juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midi)
+                                    { renderer.processBlock(buffer, midi); });
+        renderer.releaseResources();
+        return timing;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::ArgumentList args(argc, argv);
+    auto readInt = [&args](const juce::String &option, int fallback)
+    { return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : fallback; };
+
+    Options options;
+    if (args.containsOption("--branches"))
+    {
+        options.branches.clear();
+        for (const auto &token : juce::StringArray::fromTokens(args.getValueForOption("--branches"), ",", {}))
+            if (token.getIntValue() > 0)
+                options.branches.add(token.getIntValue());
+    }
+    options.depth = juce::jmax(1, readInt("--depth", options.depth));
+    options.iterations = juce::jmax(1, readInt("--iterations", options.iterations));
+    options.blocks = juce::jmax(1, readInt("--blocks", options.blocks));
+    options.blockSize = juce::jmax(16, readInt("--block", options.blockSize));
+    options.workers = readInt("--workers", options.workers);
+    options.json = args.containsOption("--json");
+
+    const int numWorkers = options.workers < 0 ? ParallelGraphExecutor::getDefaultNumWorkers() : options.workers;
+
+    juce::Array<juce::var> results;
+    if (!options.json)
+        std::cout << "LightHost parallel graph benchmark (" << options.depth << " burn nodes per branch, " << options.blockSize
+                  << "-sample blocks, " << numWorkers << " workers, " << juce::SystemStats::getNumCpus() << " CPUs)\n";
+
+    for (const int numBranches : options.branches)
+    {
+        bool planInParallel = false, ranInParallel = false;
+        const auto graphTiming = measureGraph(options, numBranches);
+        const auto planTiming = measureRenderer(options, numBranches, 0, planInParallel);
+        const auto parallelTiming = measureRenderer(options, numBranches, numWorkers, ranInParallel);
+        const double speedup = parallelTiming.medianUs > 0.0 ? graphTiming.medianUs / parallelTiming.medianUs : 0.0;
+
+        if (options.json)
+        {
+            auto *result = new juce::DynamicObject();
+            result->setProperty("branches", numBranches);
+            result->setProperty("graph_us", graphTiming.medianUs);
+            result->setProperty("plan_us", planTiming.medianUs);
+            result->setProperty("parallel_us", parallelTiming.medianUs);
+            result->setProperty("parallel_mean_us", parallelTiming.meanUs);
+            result->setProperty("inParallel", ranInParallel);
+            result->setProperty("speedup", speedup);
+            results.add(juce::var(result));
+            continue;
+        }
+
+        std::cout << "  " << numBranches << " branches: graph " << juce::String(graphTiming.medianUs, 1) << " us"
+                  << ", plan " << juce::String(planTiming.medianUs, 1) << " us"
+                  << ", parallel " << juce::String(parallelTiming.medianUs, 1) << " us"
+                  << (ranInParallel ? "" : " (serial)")
+                  << "  speedup=" << juce::String(speedup, 2) << "x" << std::endl;
+    }
+
+    if (options.json)
+    {
+        auto *summary = new juce::DynamicObject();
+        summary->setProperty("depth", options.depth);
+        summary->setProperty("blockSize", options.blockSize);
+        summary->setProperty("workers", numWorkers);
+        summary->setProperty("cpus", juce::SystemStats::getNumCpus());
+        summary->setProperty("results", results);
+        std::cout << juce::JSON::toString(juce::var(summary)) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * SessionRestoreBenchmark.cpp
+ * LightHost - 工作階段還原（大量節點與連線）的圖形重建基準測試
+ *
+ * 比較兩種把一個工作階段套用到已準備好的 AudioProcessorGraph 的方式：
+ * - per-edit：   每個 addNode / addConnection 以預設的 UpdateKind::sync 各自重建，
+ *                每條連線之後再呼叫一次 rebuild()（GraphEditTransaction 之前 NodeGraphCanvas 的做法）
+ * - transaction：所有編輯經由 GraphEditTransaction，commit() 時只重建一次
+ *
+ * 連線為立體聲（通道 0、1 各一條），隨機但固定種子的有向無環圖：
+ * 來源為 Input 或較前面的節點，目的為較後面的節點或 Output
+ *
+ * 用法：
+ *   SessionRestoreBenchmark [--nodes=100] [--wires=200] [--runs=5] [--json]
+ */
+
+#include "JuceHeader.h"
+#include "BenchmarkProcessors.h"
+#include "GraphEditTransaction.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <set>
+
+namespace
+{
+    using Graph = juce::AudioProcessorGraph;
+    using IOProcessor = Graph::AudioGraphIOProcessor;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 480;
+
+    /** 連線端點：-1 = Input，numNodes = Output，其餘為外掛節點索引 */
+    struct Wire
+    {
+        int from = -1;
+        int to = 0;
+    };
+
+    std::vector<Wire> makeWires(int numNodes, int numWires)
+    {
+        juce::Random random(0x4c48); // Fixed seed: every run restores the same session
+        std::set<std::pair<int, int>> used;
+        std::vector<Wire> wires;
+
+        // Capped by the number of distinct forward pairs, so this always terminates
+        const auto maxWires = (juce::int64)(numNodes + 1) * (numNodes + 2) / 2;
+        while ((juce::int64)wires.size() < juce::jmin((juce::int64)numWires, maxWires))
+        {
+            const int from = random.nextInt(numNodes + 1) - 1;
+            const int to = from + 1 + random.nextInt(numNodes - from);
+            if (used.insert({from, to}).second)
+                wires.push_back({from, to});
+        }
+        return wires;
+    }
+
+    struct Session
+    {
+        Graph::NodeID input, output;
+        std::vector<Graph::NodeID> nodes;
+
+        Graph::NodeID resolve(int index) const
+        {
+            if (index < 0)
+                return input;
+            return index < (int)nodes.size() ? nodes[(size_t)index] : output;
+        }
+    };
+
+    /** 清空圖形並重新建立固定的 I/O 節點（與 IconMenu::loadActivePlugins 相同），不計時 */
+    Session resetGraph(Graph &graph)
+    {
+        graph.clear();
+        Session session;
+        session.input = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioInputNode))->nodeID;
+        session.output = graph.addNode(std::make_unique<IOProcessor>(IOProcessor::audioOutputNode))->nodeID;
+        return session;
+    }
+
+    double restorePerEdit(Graph &graph, int numNodes, const std::vector<Wire> &wires)
+    {
+        auto session = resetGraph(graph);
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < numNodes; ++i)
+            session.nodes.push_back(graph.addNode(createBenchmarkProcessor("gain"))->nodeID);
+
+        for (const auto &wire : wires)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                graph.addConnection({{session.resolve(wire.from), ch}, {session.resolve(wire.to), ch}});
+            graph.rebuild();
+        }
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double restoreTransaction(Graph &graph, int numNodes, const std::vector<Wire> &wires)
+    {
+        auto session = resetGraph(graph);
+        const auto start = std::chrono::steady_clock::now();
+
+        GraphEditTransaction edit(graph);
+        for (int i = 0; i < numNodes; ++i)
+            session.nodes.push_back(edit.addNode(createBenchmarkProcessor("gain"))->nodeID);
+
+        for (const auto &wire : wires)
+            for (int ch = 0; ch < 2; ++ch)
+                edit.addConnection({{session.resolve(wire.from), ch}, {session.resolve(wire.to), ch}});
+        edit.commit();
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double median(std::vector<double> values)
+    {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::ArgumentList args(argc, argv);
+    auto readInt = [&args](const juce::String &option, int fallback)
+    { return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : fallback; };
+
+    const int numNodes = juce::jmax(1, readInt("--nodes", 100));
+    const int numWires = juce::jmax(0, readInt("--wires", 200));
+    const int numRuns = juce::jmax(1, readInt("--runs", 5));
+    const bool json = args.containsOption("--json");
+
+    const auto wires = makeWires(numNodes, numWires);
+
+    // Rebuilds only build a render sequence once the graph is prepared, like under the player
+    Graph graph;
+    graph.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    graph.prepareToPlay(sampleRate, blockSize);
+
+    std::vector<double> perEditMs, transactionMs;
+    for (int run = 0; run < numRuns; ++run)
+    {
+        perEditMs.push_back(restorePerEdit(graph, numNodes, wires));
+        transactionMs.push_back(restoreTransaction(graph, numNodes, wires));
+    }
+
+    graph.releaseResources();
+
+    // addNode and each addConnection rebuild synchronously, plus the explicit rebuild per wire
+    const int perEditRebuilds = numNodes + (int)wires.size() * 3;
+    const double perEdit = median(perEditMs);
+    const double transaction = median(transactionMs);
+    const double speedup = transaction > 0.0 ? perEdit / transaction : 0.0;
+
+    if (json)
+    {
+        auto *result = new juce::DynamicObject();
+        result->setProperty("nodes", numNodes);
+        result->setProperty("wires", (int)wires.size());
+        result->setProperty("runs", numRuns);
+        result->setProperty("perEdit_ms", perEdit);
+        result->setProperty("perEditRebuilds", perEditRebuilds);
+        result->setProperty("transaction_ms", transaction);
+        result->setProperty("transactionRebuilds", 1);
+        result->setProperty("speedup", speedup);
+        std::cout << juce::JSON::toString(juce::var(result)) << std::endl;
+        return 0;
+    }
+
+    std::cout << "LightHost session restore benchmark (" << numNodes << " nodes, " << wires.size() << " stereo wires, median of "
+              << numRuns << " runs)\n"
+              << "  per-edit:    " << juce::String(perEdit, 2) << " ms (" << perEditRebuilds << " rebuilds)\n"
+              << "  transaction: " << juce::String(transaction, 2) << " ms (1 rebuild)\n"
+              << "  speedup=" << juce::String(speedup, 1) << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,439 @@
+/*
+ * VoicemeeterRemoteStandIn.cpp
+ * LightHost - Voicemeeter Remote API 本地替身實作
+ *
+ * 行為摘要（依官方 VoicemeeterRemote.h 的回傳值約定）：
+ * - VBVMR_Login：0 = 成功，1 = 成功但 Voicemeeter 未執行，-2 = 重複登入
+ * - VBVMR_AudioCallbackRegister：0 = 成功，1 = 已被其他客戶端註冊（回填其名稱）
+ * - VBVMR_AudioCallbackStart：啟動串流執行緒，先送 STARTING 再持續送 BUFFER_*
+ * - VBVMR_AudioCallbackStop：送出 ENDING 並結束串流執行緒
+ * - triggerEngineRestart 之後的離線期間：IsParametersDirty 回傳 -2，Login 回傳 1，註冊回傳 -1
+ *
+ * 串流執行緒：
+ * - 每個緩衝區週期（nbs / samplerate）呼叫一次回調
+ * - 所有輸入通道填入 997 Hz 正弦測試訊號
+ * - 以 steady_clock 量測回調耗時，寫入預先配置的陣列（不在串流中配置記憶體）
+ */
+
+#include "VoicemeeterRemoteStandIn.h"
+#include "VoicemeeterLayout.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr long maxChannels = 128; // audiobuffer_r / audiobuffer_w capacity
+
+    struct StandInState
+    {
+        std::mutex mutex; // Guards registration and the stream thread lifecycle
+        VoicemeeterStandIn::Config config;
+
+        bool loggedIn = false;
+        long mode = 0;
+        T_VBVMR_VBAUDIOCALLBACK callback = nullptr;
+        void *user = nullptr;
+        char clientName[64] = {};
+
+        std::thread worker;
+        std::atomic<std::thread::id> workerId{};
+        std::atomic<bool> keepRunning{false};
+        std::atomic<bool> streaming{false};
+        std::atomic<bool> changeRequested{false};
+        std::atomic<bool> silentStop{false}; // Engine restart: leave without ENDING
+        Clock::time_point serverDownUntil{};
+
+        // Written by the stream thread only while streaming, read by takeTimings() without stopping
+        // it: the stream thread cannot take the mutex, which Start / Stop hold while joining it
+        std::vector<double> timings;                  // Entries below numBuffers are complete
+        std::atomic<std::uint64_t> numBuffers{0};
+        std::atomic<std::uint64_t> numLateBuffers{0};
+        std::atomic<double> wallSeconds{0.0};
+        std::atomic<long> timedSampleRate{0};
+        std::atomic<long> timedSamplesPerFrame{0};
+    };
+
+    StandInState &getState()
+    {
+        static StandInState state;
+        return state;
+    }
+
+    bool isServerUp(const StandInState &s)
+    {
+        return s.config.serverAlive && Clock::now() >= s.serverDownUntil;
+    }
+
+    long resolveChannelCount(long requested, const VoicemeeterStandIn::Config &config, long command, bool forInput)
+    {
+        if (requested > 0)
+            return std::min(requested, maxChannels);
+
+        // Input insert: every input strip; output insert: every bus (A1..An, B1..Bn);
+        // main: reads every strip followed by every bus, writes every bus
+        const auto layout = VoicemeeterLayout::forType((int)config.voicemeeterType);
+        long count = layout.getNumBusChannels();
+        if (command == VBVMR_CBCOMMAND_BUFFER_IN)
+            count = layout.getNumStripChannels();
+        else if (command == VBVMR_CBCOMMAND_BUFFER_MAIN && forInput)
+            count = layout.getNumStripChannels() + layout.getNumBusChannels();
+        return std::min(count, maxChannels);
+    }
+
+    long bufferCommandForMode(long mode)
+    {
+        if ((mode & VBVMR_AUDIOCALLBACK_IN) != 0)
+            return VBVMR_CBCOMMAND_BUFFER_IN;
+        if ((mode & VBVMR_AUDIOCALLBACK_OUT) != 0)
+            return VBVMR_CBCOMMAND_BUFFER_OUT;
+        return VBVMR_CBCOMMAND_BUFFER_MAIN;
+    }
+
+    void runStream(StandInState &s, VoicemeeterStandIn::Config config,
+                   T_VBVMR_VBAUDIOCALLBACK callback, void *user, long command)
+    {
+        const long nbs = std::max(1L, config.samplesPerFrame);
+        const long nbi = resolveChannelCount(config.numInputs, config, command, true);
+        const long nbo = resolveChannelCount(config.numOutputs, config, command, false);
+
+        std::vector<float> inputStorage((size_t)(nbi * nbs), 0.0f);
+        std::vector<float> outputStorage((size_t)(nbo * nbs), 0.0f);
+
+        VBVMR_T_AUDIOBUFFER buffer{};
+        buffer.audiobuffer_sr = config.sampleRate;
+        buffer.audiobuffer_nbs = nbs;
+        buffer.audiobuffer_nbi = nbi;
+        buffer.audiobuffer_nbo = nbo;
+        for (long ch = 0; ch < nbi; ++ch)
+            buffer.audiobuffer_r[ch] = inputStorage.data() + ch * nbs;
+        for (long ch = 0; ch < nbo; ++ch)
+            buffer.audiobuffer_w[ch] = outputStorage.data() + ch * nbs;
+
+        // Before the first callback: the client may ask isStreamThread() from inside it
+        s.workerId.store(std::this_thread::get_id());
+
+        VBVMR_T_AUDIOINFO info{config.sampleRate, nbs};
+        callback(user, VBVMR_CBCOMMAND_STARTING, &info, 0);
+
+        s.timedSampleRate.store(config.sampleRate, std::memory_order_relaxed);
+        s.timedSamplesPerFrame.store(nbs, std::memory_order_relaxed);
+
+        const double twoPi = 6.283185307179586;
+        const double phaseIncrement = twoPi * 997.0 / (double)std::max(1L, config.sampleRate);
+        double phase = 0.0;
+
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>((double)nbs / (double)std::max(1L, config.sampleRate)));
+        auto nextDeadline = Clock::now();
+        auto firstBuffer = nextDeadline;
+        auto lastBuffer = nextDeadline;
+        std::uint64_t numStreamBuffers = 0;
+        bool changed = false;
+
+        while (s.keepRunning.load(std::memory_order_acquire))
+        {
+            if (s.changeRequested.exchange(false))
+            {
+                // Voicemeeter stops the stream after CHANGE; the client has to restart it
+                callback(user, VBVMR_CBCOMMAND_CHANGE, nullptr, 0);
+                changed = true;
+                break;
+            }
+
+            if (nbi > 0)
+            {
+                float *first = buffer.audiobuffer_r[0];
+                for (long i = 0; i < nbs; ++i)
+                {
+                    first[i] = (float)(0.25 * std::sin(phase));
+                    phase += phaseIncrement;
+                    if (phase >= twoPi)
+                        phase -= twoPi;
+                }
+                for (long ch = 1; ch < nbi; ++ch)
+                    std::memcpy(buffer.audiobuffer_r[ch], first, sizeof(float) * (size_t)nbs);
+            }
+
+            const auto callStart = Clock::now();
+            callback(user, command, &buffer, 0);
+            const auto callEnd = Clock::now();
+
+            // Only this thread adds buffers: write the entry, then publish it with the count
+            const auto index = s.numBuffers.load(std::memory_order_relaxed);
+            if (numStreamBuffers++ == 0)
+                firstBuffer = callStart;
+            if (index < s.timings.size())
+                s.timings[(size_t)index] = std::chrono::duration<double>(callEnd - callStart).count();
+            s.numBuffers.fetch_add(1, std::memory_order_release);
+            lastBuffer = callEnd;
+
+            if (config.realtime)
+            {
+                nextDeadline += period;
+                if (nextDeadline < callEnd)
+                {
+                    s.numLateBuffers.fetch_add(1, std::memory_order_relaxed);
+                    nextDeadline = callEnd;
+                }
+                else
+                {
+                    std::this_thread::sleep_until(nextDeadline);
+                }
+            }
+        }
+
+        s.wallSeconds.store(s.wallSeconds.load(std::memory_order_relaxed)
+                                + std::chrono::duration<double>(lastBuffer - firstBuffer).count(),
+                            std::memory_order_relaxed);
+        if (!s.silentStop.exchange(false))
+            callback(user, VBVMR_CBCOMMAND_ENDING, nullptr, 0);
+
+        if (changed)
+            s.keepRunning.store(false, std::memory_order_release);
+        s.streaming.store(false, std::memory_order_release);
+    }
+
+    bool isStreamThread(const StandInState &s)
+    {
+        return s.workerId.load() == std::this_thread::get_id();
+    }
+
+    void joinStream(StandInState &s)
+    {
+        s.keepRunning.store(false, std::memory_order_release);
+        if (s.worker.joinable())
+            s.worker.join();
+        s.workerId.store({});
+    }
+} // namespace
+
+//==============================================================================
+// Control API
+//==============================================================================
+
+namespace VoicemeeterStandIn
+{
+    void setConfig(const Config &newConfig)
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        s.config = newConfig;
+    }
+
+    Config getConfig()
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        return s.config;
+    }
+
+    void triggerChange(const Config &newConfig)
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        s.config = newConfig;
+        s.changeRequested.store(true);
+    }
+
+    void triggerEngineRestart(double downSeconds)
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+
+        // A dying engine just stops calling back; the registration dies with it
+        s.silentStop.store(true);
+        joinStream(s);
+        s.silentStop.store(false);
+        s.callback = nullptr;
+        s.user = nullptr;
+        s.mode = 0;
+        s.serverDownUntil = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(0.0, downSeconds)));
+    }
+
+    bool isStreaming()
+    {
+        return getState().streaming.load(std::memory_order_acquire);
+    }
+
+    void reserveTimings(std::size_t maxBuffers)
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        s.timings.assign(maxBuffers, 0.0);
+        s.numBuffers.store(0);
+        s.numLateBuffers.store(0);
+        s.wallSeconds.store(0.0);
+    }
+
+    Timings takeTimings()
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+
+        Timings result;
+        result.numBuffers = s.numBuffers.load(std::memory_order_acquire);
+        result.numLateBuffers = s.numLateBuffers.load();
+        result.wallSeconds = s.wallSeconds.load();
+        result.sampleRate = s.timedSampleRate.load();
+        result.samplesPerFrame = s.timedSamplesPerFrame.load();
+
+        const auto recorded = (std::size_t)std::min<std::uint64_t>(result.numBuffers, s.timings.size());
+        result.callbackSeconds.assign(s.timings.begin(), s.timings.begin() + (std::ptrdiff_t)recorded);
+        return result;
+    }
+} // namespace VoicemeeterStandIn
+
+//==============================================================================
+// T_VBVMR_INTERFACE entry points
+//==============================================================================
+
+extern "C"
+{
+    long __stdcall VBVMR_Login(void)
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.loggedIn)
+            return -2; // Unexpected login (logout was expected before)
+
+        s.loggedIn = true;
+        return isServerUp(s) ? 0 : 1;
+    }
+
+    long __stdcall VBVMR_Logout(void)
+    {
+        auto &s = getState();
+        if (isStreamThread(s))
+            return -1;
+
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        joinStream(s);
+        s.callback = nullptr;
+        s.user = nullptr;
+        s.mode = 0;
+        s.loggedIn = false;
+        return 0;
+    }
+
+    long __stdcall VBVMR_GetVoicemeeterType(long *pType)
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.loggedIn)
+            return -1;
+        if (!s.config.serverAlive)
+            return -2;
+        if (pType != nullptr)
+            *pType = s.config.voicemeeterType;
+        return 0;
+    }
+
+    long __stdcall VBVMR_GetVoicemeeterVersion(long *pVersion)
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.loggedIn)
+            return -1;
+        if (!s.config.serverAlive)
+            return -2;
+        if (pVersion != nullptr)
+            *pVersion = (s.config.voicemeeterType << 24) | 0x00010000; // v<type>.1.0.0
+        return 0;
+    }
+
+    long __stdcall VBVMR_IsParametersDirty(void)
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.loggedIn)
+            return -1;
+        return isServerUp(s) ? 0 : -2;
+    }
+
+    long __stdcall VBVMR_AudioCallbackRegister(long mode, T_VBVMR_VBAUDIOCALLBACK pCallback,
+                                               void *lpUser, char szClientName[64])
+    {
+        auto &s = getState();
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.loggedIn || pCallback == nullptr || !isServerUp(s))
+            return -1;
+
+        if (s.callback != nullptr)
+        {
+            // Report the client that already owns the callback, like Voicemeeter does
+            if (szClientName != nullptr)
+                std::memcpy(szClientName, s.clientName, sizeof(s.clientName));
+            return 1;
+        }
+
+        s.callback = pCallback;
+        s.user = lpUser;
+        s.mode = mode;
+        if (szClientName != nullptr)
+        {
+            std::memcpy(s.clientName, szClientName, sizeof(s.clientName));
+            s.clientName[sizeof(s.clientName) - 1] = 0;
+        }
+        return 0;
+    }
+
+    long __stdcall VBVMR_AudioCallbackStart(void)
+    {
+        auto &s = getState();
+        if (isStreamThread(s))
+            return -1; // Must not be called from inside the audio callback
+
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.callback == nullptr)
+            return -2;
+        if (s.streaming.load(std::memory_order_acquire))
+            return 0;
+
+        joinStream(s); // Reap a stream that ended on its own (CHANGE)
+
+        s.changeRequested.store(false);
+        s.keepRunning.store(true, std::memory_order_release);
+        s.streaming.store(true, std::memory_order_release);
+        s.worker = std::thread(runStream, std::ref(s), s.config, s.callback, s.user, bufferCommandForMode(s.mode));
+        return 0;
+    }
+
+    long __stdcall VBVMR_AudioCallbackStop(void)
+    {
+        auto &s = getState();
+        if (isStreamThread(s))
+            return -1;
+
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.callback == nullptr)
+            return -2;
+
+        joinStream(s);
+        return 0;
+    }
+
+    long __stdcall VBVMR_AudioCallbackUnregister(void)
+    {
+        auto &s = getState();
+        if (isStreamThread(s))
+            return -1;
+
+        const std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.callback == nullptr)
+            return 1; // Nothing registered
+
+        joinStream(s);
+        s.callback = nullptr;
+        s.user = nullptr;
+        s.mode = 0;
+        return 0;
+    }
+}
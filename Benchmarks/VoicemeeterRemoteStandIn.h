@@ -0,0 +1,91 @@
+/*
+ * VoicemeeterRemoteStandIn.h
+ * LightHost - Voicemeeter Remote API 本地替身（stand-in）
+ *
+ * 功能說明：
+ * - 以純 C++ 實作 T_VBVMR_INTERFACE 需要的入口點
+ *   （Login / Logout / GetVoicemeeterType / AudioCallbackRegister / Start / Stop / Unregister）
+ * - 以計時執行緒依序送出 VBVMR_CBCOMMAND_STARTING / BUFFER_* / CHANGE / ENDING
+ * - 可模擬 Voicemeeter 重新啟動（註冊失效、伺服器暫時離線）
+ * - nbs / nbi / nbo、採樣率與 Voicemeeter 類型皆可設定
+ * - 記錄每次緩衝區回調所花的時間，供基準測試計算百分位數與吞吐量
+ *
+ * 使用方式：
+ * - 與 LIGHTHOST_VOICEMEETER_STANDIN=1 一起編譯 VoicemeeterAudioDevice.cpp，
+ *   VoicemeeterAPI 便會直接綁定這些函數，不需要 Windows 或 Voicemeeter
+ */
+
+#pragma once
+
+#include "VoicemeeterRemote.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VoicemeeterStandIn
+{
+    /**
+     * Config 結構
+     * 替身引擎的音頻配置；在 AudioCallbackStart 時生效
+     */
+    struct Config
+    {
+        long voicemeeterType = 3;    // 1 = Standard, 2 = Banana, 3 = Potato
+        long sampleRate = 48000;     // audiobuffer_sr
+        long samplesPerFrame = 480;  // audiobuffer_nbs
+        long numInputs = 0;          // audiobuffer_nbi，0 = 依類型與回調模式推算
+        long numOutputs = 0;         // audiobuffer_nbo，0 = 依類型與回調模式推算
+        bool realtime = true;        // true = 依緩衝區週期節拍；false = 全速執行（量測吞吐量）
+        bool serverAlive = true;     // false = 模擬 Voicemeeter 未執行（Login 回傳 1）
+    };
+
+    /** 設定下一次 AudioCallbackStart 使用的配置 */
+    void setConfig(const Config &newConfig);
+
+    /** 取得目前配置 */
+    [[nodiscard]] Config getConfig();
+
+    /**
+     * triggerChange() 函數
+     * 模擬 Voicemeeter 引擎重新配置：
+     * 串流執行緒送出 VBVMR_CBCOMMAND_CHANGE 與 ENDING 後停止，
+     * 客戶端需再次呼叫 AudioCallbackStart，之後以 newConfig 送出 STARTING
+     */
+    void triggerChange(const Config &newConfig);
+
+    /**
+     * triggerEngineRestart() 函數
+     * 模擬 Voicemeeter 被關閉後重新執行：
+     * 串流立即停止且不送出任何命令，客戶端的註冊失效，
+     * 之後 downSeconds 秒內伺服器視為未執行（IsParametersDirty 回傳 -2，註冊失敗），
+     * 客戶端需重新 Login / AudioCallbackRegister / AudioCallbackStart
+     */
+    void triggerEngineRestart(double downSeconds);
+
+    /** 目前是否正在送出緩衝區回調 */
+    [[nodiscard]] bool isStreaming();
+
+    /**
+     * Timings 結構
+     * 自上次 reserveTimings() 以來的緩衝區回調計時結果
+     */
+    struct Timings
+    {
+        std::vector<double> callbackSeconds; // 每次 BUFFER 回調的耗時（秒）
+        std::uint64_t numBuffers = 0;        // 送出的緩衝區總數（可能多於記錄容量）
+        std::uint64_t numLateBuffers = 0;    // 即時模式下錯過排程時間的緩衝區數
+        double wallSeconds = 0.0;            // 各段串流第一個到最後一個緩衝區的實際經過時間總和
+        long samplesPerFrame = 0;
+        long sampleRate = 0;
+    };
+
+    /**
+     * reserveTimings() 函數
+     * 預先配置計時記錄容量並清除先前結果（不可在串流進行中呼叫）
+     */
+    void reserveTimings(std::size_t maxBuffers);
+
+    /** 取出計時結果（不可在串流進行中呼叫） */
+    [[nodiscard]] Timings takeTimings();
+} // namespace VoicemeeterStandIn
@@ -0,0 +1,122 @@
+/*
+ * DeadlineMonitor.cpp
+ * LightHost - 音頻執行緒期限監測實作
+ */
+
+#include "DeadlineMonitor.h"
+#include "RealtimeLog.h"
+
+void DeadlineMonitor::record(juce::int64 elapsedTicks, int numSamples, double sampleRate) noexcept
+{
+    if (resetRequested.exchange(false, std::memory_order_acquire))
+        clear();
+
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return;
+
+    const double seconds = juce::Time::highResolutionTicksToSeconds(elapsedTicks);
+    const double period = (double)numSamples / sampleRate;
+    const double load = seconds / period;
+
+    const int bin = juce::jlimit(0, numBins - 1, (int)(load / binWidth));
+    add(bins[(size_t)bin], (std::uint64_t)1);
+    add(sumLoad, load);
+    add(sumSeconds, seconds);
+    if (load > maxLoad.load(std::memory_order_relaxed))
+        maxLoad.store(load, std::memory_order_relaxed);
+    if (seconds > maxSeconds.load(std::memory_order_relaxed))
+        maxSeconds.store(seconds, std::memory_order_relaxed);
+    periodSeconds.store(period, std::memory_order_relaxed);
+
+    if (load > 1.0)
+    {
+        add(numOverruns, (std::uint64_t)1);
+        RTLOG_WARNING("deadline overrun: {} us of a {} us buffer", seconds * 1.0e6, period * 1.0e6);
+    }
+
+    // Published last so a reader never sees more buffers than binned samples
+    numBuffers.store(numBuffers.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void DeadlineMonitor::clear() noexcept
+{
+    for (auto &bin : bins)
+        bin.store(0, std::memory_order_relaxed);
+    numOverruns.store(0, std::memory_order_relaxed);
+    sumLoad.store(0.0, std::memory_order_relaxed);
+    maxLoad.store(0.0, std::memory_order_relaxed);
+    sumSeconds.store(0.0, std::memory_order_relaxed);
+    maxSeconds.store(0.0, std::memory_order_relaxed);
+    numBuffers.store(0, std::memory_order_release);
+}
+
+DeadlineMonitor::Snapshot DeadlineMonitor::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+    snapshot.numBuffers = numBuffers.load(std::memory_order_acquire);
+    snapshot.numOverruns = numOverruns.load(std::memory_order_relaxed);
+    snapshot.maxLoad = maxLoad.load(std::memory_order_relaxed);
+    snapshot.maxMicros = maxSeconds.load(std::memory_order_relaxed) * 1.0e6;
+    snapshot.periodMicros = periodSeconds.load(std::memory_order_relaxed) * 1.0e6;
+
+    std::uint64_t binned = 0;
+    for (size_t i = 0; i < bins.size(); ++i)
+    {
+        snapshot.bins[i] = bins[i].load(std::memory_order_relaxed);
+        binned += snapshot.bins[i];
+    }
+
+    if (binned == 0)
+        return snapshot;
+
+    snapshot.meanLoad = sumLoad.load(std::memory_order_relaxed) / (double)binned;
+    snapshot.meanMicros = sumSeconds.load(std::memory_order_relaxed) * 1.0e6 / (double)binned;
+
+    // Percentiles resolve to the upper edge of their bin, never above the exact maximum
+    auto percentile = [&](double p)
+    {
+        const auto target = (std::uint64_t)std::ceil(p * (double)binned);
+        std::uint64_t cumulative = 0;
+        for (int i = 0; i < numBins; ++i)
+        {
+            cumulative += snapshot.bins[(size_t)i];
+            if (cumulative >= target)
+                return juce::jmin((double)(i + 1) * binWidth, snapshot.maxLoad);
+        }
+        return snapshot.maxLoad;
+    };
+
+    snapshot.p50Load = percentile(0.50);
+    snapshot.p99Load = percentile(0.99);
+    snapshot.p999Load = percentile(0.999);
+    return snapshot;
+}
+
+juce::String DeadlineMonitor::createReport(const juce::String &title) const
+{
+    const auto snapshot = getSnapshot();
+    auto percent = [](double load)
+    { return juce::String(load * 100.0, 2) + "%"; };
+
+    juce::String report;
+    report << "LightHost deadline report - " << title << "\n"
+           << "date: " << juce::Time::getCurrentTime().toISO8601(true) << "\n"
+           << "buffer period: " << juce::String(snapshot.periodMicros, 1) << " us\n"
+           << "buffers: " << (juce::int64)snapshot.numBuffers << "\n"
+           << "overruns: " << (juce::int64)snapshot.numOverruns << "\n"
+           << "load mean: " << percent(snapshot.meanLoad) << "\n"
+           << "load p50: " << percent(snapshot.p50Load) << "\n"
+           << "load p99: " << percent(snapshot.p99Load) << "\n"
+           << "load p99.9: " << percent(snapshot.p999Load) << "\n"
+           << "load max: " << percent(snapshot.maxLoad) << "\n"
+           << "time mean: " << juce::String(snapshot.meanMicros, 1) << " us\n"
+           << "time max: " << juce::String(snapshot.maxMicros, 1) << " us\n"
+           << "\n"
+           << "load_percent,count\n";
+
+    for (int i = 0; i < numBins; ++i)
+        if (snapshot.bins[(size_t)i] > 0)
+            report << juce::String((double)(i + 1) * binWidth * 100.0, 1) << "," << (juce::int64)snapshot.bins[(size_t)i] << "\n";
+
+    return report;
+}
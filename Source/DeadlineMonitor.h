@@ -0,0 +1,116 @@
+/*
+ * DeadlineMonitor.h
+ * LightHost - 音頻執行緒期限監測（lock-free 直方圖）
+ *
+ * 功能說明：
+ * - 量測每次 Voicemeeter BUFFER 回調的耗時，與緩衝區週期（nbs / samplerate）比較
+ * - 以「耗時 / 週期」的負載比例累積到固定大小的直方圖（每格 0.5%，上限 200%）
+ * - 提供平均、p50、p99、p99.9、最大值與超時（負載 > 100%）次數
+ * - 可輸出文字報告（摘要 + 直方圖 CSV）到檔案
+ *
+ * 執行緒：
+ * - record() 只由音頻執行緒呼叫（單一寫入者），只做原子載入 / 儲存，不配置記憶體
+ * - getSnapshot() / createReport() 可在任何執行緒呼叫，讀到的是近似一致的快照
+ * - reset() 只設定旗標，由音頻執行緒在下一次 record() 清除，避免與寫入者競爭
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+class DeadlineMonitor
+{
+public:
+    static constexpr int numBins = 400;        // 最後一格收集所有 >= 199.5% 的緩衝區
+    static constexpr double binWidth = 0.005;  // 每格為週期的 0.5%
+
+    /**
+     * Snapshot 結構
+     * 負載以週期的比例表示（1.0 = 剛好用完整個緩衝區週期）
+     */
+    struct Snapshot
+    {
+        std::uint64_t numBuffers = 0;
+        std::uint64_t numOverruns = 0;
+        double meanLoad = 0.0;
+        double p50Load = 0.0;
+        double p99Load = 0.0;
+        double p999Load = 0.0;
+        double maxLoad = 0.0;
+        double meanMicros = 0.0;
+        double maxMicros = 0.0;
+        double periodMicros = 0.0; // 最近一次的緩衝區週期
+        std::array<std::uint64_t, numBins> bins{};
+    };
+
+    /**
+     * record() 方法
+     * 記錄一次回調（音頻執行緒）
+     *
+     * @param elapsedTicks Time::getHighResolutionTicks() 量得的回調耗時
+     * @param numSamples   緩衝區樣本數（nbs）
+     * @param sampleRate   採樣率
+     */
+    void record(juce::int64 elapsedTicks, int numSamples, double sampleRate) noexcept;
+
+    /** 要求清除統計；下一次 record() 生效（任何執行緒） */
+    void reset() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+    /** 取得目前統計的快照（任何執行緒） */
+    [[nodiscard]] Snapshot getSnapshot() const noexcept;
+
+    /**
+     * createReport() 方法
+     * 產生文字報告：摘要與每格非零的直方圖（CSV：load_percent,count）
+     *
+     * @param title 報告標題（例如設備名稱）
+     */
+    [[nodiscard]] juce::String createReport(const juce::String &title) const;
+
+    /**
+     * ScopedTimer 類別
+     * 建構到解構之間的時間記錄為一次回調
+     */
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(DeadlineMonitor &m, int samples, double rate) noexcept
+            : monitor(m), numSamples(samples), sampleRate(rate), startTicks(juce::Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedTimer() { monitor.record(juce::Time::getHighResolutionTicks() - startTicks, numSamples, sampleRate); }
+
+    private:
+        DeadlineMonitor &monitor;
+        int numSamples;
+        double sampleRate;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+private:
+    void clear() noexcept;
+
+    // Single writer: plain load/store pairs instead of read-modify-write
+    template <typename T>
+    static void add(std::atomic<T> &value, T amount) noexcept
+    {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint64_t>, numBins> bins{};
+    std::atomic<std::uint64_t> numBuffers{0};
+    std::atomic<std::uint64_t> numOverruns{0};
+    std::atomic<double> sumLoad{0.0};
+    std::atomic<double> maxLoad{0.0};
+    std::atomic<double> sumSeconds{0.0};
+    std::atomic<double> maxSeconds{0.0};
+    std::atomic<double> periodSeconds{0.0};
+    std::atomic<bool> resetRequested{false};
+};
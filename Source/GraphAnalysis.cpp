@@ -0,0 +1,137 @@
+/*
+ * GraphAnalysis.cpp
+ * LightHost - AudioProcessorGraph 拓撲分析實作
+ */
+
+#include "GraphAnalysis.h"
+#include "GraphRenderPlan.h"
+
+namespace
+{
+    using Graph = juce::AudioProcessorGraph;
+    using IOProcessor = Graph::AudioGraphIOProcessor;
+
+    Graph::NodeID findIONode(const Graph &graph, IOProcessor::IODeviceType type)
+    {
+        for (auto *node : graph.getNodes())
+            if (auto *io = dynamic_cast<IOProcessor *>(node->getProcessor()))
+                if (io->getType() == type)
+                    return node->nodeID;
+        return {};
+    }
+
+    /**
+     * 追溯 destination 的唯一音頻來源，略過已旁通且無延遲的節點
+     * 回傳 nodeID 為空表示來源不唯一、經過啟用中的處理器或增益不是 1 的連線
+     */
+    Graph::NodeAndChannel resolveSource(const Graph &graph,
+                                        const std::vector<Graph::Connection> &connections,
+                                        Graph::NodeAndChannel destination,
+                                        Graph::NodeID inputNodeID)
+    {
+        // A graph cannot contain cycles, but bound the walk anyway
+        for (size_t depth = 0; depth <= connections.size(); ++depth)
+        {
+            const Graph::Connection *found = nullptr;
+            for (const auto &connection : connections)
+            {
+                if (connection.destination != destination)
+                    continue;
+                if (found != nullptr)
+                    return {}; // More than one source: this channel is a mix
+                found = &connection;
+            }
+
+            if (found == nullptr || GraphRenderPlan::getWireGain(graph, *found) != 1.0f)
+                return {};
+
+            const auto source = found->source;
+            if (source.nodeID == inputNodeID)
+                return source;
+
+            auto node = graph.getNodeForId(source.nodeID);
+            if (node == nullptr || !node->isBypassed() || node->getProcessor()->getLatencySamples() != 0)
+                return {};
+
+            // A bypassed node hands its input channel straight to the same output channel
+            destination = {source.nodeID, source.channelIndex};
+        }
+
+        return {};
+    }
+
+    /** 以記憶化深度優先搜尋計算 nodeID 輸出端的累積延遲 */
+    int resolvePathLatency(const Graph &graph,
+                           const std::vector<Graph::Connection> &connections,
+                           Graph::NodeID nodeID,
+                           GraphAnalysis::LatencyMap &latencies)
+    {
+        if (auto found = latencies.find(nodeID); found != latencies.end())
+            return found->second.pathSamples;
+
+        auto node = graph.getNodeForId(nodeID);
+        const int own = node != nullptr ? node->getProcessor()->getLatencySamples() : 0;
+
+        // Inserted before recursing so a malformed (cyclic) wiring terminates
+        auto &entry = latencies[nodeID];
+        entry.ownSamples = own;
+        entry.pathSamples = own;
+
+        int upstream = 0;
+        for (const auto &connection : connections)
+            if (connection.destination.nodeID == nodeID && !connection.source.isMIDI())
+                upstream = juce::jmax(upstream, resolvePathLatency(graph, connections, connection.source.nodeID, latencies));
+
+        // std::map references stay valid across the insertions made while recursing
+        entry.pathSamples = own + upstream;
+        return entry.pathSamples;
+    }
+} // namespace
+
+bool GraphAnalysis::isPassThrough(const juce::AudioProcessorGraph &graph, int numChannels)
+{
+    const auto inputNodeID = findIONode(graph, IOProcessor::audioInputNode);
+    const auto outputNodeID = findIONode(graph, IOProcessor::audioOutputNode);
+    if (inputNodeID == Graph::NodeID() || outputNodeID == Graph::NodeID() || numChannels <= 0)
+        return false;
+
+    const auto connections = graph.getConnections();
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto source = resolveSource(graph, connections, {outputNodeID, ch}, inputNodeID);
+        if (source.nodeID != inputNodeID || source.channelIndex != ch)
+            return false;
+    }
+
+    return true;
+}
+
+GraphAnalysis::LatencyMap GraphAnalysis::computePathLatencies(const juce::AudioProcessorGraph &graph)
+{
+    LatencyMap latencies;
+    const auto connections = graph.getConnections();
+
+    for (auto *node : graph.getNodes())
+        resolvePathLatency(graph, connections, node->nodeID, latencies);
+
+    return latencies;
+}
+
+GraphAnalysis::UsedChannels GraphAnalysis::getUsedIOChannels(const juce::AudioProcessorGraph &graph)
+{
+    const auto inputNodeID = findIONode(graph, IOProcessor::audioInputNode);
+    const auto outputNodeID = findIONode(graph, IOProcessor::audioOutputNode);
+
+    UsedChannels used;
+    for (const auto &connection : graph.getConnections())
+    {
+        if (connection.source.isMIDI())
+            continue;
+        if (connection.source.nodeID == inputNodeID)
+            used.numInputs = juce::jmax(used.numInputs, connection.source.channelIndex + 1);
+        if (connection.destination.nodeID == outputNodeID)
+            used.numOutputs = juce::jmax(used.numOutputs, connection.destination.channelIndex + 1);
+    }
+
+    return used;
+}
@@ -0,0 +1,75 @@
+/*
+ * GraphAnalysis.h
+ * LightHost - AudioProcessorGraph 拓撲分析
+ *
+ * 功能說明：
+ * - 判斷目前的連線是否等同直通（Input -> Output，或只經過已旁通的外掛）
+ * - 供 VoicemeeterAudioIODevice 的直通快速路徑使用
+ * - 計算每個節點沿最長連線路徑累積的延遲，供 NodeGraphCanvas 顯示
+ * - 統計實際連線用到的 Input / Output 通道數，供設備只開啟用到的通道
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <map>
+
+namespace GraphAnalysis
+{
+    /**
+     * isPassThrough() 函數
+     * 判斷圖形的前 numChannels 個輸出通道是否都原樣來自相同編號的輸入通道
+     *
+     * 條件（每個輸出通道 c）：
+     * - 只有一條連線接入 Output 的通道 c，路徑上每條連線的增益都是 1
+     * - 沿連線往回追溯，只經過已旁通且延遲為 0 的節點
+     * - 最終來源是 Input 的通道 c
+     *
+     * 任何混音、通道交換、啟用中的外掛或未連接的輸出都會回傳 false
+     *
+     * @param graph       要分析的圖形（訊息執行緒）
+     * @param numChannels 設備實際使用的輸出通道數
+     */
+    [[nodiscard]] bool isPassThrough(const juce::AudioProcessorGraph &graph, int numChannels);
+
+    /**
+     * NodeLatency 結構
+     * 單一節點的延遲（樣本數）
+     */
+    struct NodeLatency
+    {
+        int ownSamples = 0;  // 節點本身的 getLatencySamples()
+        int pathSamples = 0; // 從最上游經最長的音頻連線路徑到此節點輸出的累積延遲
+    };
+
+    using LatencyMap = std::map<juce::AudioProcessorGraph::NodeID, NodeLatency>;
+
+    /**
+     * computePathLatencies() 函數
+     * 計算圖形中每個節點的延遲；MIDI 連線不計入
+     *
+     * Output 節點的 pathSamples 即為整個圖形最長路徑的延遲
+     *
+     * @param graph 要分析的圖形（訊息執行緒）
+     */
+    [[nodiscard]] LatencyMap computePathLatencies(const juce::AudioProcessorGraph &graph);
+
+    /**
+     * UsedChannels 結構
+     * 連線用到的設備通道數（最大通道索引 + 1，沒有連線時為 0）
+     */
+    struct UsedChannels
+    {
+        int numInputs = 0;  // 來自 Input 節點的連線
+        int numOutputs = 0; // 接入 Output 節點的連線
+    };
+
+    /**
+     * getUsedIOChannels() 函數
+     * 統計 Input / Output 節點實際被連線用到的通道範圍；MIDI 連線不計入
+     *
+     * @param graph 要分析的圖形（訊息執行緒）
+     */
+    [[nodiscard]] UsedChannels getUsedIOChannels(const juce::AudioProcessorGraph &graph);
+} // namespace GraphAnalysis
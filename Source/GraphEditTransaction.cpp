@@ -0,0 +1,88 @@
+/*
+ * GraphEditTransaction.cpp
+ * LightHost - AudioProcessorGraph 批次編輯實作
+ */
+
+#include "GraphEditTransaction.h"
+#include "GraphRenderPlan.h"
+
+#include <algorithm>
+
+namespace
+{
+    using UpdateKind = juce::AudioProcessorGraph::UpdateKind;
+}
+
+GraphEditTransaction::Graph::Node::Ptr GraphEditTransaction::addNode(std::unique_ptr<juce::AudioProcessor> processor,
+                                                                     std::optional<Graph::NodeID> nodeId)
+{
+    auto node = graph.addNode(std::move(processor), nodeId, UpdateKind::none);
+    record(node != nullptr);
+    return node;
+}
+
+bool GraphEditTransaction::removeNode(Graph::NodeID nodeId)
+{
+    return record(graph.removeNode(nodeId, UpdateKind::none) != nullptr);
+}
+
+bool GraphEditTransaction::addConnection(const Graph::Connection &connection)
+{
+    return record(graph.addConnection(connection, UpdateKind::none));
+}
+
+bool GraphEditTransaction::removeConnection(const Graph::Connection &connection)
+{
+    return record(graph.removeConnection(connection, UpdateKind::none));
+}
+
+bool GraphEditTransaction::disconnectNode(Graph::NodeID nodeId)
+{
+    return record(graph.disconnectNode(nodeId, UpdateKind::none));
+}
+
+bool GraphEditTransaction::setBusesLayout(Graph::NodeID nodeId, const juce::AudioProcessor::BusesLayout &layout)
+{
+    auto node = graph.getNodeForId(nodeId);
+    if (node == nullptr)
+        return false;
+
+    auto *processor = node->getProcessor();
+    if (processor->getBusesLayout() == layout || !processor->checkBusesLayoutSupported(layout))
+        return false;
+
+    // Once both return, no renderer is inside this processor and none will call it, while the rest
+    // of the graph keeps playing: the graph's own render sequence honours suspendProcessing() (under
+    // the callback lock), the lock-free render plans honour the node's gate
+    if (std::find(suspendedNodes.begin(), suspendedNodes.end(), node) == suspendedNodes.end())
+    {
+        GraphRenderPlan::ProcessingGate::getFor(*node)->close();
+        processor->suspendProcessing(true);
+        suspendedNodes.push_back(node);
+    }
+
+    processor->releaseResources();
+    const bool changed = processor->setBusesLayout(layout);
+
+    // An unprepared graph prepares the node itself in prepareToPlay()
+    if (graph.getSampleRate() > 0.0)
+        processor->prepareToPlay(graph.getSampleRate(), graph.getBlockSize());
+
+    return record(changed);
+}
+
+void GraphEditTransaction::commit()
+{
+    if (numPendingEdits > 0)
+    {
+        numPendingEdits = 0;
+        graph.rebuild();
+    }
+
+    for (auto &node : suspendedNodes)
+    {
+        node->getProcessor()->suspendProcessing(false);
+        GraphRenderPlan::ProcessingGate::getFor(*node)->open();
+    }
+    suspendedNodes.clear();
+}
@@ -0,0 +1,99 @@
+/*
+ * GraphEditTransaction.h
+ * LightHost - AudioProcessorGraph 批次編輯（單次重建）
+ *
+ * 功能說明：
+ * - AudioProcessorGraph 的 addNode / removeNode / addConnection / removeConnection
+ *   預設每次呼叫都會同步重建渲染序列
+ * - 還原工作階段、中斷節點所有連線等操作會在迴圈中呼叫它們，重建次數與連線數成正比
+ * - 本類別以 UpdateKind::none 套用所有編輯，commit() 時只呼叫一次 graph.rebuild()
+ * - setBusesLayout() 變更節點的通道數時只暫停該處理器，直到 commit() 重建完成
+ *
+ * 使用方式：
+ *   GraphEditTransaction edit(graph);
+ *   edit.addConnection(...);
+ *   edit.removeNode(...);
+ *   edit.commit();          // 或讓解構子自動提交
+ *
+ * 執行緒：
+ * - 與 AudioProcessorGraph 的編輯方法相同，只能在訊息執行緒使用
+ * - 提交前音頻執行緒繼續使用舊的渲染序列（setBusesLayout() 變更的處理器改為輸出靜音）
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <vector>
+
+class GraphEditTransaction
+{
+public:
+    using Graph = juce::AudioProcessorGraph;
+
+    /** 開始一次批次編輯 */
+    explicit GraphEditTransaction(Graph &graphToEdit) noexcept : graph(graphToEdit) {}
+
+    /** 尚未提交時自動提交 */
+    ~GraphEditTransaction() { commit(); }
+
+    /**
+     * addNode() 方法
+     * 加入處理器節點（不重建）
+     *
+     * @param processor 要加入的處理器
+     * @param nodeId    指定的節點 ID；空值表示自動配置
+     * @return 新節點，失敗時為 nullptr
+     */
+    Graph::Node::Ptr addNode(std::unique_ptr<juce::AudioProcessor> processor, std::optional<Graph::NodeID> nodeId = std::nullopt);
+
+    /** 移除節點及其所有連線（不重建）；節點不存在時回傳 false */
+    bool removeNode(Graph::NodeID nodeId);
+
+    /** 加入連線（不重建）；連線無效或已存在時回傳 false */
+    bool addConnection(const Graph::Connection &connection);
+
+    /** 移除連線（不重建）；連線不存在時回傳 false */
+    bool removeConnection(const Graph::Connection &connection);
+
+    /** 移除節點的所有連線（不重建）；沒有任何連線時回傳 false */
+    bool disconnectNode(Graph::NodeID nodeId);
+
+    /**
+     * setBusesLayout() 方法
+     * 變更節點處理器的匯流排配置（例如把立體聲外掛擴充為 8 通道）
+     *
+     * 舊的渲染序列仍以原本的通道數呼叫處理器，因此先暫停這個處理器（其餘節點照常渲染），
+     * 處理器以新配置重新準備，commit() 重建後才恢復
+     *
+     * @param nodeId 節點 ID
+     * @param layout 新的匯流排配置
+     * @return 配置有變更時回傳 true；節點不存在、配置相同或處理器不支援時回傳 false
+     */
+    bool setBusesLayout(Graph::NodeID nodeId, const juce::AudioProcessor::BusesLayout &layout);
+
+    /**
+     * commit() 方法
+     * 若有任何編輯生效，呼叫一次 graph.rebuild()；重複呼叫不會再次重建
+     * setBusesLayout() 暫停的處理器在此恢復
+     */
+    void commit();
+
+    /** 目前已生效、尚未提交的編輯數 */
+    [[nodiscard]] int getNumPendingEdits() const noexcept { return numPendingEdits; }
+
+    [[nodiscard]] Graph &getGraph() noexcept { return graph; }
+
+private:
+    bool record(bool changed) noexcept
+    {
+        numPendingEdits += changed ? 1 : 0;
+        return changed;
+    }
+
+    Graph &graph;
+    int numPendingEdits = 0;
+    std::vector<Graph::Node::Ptr> suspendedNodes; // Kept alive even if removed before commit()
+
+    JUCE_DECLARE_NON_COPYABLE(GraphEditTransaction)
+};
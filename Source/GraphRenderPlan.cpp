@@ -0,0 +1,592 @@
+/*
+ * GraphRenderPlan.cpp
+ * LightHost - AudioProcessorGraph 的可平行渲染計畫實作
+ */
+
+#include "GraphRenderPlan.h"
+
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+    using Graph = juce::AudioProcessorGraph;
+    using IOProcessor = Graph::AudioGraphIOProcessor;
+
+    /** MIDI 緩衝區預先配置的大小，避免在音頻執行緒配置 */
+    constexpr int midiBufferBytes = 2048;
+
+    /** 每條延遲線至少能容納的延遲（樣本）；外掛執行中增加延遲時不必重新編譯 */
+    constexpr int delayHeadroomSamples = 4096;
+
+    /** 目的節點上每條連線的增益，以（來源節點、來源通道、目的通道）為鍵（訊息執行緒） */
+    struct WireGainTable : public juce::ReferenceCountedObject
+    {
+        std::map<std::tuple<juce::uint32, int, int>, GraphRenderPlan::WireGain::Ptr> gains;
+    };
+
+    std::tuple<juce::uint32, int, int> getWireGainKey(const Graph::Connection &connection)
+    {
+        return {connection.source.nodeID.uid, connection.source.channelIndex, connection.destination.channelIndex};
+    }
+
+    WireGainTable *findWireGainTable(const Graph &graph, Graph::NodeID destination)
+    {
+        if (auto *node = graph.getNodeForId(destination))
+            return dynamic_cast<WireGainTable *>(node->properties[GraphRenderPlan::wireGainsProperty].getObject());
+        return nullptr;
+    }
+
+    GraphRenderPlan::WireGain::Ptr findWireGain(const Graph &graph, const Graph::Connection &connection)
+    {
+        if (auto *table = findWireGainTable(graph, connection.destination.nodeID))
+            if (const auto found = table->gains.find(getWireGainKey(connection)); found != table->gains.end())
+                return found->second;
+        return nullptr;
+    }
+
+    /** destination += source * gain, the gain moving linearly from startGain to endGain; vectorised when steady */
+    void addWithGain(const float *source, float *destination, int numSamples, float startGain, float endGain) noexcept
+    {
+        if (startGain == endGain)
+        {
+            if (endGain == 1.0f)
+                juce::FloatVectorOperations::add(destination, source, numSamples);
+            else if (endGain != 0.0f)
+                juce::FloatVectorOperations::addWithMultiply(destination, source, endGain, numSamples);
+            return;
+        }
+
+        const float increment = (endGain - startGain) / (float)numSamples;
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] += source[i] * (startGain + increment * (float)i);
+    }
+} // namespace
+
+void GraphRenderPlan::setWireGain(Graph &graph, const Graph::Connection &connection, float gain)
+{
+    auto *node = graph.getNodeForId(connection.destination.nodeID);
+    if (node == nullptr)
+        return;
+
+    auto *table = findWireGainTable(graph, connection.destination.nodeID);
+    if (table == nullptr)
+    {
+        table = new WireGainTable();
+        node->properties.set(wireGainsProperty, juce::var(table));
+    }
+
+    auto &wireGain = table->gains[getWireGainKey(connection)];
+    if (wireGain == nullptr)
+        wireGain = new WireGain();
+    wireGain->gain.store(gain, std::memory_order_relaxed);
+}
+
+float GraphRenderPlan::getWireGain(const Graph &graph, const Graph::Connection &connection)
+{
+    const auto wireGain = findWireGain(graph, connection);
+    return wireGain != nullptr ? wireGain->gain.load(std::memory_order_relaxed) : 1.0f;
+}
+
+void GraphRenderPlan::removeWireGain(Graph &graph, const Graph::Connection &connection)
+{
+    // Plans that still render the connection keep their reference to the gain
+    if (auto *table = findWireGainTable(graph, connection.destination.nodeID))
+        table->gains.erase(getWireGainKey(connection));
+}
+
+GraphRenderPlan::Topology GraphRenderPlan::capture(const Graph &graph)
+{
+    Topology topology;
+    topology.numInputs = graph.getTotalNumInputChannels();
+    topology.numOutputs = graph.getTotalNumOutputChannels();
+
+    // Processor nodes; the I/O nodes become the device input copy and the output gather
+    for (auto *node : graph.getNodes())
+    {
+        auto *processor = node->getProcessor();
+        if (auto *io = dynamic_cast<IOProcessor *>(processor))
+        {
+            if (io->getType() == IOProcessor::audioInputNode)
+                topology.inputNodeID = node->nodeID;
+            else if (io->getType() == IOProcessor::audioOutputNode)
+                topology.outputNodeID = node->nodeID;
+            continue; // MIDI I/O nodes carry no audio
+        }
+        if (node->properties[parkedProperty])
+            continue; // Kept prepared by the instance cache, not rendered
+        topology.nodes.push_back({node,
+                                  ProcessingGate::getFor(*node),
+                                  juce::jmax(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels()),
+                                  processor->getLatencySamples()});
+    }
+
+    for (const auto &connection : graph.getConnections())
+        if (!connection.source.isMIDI())
+        {
+            topology.connections.push_back(connection);
+            topology.connectionGains.push_back(findWireGain(graph, connection));
+        }
+
+    return topology;
+}
+
+GraphRenderPlan::~GraphRenderPlan()
+{
+    if (timing == nullptr)
+        return;
+
+    std::vector<int> slots;
+    slots.reserve(steps.size());
+    for (const auto &step : steps)
+        slots.push_back(step->timingSlot);
+    timing->releaseSlots(slots);
+}
+
+std::unique_ptr<GraphRenderPlan> GraphRenderPlan::build(Topology topology, int maxBlockSize, NodeTimingMonitor *timing)
+{
+    std::unique_ptr<GraphRenderPlan> plan(new GraphRenderPlan());
+    plan->timing = timing;
+    plan->numInputs = topology.numInputs;
+    plan->numOutputs = topology.numOutputs;
+    plan->blockSize = juce::jmax(1, maxBlockSize);
+    plan->inputCopy.setSize(juce::jmax(1, plan->numInputs), plan->blockSize);
+
+    const auto inputNodeID = topology.inputNodeID, outputNodeID = topology.outputNodeID;
+    const auto &audioConnections = topology.connections;
+
+    std::map<Graph::NodeID, const Topology::NodeInfo *> nodeInfo;
+    for (const auto &info : topology.nodes)
+        nodeInfo[info.node->nodeID] = &info;
+
+    // Kahn's algorithm over the processor nodes; the order doubles as the serial render order
+    std::map<Graph::NodeID, std::set<Graph::NodeID>> downstream;
+    std::map<Graph::NodeID, int> numUpstream;
+    for (const auto &connection : audioConnections)
+    {
+        const auto from = connection.source.nodeID, to = connection.destination.nodeID;
+        if (from == inputNodeID || to == outputNodeID || from == to)
+            continue;
+        if (downstream[from].insert(to).second)
+            ++numUpstream[to];
+    }
+
+    std::vector<const Topology::NodeInfo *> order;
+    std::map<Graph::NodeID, int> level;
+    for (const auto &info : topology.nodes)
+        if (numUpstream[info.node->nodeID] == 0)
+            order.push_back(&info);
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const auto id = order[i]->node->nodeID;
+        for (const auto &next : downstream[id])
+        {
+            level[next] = juce::jmax(level[next], level[id] + 1);
+            if (--numUpstream[next] == 0)
+                if (const auto found = nodeInfo.find(next); found != nodeInfo.end())
+                    order.push_back(found->second);
+        }
+    }
+
+    if (order.size() != topology.nodes.size())
+    {
+        // A cycle: leave it to the graph's own renderer
+        plan->hasCycle = true;
+        plan->retainedNodes.reserve(topology.nodes.size());
+        for (auto &info : topology.nodes)
+            plan->retainedNodes.push_back(std::move(info.node));
+        return plan;
+    }
+
+    std::map<Graph::NodeID, int> stepIndex;
+    std::map<int, int> stepsPerLevel;
+    for (const auto *info : order)
+    {
+        auto step = std::make_unique<Step>();
+        step->node = info->node;
+        step->gate = info->gate;
+        step->processor = info->node->getProcessor();
+        step->numChannels = info->numChannels;
+        step->latencySamples = info->latencySamples;
+        step->buffer.setSize(juce::jmax(1, step->numChannels), plan->blockSize);
+        step->midi.ensureSize(midiBufferBytes);
+
+        stepIndex[info->node->nodeID] = (int)plan->steps.size();
+        plan->parallelWidth = juce::jmax(plan->parallelWidth, ++stepsPerLevel[level[info->node->nodeID]]);
+        plan->steps.push_back(std::move(step));
+    }
+
+    // Resolve every audio connection to a step input or a device output, dropping out-of-range channels
+    auto resolveSource = [&](const Graph::NodeAndChannel &source, Source &resolved)
+    {
+        if (source.nodeID == inputNodeID)
+        {
+            resolved.step = -1;
+            resolved.channel = source.channelIndex;
+            return source.channelIndex < plan->numInputs;
+        }
+
+        const auto found = stepIndex.find(source.nodeID);
+        if (found == stepIndex.end())
+            return false;
+        resolved.step = found->second;
+        resolved.channel = source.channelIndex;
+        return source.channelIndex < plan->steps[(size_t)found->second]->numChannels;
+    };
+
+    for (size_t i = 0; i < audioConnections.size(); ++i)
+    {
+        const auto &connection = audioConnections[i];
+        Source source;
+        if (!resolveSource(connection.source, source))
+            continue;
+        source.destinationChannel = connection.destination.channelIndex;
+        if (i < topology.connectionGains.size() && topology.connectionGains[i] != nullptr)
+        {
+            source.wireGain = topology.connectionGains[i];
+            source.gain = source.gainTarget = source.wireGain->gain.load(std::memory_order_relaxed);
+        }
+
+        if (connection.destination.nodeID == outputNodeID)
+        {
+            if (source.destinationChannel < plan->numOutputs)
+                plan->outputs.push_back(source);
+            continue;
+        }
+
+        const auto found = stepIndex.find(connection.destination.nodeID);
+        if (found == stepIndex.end() || found->second == source.step)
+            continue;
+
+        auto &step = *plan->steps[(size_t)found->second];
+        if (source.destinationChannel < step.numChannels)
+            step.inputs.push_back(source);
+    }
+
+    if (timing != nullptr)
+    {
+        std::vector<juce::uint32> nodeUids;
+        for (const auto &step : plan->steps)
+            nodeUids.push_back(step->node->nodeID.uid);
+
+        const auto slots = timing->assignSlots(nodeUids);
+        for (size_t i = 0; i < slots.size(); ++i)
+            plan->steps[i]->timingSlot = slots[i];
+    }
+
+    // Dependencies, and the longest path latency the delay lines must be able to absorb
+    int maxPathLatency = 0;
+    plan->pathLatency.assign(plan->steps.size(), 0);
+    for (size_t i = 0; i < plan->steps.size(); ++i)
+    {
+        auto &step = *plan->steps[i];
+        std::set<int> upstream;
+        int inputLatency = 0;
+        for (const auto &source : step.inputs)
+            if (source.step >= 0)
+            {
+                upstream.insert(source.step);
+                inputLatency = juce::jmax(inputLatency, plan->pathLatency[(size_t)source.step]);
+            }
+
+        for (const int previous : upstream)
+            plan->steps[(size_t)previous]->dependents.push_back((int)i);
+        step.numDependencies = (int)upstream.size();
+        if (step.numDependencies == 0)
+            plan->rootSteps.push_back((int)i);
+
+        plan->pathLatency[i] = inputLatency + step.latencySamples;
+        maxPathLatency = juce::jmax(maxPathLatency, plan->pathLatency[i]);
+    }
+
+    // Delay lines: one per source feeding a merge of two or more origins (only there can path
+    // latencies differ), plus one per channel of each step for its bypassed dry path
+    int numDelayLines = 0;
+    auto assignMergeDelays = [&numDelayLines](std::vector<Source> &sources)
+    {
+        std::set<int> origins;
+        for (const auto &source : sources)
+            origins.insert(source.step);
+        if (origins.size() > 1)
+            for (auto &source : sources)
+                source.delayLine = numDelayLines++;
+    };
+
+    for (auto &step : plan->steps)
+    {
+        assignMergeDelays(step->inputs);
+        step->firstBypassDelayLine = numDelayLines;
+        numDelayLines += step->numChannels;
+    }
+    assignMergeDelays(plan->outputs);
+
+    // Every line comes out of one preallocated pool
+    const int delayCapacity = juce::nextPowerOfTwo(juce::jmax(delayHeadroomSamples, maxPathLatency + 1));
+    plan->delayPool.assign((size_t)numDelayLines * (size_t)delayCapacity, 0.0f);
+    plan->delayLines.resize((size_t)numDelayLines);
+    for (int i = 0; i < numDelayLines; ++i)
+        plan->delayLines[(size_t)i].attach(plan->delayPool.data() + (size_t)i * (size_t)delayCapacity, delayCapacity);
+
+    plan->updateDelays();
+    return plan;
+}
+
+const float *GraphRenderPlan::getSourceData(const Source &source) const noexcept
+{
+    return source.step < 0 ? inputCopy.getReadPointer(source.channel)
+                           : steps[(size_t)source.step]->buffer.getReadPointer(source.channel);
+}
+
+void GraphRenderPlan::beginBlock(const juce::AudioBuffer<float> &buffer, int numSamples) noexcept
+{
+    currentNumSamples = juce::jmin(numSamples, blockSize);
+
+    // Copied once, so an Input -> Output wire may reorder channels of the in-place device buffer
+    const int numCopied = juce::jmin(numInputs, buffer.getNumChannels());
+    for (int ch = 0; ch < inputCopy.getNumChannels(); ++ch)
+    {
+        if (ch < numCopied)
+            inputCopy.copyFrom(ch, 0, buffer, ch, 0, currentNumSamples);
+        else
+            inputCopy.clear(ch, 0, currentNumSamples);
+    }
+
+    // A plugin that changed its latency (setLatencySamples) only moves the delay lines
+    bool latencyChanged = false;
+    for (auto &step : steps)
+    {
+        const int latency = step->processor->getLatencySamples();
+        latencyChanged = latencyChanged || latency != step->latencySamples;
+        step->latencySamples = latency;
+    }
+    if (latencyChanged)
+        updateDelays();
+
+    for (auto &step : steps)
+        step->pending.store(step->numDependencies, std::memory_order_relaxed);
+}
+
+bool GraphRenderPlan::updateDelays() noexcept
+{
+    bool fits = true;
+    auto sourceLatency = [this](const Source &source)
+    { return source.step < 0 ? 0 : pathLatency[(size_t)source.step]; };
+
+    // Delay every source of a merge up to the latest one arriving there
+    auto alignSources = [&](const std::vector<Source> &sources)
+    {
+        int latest = 0;
+        for (const auto &source : sources)
+            latest = juce::jmax(latest, sourceLatency(source));
+        for (const auto &source : sources)
+            if (source.delayLine >= 0)
+                fits = delayLines[(size_t)source.delayLine].setDelay(latest - sourceLatency(source)) && fits;
+        return latest;
+    };
+
+    for (size_t i = 0; i < steps.size(); ++i)
+    {
+        auto &step = *steps[i];
+        pathLatency[i] = alignSources(step.inputs) + step.latencySamples;
+        for (int ch = 0; ch < step.numChannels; ++ch)
+            fits = delayLines[(size_t)(step.firstBypassDelayLine + ch)].setDelay(step.latencySamples) && fits;
+    }
+    outputLatency = alignSources(outputs);
+
+    delayOverflow.store(!fits, std::memory_order_relaxed);
+    return fits;
+}
+
+void GraphRenderPlan::processStep(int index) noexcept
+{
+    auto &step = *steps[(size_t)index];
+    auto *processor = step.processor;
+
+    // Sum every incoming wire into the step's own buffer, then process it in place
+    juce::AudioBuffer<float> block(step.buffer.getArrayOfWritePointers(), step.numChannels, currentNumSamples);
+    block.clear();
+    for (auto &source : step.inputs)
+        addSource(source, block.getWritePointer(source.destinationChannel), currentNumSamples);
+    step.midi.clear();
+
+    // Bypassed: the plugin is not called at all, and the dry signal keeps the plugin's latency;
+    // the delay starts empty so no audio left over from an earlier bypass comes back
+    if (step.node->isBypassed())
+    {
+        for (int ch = 0; ch < step.numChannels; ++ch)
+        {
+            auto &delay = delayLines[(size_t)(step.firstBypassDelayLine + ch)];
+            if (!step.wasBypassed)
+                delay.clear();
+            delay.process(block.getWritePointer(ch), currentNumSamples);
+        }
+        step.wasBypassed = true;
+        if (timing != nullptr)
+            timing->record(step.timingSlot, 0, currentNumSamples);
+        return;
+    }
+    step.wasBypassed = false;
+
+    // No callback lock: a transaction reconfiguring the processor closes its gate first. A closed
+    // gate, a suspended processor or a channel count that changed since this plan was built all
+    // mean silence until the next plan
+    if (!step.gate->tryEnter())
+    {
+        block.clear();
+        return;
+    }
+
+    if (processor->isSuspended()
+        || juce::jmax(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels()) > step.numChannels)
+        block.clear();
+    else if (timing != nullptr)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor->processBlock(block, step.midi);
+        timing->record(step.timingSlot, juce::Time::getHighResolutionTicks() - start, currentNumSamples);
+    }
+    else
+        processor->processBlock(block, step.midi);
+
+    step.gate->exit();
+}
+
+void GraphRenderPlan::processSerially() noexcept
+{
+    for (int i = 0; i < (int)steps.size(); ++i)
+        processStep(i);
+}
+
+void GraphRenderPlan::endBlock(juce::AudioBuffer<float> &buffer) noexcept
+{
+    const int numSamples = juce::jmin(currentNumSamples, buffer.getNumSamples());
+    buffer.clear(0, numSamples);
+
+    for (auto &source : outputs)
+        if (source.destinationChannel < buffer.getNumChannels())
+            addSource(source, buffer.getWritePointer(source.destinationChannel), numSamples);
+}
+
+void GraphRenderPlan::addSource(Source &source, float *destination, int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    // A changed wire gain ramps linearly over wireGainRampSamples, across as many blocks as that takes
+    const float startGain = source.gain;
+    if (source.wireGain != nullptr)
+    {
+        const float target = source.wireGain->gain.load(std::memory_order_relaxed);
+        if (target != source.gainTarget)
+        {
+            source.gainTarget = target;
+            source.gainStep = (target - startGain) / (float)wireGainRampSamples;
+        }
+
+        if (startGain != target)
+        {
+            const float next = startGain + source.gainStep * (float)numSamples;
+            const bool arrived = source.gainStep == 0.0f || (source.gainStep > 0.0f ? next >= target : next <= target);
+            source.gain = arrived ? target : next;
+        }
+    }
+
+    if (source.delayLine >= 0)
+        delayLines[(size_t)source.delayLine].addDelayed(getSourceData(source), destination, numSamples, startGain, source.gain);
+    else
+        addWithGain(getSourceData(source), destination, numSamples, startGain, source.gain);
+}
+
+//==============================================================================
+GraphRenderPlan::ProcessingGate::Ptr GraphRenderPlan::ProcessingGate::getFor(Graph::Node &node)
+{
+    if (auto *existing = dynamic_cast<ProcessingGate *>(node.properties[gateProperty].getObject()))
+        return existing;
+
+    Ptr gate(new ProcessingGate());
+    node.properties.set(gateProperty, juce::var(gate.get()));
+    return gate;
+}
+
+bool GraphRenderPlan::ProcessingGate::tryEnter() noexcept
+{
+    // Announce first, then check: close() either sees this thread inside or this thread sees it closed
+    active.fetch_add(1, std::memory_order_seq_cst);
+    if (!closed.load(std::memory_order_seq_cst))
+        return true;
+
+    exit();
+    return false;
+}
+
+void GraphRenderPlan::ProcessingGate::close() noexcept
+{
+    closed.store(true, std::memory_order_seq_cst);
+    while (active.load(std::memory_order_seq_cst) > 0)
+        juce::Thread::yield(); // At most the rest of one processBlock
+}
+
+//==============================================================================
+void GraphRenderPlan::DelayLine::attach(float *storage, int capacityPowerOfTwo) noexcept
+{
+    jassert(juce::isPowerOfTwo(capacityPowerOfTwo));
+    ring = storage;
+    capacity = capacityPowerOfTwo;
+    clear();
+}
+
+bool GraphRenderPlan::DelayLine::setDelay(int samples) noexcept
+{
+    const int clamped = juce::jlimit(0, capacity - 1, samples);
+    if (clamped != delay)
+    {
+        // The ring holds audio for the old delay; restarting silent beats replaying it shifted
+        delay = clamped;
+        clear();
+    }
+    return clamped == samples;
+}
+
+void GraphRenderPlan::DelayLine::clear() noexcept
+{
+    if (ring != nullptr)
+        juce::FloatVectorOperations::clear(ring, capacity);
+    writePosition = 0;
+}
+
+void GraphRenderPlan::DelayLine::process(float *samples, int numSamples) noexcept
+{
+    if (delay == 0)
+        return;
+
+    const int mask = capacity - 1;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        ring[writePosition] = samples[i];
+        samples[i] = ring[(writePosition - delay) & mask];
+        writePosition = (writePosition + 1) & mask;
+    }
+}
+
+void GraphRenderPlan::DelayLine::addDelayed(const float *source, float *destination, int numSamples,
+                                            float startGain, float endGain) noexcept
+{
+    if (delay == 0)
+    {
+        addWithGain(source, destination, numSamples, startGain, endGain);
+        return;
+    }
+
+    // The ring is fed even while muted, so unmuting plays the delayed audio, not stale samples
+    const int mask = capacity - 1;
+    const float increment = (endGain - startGain) / (float)numSamples;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        ring[writePosition] = source[i];
+        destination[i] += ring[(writePosition - delay) & mask] * (startGain + increment * (float)i);
+        writePosition = (writePosition + 1) & mask;
+    }
+}
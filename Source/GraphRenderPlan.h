@@ -0,0 +1,299 @@
+/*
+ * GraphRenderPlan.h
+ * LightHost - AudioProcessorGraph 的可平行渲染計畫
+ *
+ * 功能說明：
+ * - 把 AudioProcessorGraph 的節點與音頻連線編譯成步驟（每個處理器節點一個步驟）
+ * - 每個步驟有自己的緩衝區：輸入連線以向量化加法累加進來，再就地處理
+ * - 連線增益（setWireGain）在累加時套用（addWithMultiply，變更時線性過渡），
+ *   不需要額外的增益節點或緩衝區複製
+ * - 記錄步驟之間的相依關係（上游 / 下游），互不相依的分支可以同時在不同執行緒執行
+ * - 設備輸入在區塊開始時複製一次，Output 節點的來源在所有步驟完成後累加到設備輸出
+ * - 提供 NodeTimingMonitor 時，量測每個步驟 processBlock 的耗時
+ * - 旁通（Node::setBypassed）的節點完全不呼叫處理器：乾訊號經過與外掛回報延遲相同的延遲線，
+ *   切換旁通不會改變下游的時間對齊
+ * - Node::properties 標記 parkedProperty 的節點（PluginInstanceCache 暫存的外掛）不編入計畫
+ * - 步驟不取得處理器的 callback lock：GraphEditTransaction 變更配置前關閉節點的 ProcessingGate，
+ *   關閉期間步驟輸出靜音
+ *
+ * 延遲補償：
+ * - 依各處理器的 getLatencySamples() 計算每個步驟的路徑延遲
+ * - 兩個以上來源匯合的地方（步驟輸入或設備輸出），較早到達的來源經過延遲線補到最晚的一條
+ * - 所有延遲線在 build() 時從同一個預先配置的池取得，容量至少 4096 樣本
+ * - 每個區塊開頭檢查處理器的延遲；外掛執行中改變延遲（setLatencySamples）只重新設定延遲線，
+ *   不需要重新編譯。超出容量時延遲被截斷，hasDelayOverflow() 提示呼叫端重新編譯
+ *
+ * 執行緒：
+ * - capture() 在訊息執行緒：只複製節點參照、連線與通道數 / 延遲，不配置緩衝區
+ * - build() 可在任何執行緒（ParallelGraphProcessor 的背景編譯執行緒），配置所有記憶體
+ * - beginBlock() / processStep() / endBlock() 在音頻執行緒及工作執行緒，不配置記憶體也不取得任何鎖
+ * - 同一個步驟同一時間只會被一個執行緒處理；相依計數由 ParallelGraphExecutor 維護
+ *
+ * 限制：
+ * - 只處理音頻連線；MIDI 連線不會傳遞（每個步驟收到空的 MidiBuffer）
+ * - 不處理迴圈：圖形含有迴圈時 requiresGraphRenderer() 為 true，
+ *   由 ParallelGraphProcessor 改用 AudioProcessorGraph 自己的渲染序列（該序列不套用連線增益）
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+#include "NodeTimingMonitor.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class GraphRenderPlan
+{
+public:
+    using Graph = juce::AudioProcessorGraph;
+
+    /** 為 true 時 capture() 略過這個節點 */
+    static inline const juce::Identifier parkedProperty{"lighthostParked"};
+
+    /**
+     * ProcessingGate 類別
+     * 節點處理器的無鎖閘門，存放在 Node::properties（gateProperty），所有含有該節點的計畫共用
+     *
+     * - 步驟呼叫處理器前 tryEnter()；閘門關閉時不呼叫處理器，也從不等待
+     * - close() 等到進行中的 processBlock 結束才返回，之後可以安全地重新配置處理器
+     * - close() / open() 與 getFor() 只能在訊息執行緒呼叫
+     */
+    class ProcessingGate : public juce::ReferenceCountedObject
+    {
+    public:
+        using Ptr = juce::ReferenceCountedObjectPtr<ProcessingGate>;
+
+        /** 節點的閘門；沒有時建立 */
+        static Ptr getFor(Graph::Node &node);
+
+        bool tryEnter() noexcept;
+        void exit() noexcept { active.fetch_sub(1, std::memory_order_release); }
+
+        void close() noexcept;
+        void open() noexcept { closed.store(false, std::memory_order_seq_cst); }
+
+    private:
+        std::atomic<int> active{0};
+        std::atomic<bool> closed{false};
+    };
+
+    static inline const juce::Identifier gateProperty{"lighthostGate"};
+
+    /** 連線增益變更時的線性過渡長度（樣本） */
+    static constexpr int wireGainRampSamples = 1024;
+
+    /** 一條圖形連線的線性增益；所有含有這條連線的計畫共用，音頻執行緒每個區塊讀取一次 */
+    class WireGain : public juce::ReferenceCountedObject
+    {
+    public:
+        using Ptr = juce::ReferenceCountedObjectPtr<WireGain>;
+
+        std::atomic<float> gain{1.0f};
+    };
+
+    /**
+     * setWireGain() 函數
+     * 設定連線的線性增益（訊息執行緒）；存放在目的節點的 Node::properties（wireGainsProperty）
+     *
+     * 連線已有增益時只更新數值，執行中的計畫平滑過渡，不必重新編譯；
+     * 第一次設定的增益從下一個計畫開始生效（呼叫端通常同時加入連線）
+     */
+    static void setWireGain(Graph &graph, const Graph::Connection &connection, float gain);
+
+    /** 移除連線的增益（訊息執行緒；連線移除時） */
+    static void removeWireGain(Graph &graph, const Graph::Connection &connection);
+
+    /** 連線目前的線性增益；沒有設定時為 1（訊息執行緒） */
+    [[nodiscard]] static float getWireGain(const Graph &graph, const Graph::Connection &connection);
+
+    static inline const juce::Identifier wireGainsProperty{"lighthostWireGains"};
+
+    /** 連線來源：step < 0 表示設備輸入；delayLine < 0 表示不需要延遲補償；wireGain 為空表示增益 1 */
+    struct Source
+    {
+        int step = -1;
+        int channel = 0;
+        int destinationChannel = 0;
+        int delayLine = -1;
+        WireGain::Ptr wireGain;
+        float gain = 1.0f;       // Applied at the end of the last block (audio thread)
+        float gainTarget = 1.0f;
+        float gainStep = 0.0f;   // Per sample, towards gainTarget
+    };
+
+    /** 圖形某一時刻的快照：編譯計畫所需的一切，不必再讀取圖形 */
+    struct Topology
+    {
+        struct NodeInfo
+        {
+            Graph::Node::Ptr node;
+            ProcessingGate::Ptr gate;
+            int numChannels = 0;
+            int latencySamples = 0;
+        };
+
+        std::vector<NodeInfo> nodes; // Processor nodes only
+        std::vector<Graph::Connection> connections; // Audio connections only
+        std::vector<WireGain::Ptr> connectionGains;  // Parallel to connections; nullptr = unity
+        Graph::NodeID inputNodeID, outputNodeID;
+        int numInputs = 0;
+        int numOutputs = 0;
+    };
+
+    /**
+     * capture() 函數
+     * 擷取圖形目前的節點與連線（訊息執行緒，圖形編輯方法所在的執行緒）
+     *
+     * @param graph 要擷取的圖形（需已設定通道數）
+     */
+    [[nodiscard]] static Topology capture(const Graph &graph);
+
+    /**
+     * build() 函數
+     * 依快照建立渲染計畫（任何執行緒）
+     *
+     * 快照的節點參照移入計畫：已從圖形移除的節點由計畫保留到計畫被釋放，
+     * 因此節點只會在釋放計畫的執行緒（訊息執行緒）上被銷毀
+     *
+     * @param topology     capture() 的結果
+     * @param maxBlockSize 每個區塊的最大樣本數
+     * @param timing       記錄每個節點耗時的監測器（生命週期需長於計畫）；nullptr 表示不計時
+     * @return 渲染計畫；圖形含有迴圈時為空計畫，requiresGraphRenderer() 為 true
+     */
+    [[nodiscard]] static std::unique_ptr<GraphRenderPlan> build(Topology topology, int maxBlockSize,
+                                                                NodeTimingMonitor *timing = nullptr);
+
+    /** 歸還計時槽位（NodeTimingMonitor::releaseSlots()）；計畫只在非音頻執行緒釋放 */
+    ~GraphRenderPlan();
+
+    /** 步驟數（不含 I/O 節點） */
+    [[nodiscard]] int getNumSteps() const noexcept { return (int)steps.size(); }
+
+    /** 最多能同時執行的步驟數（依拓撲層級估計）；1 表示沒有平行分支 */
+    [[nodiscard]] int getParallelWidth() const noexcept { return parallelWidth; }
+
+    /** build() 時的最大區塊樣本數 */
+    [[nodiscard]] int getMaxBlockSize() const noexcept { return blockSize; }
+
+    /** 沒有上游步驟、區塊一開始就能執行的步驟 */
+    [[nodiscard]] const std::vector<int> &getRootSteps() const noexcept { return rootSteps; }
+
+    /** 下游步驟（每個只列一次） */
+    [[nodiscard]] const std::vector<int> &getDependents(int step) const noexcept { return steps[(size_t)step]->dependents; }
+
+    /** 計畫無法渲染這個圖形（含有迴圈），應改用圖形自己的渲染序列 */
+    [[nodiscard]] bool requiresGraphRenderer() const noexcept { return hasCycle; }
+
+    /** 補償後到達設備輸出的延遲（樣本） */
+    [[nodiscard]] int getOutputLatency() const noexcept { return outputLatency; }
+
+    /** 某條延遲線容量不足、延遲被截斷；應以目前的延遲重新編譯（任何執行緒） */
+    [[nodiscard]] bool hasDelayOverflow() const noexcept { return delayOverflow.load(std::memory_order_relaxed); }
+
+    /**
+     * beginBlock() 方法
+     * 複製設備輸入、依處理器目前的延遲調整延遲線，並重設每個步驟的相依計數（音頻執行緒）
+     *
+     * @param buffer     設備緩衝區（前 numInputs 個通道為輸入）
+     * @param numSamples 本區塊的樣本數（不超過 getMaxBlockSize()）
+     */
+    void beginBlock(const juce::AudioBuffer<float> &buffer, int numSamples) noexcept;
+
+    /** 處理一個步驟：累加輸入連線後呼叫處理器（任何參與渲染的執行緒） */
+    void processStep(int step) noexcept;
+
+    /**
+     * 扣除一個上游完成的計數
+     * @return 該步驟的所有上游都已完成（呼叫端應排程它）
+     */
+    bool releaseDependency(int step) noexcept
+    {
+        return steps[(size_t)step]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    /** 依拓撲順序處理所有步驟（沒有工作執行緒時） */
+    void processSerially() noexcept;
+
+    /** 把 Output 節點的來源累加到設備輸出；沒有來源的通道清為靜音（音頻執行緒） */
+    void endBlock(juce::AudioBuffer<float> &buffer) noexcept;
+
+private:
+    /** 單通道延遲線；緩衝區來自計畫的延遲線池，延遲可在容量內隨時調整 */
+    class DelayLine
+    {
+    public:
+        /** 使用池中的一段（容量需為 2 的次方） */
+        void attach(float *storage, int capacityPowerOfTwo) noexcept;
+
+        /** 設定延遲並清空；超出容量時截斷並回傳 false */
+        bool setDelay(int samples) noexcept;
+
+        void clear() noexcept;
+
+        /** 就地延遲 samples */
+        void process(float *samples, int numSamples) noexcept;
+
+        /** 把延遲後的 source 乘上 startGain 到 endGain 的線性過渡，累加到 destination */
+        void addDelayed(const float *source, float *destination, int numSamples, float startGain, float endGain) noexcept;
+
+    private:
+        float *ring = nullptr;
+        int capacity = 0;
+        int delay = 0;
+        int writePosition = 0;
+    };
+
+    struct Step
+    {
+        Graph::Node::Ptr node;
+        ProcessingGate::Ptr gate;
+        juce::AudioProcessor *processor = nullptr;
+        int numChannels = 0;
+        int latencySamples = 0;
+        int firstBypassDelayLine = 0; // numChannels lines: the dry path while bypassed
+        int timingSlot = -1;
+        bool wasBypassed = false;
+        std::vector<Source> inputs;
+        std::vector<int> dependents;
+        int numDependencies = 0;
+        std::atomic<int> pending{0};
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+    };
+
+    GraphRenderPlan() = default;
+
+    const float *getSourceData(const Source &source) const noexcept;
+
+    /** 把來源乘上它的連線增益累加到 destination，需要時經過它的延遲線 */
+    void addSource(Source &source, float *destination, int numSamples) noexcept;
+
+    /**
+     * 依步驟目前的延遲重新計算路徑延遲與每條延遲線（build() 及音頻執行緒，不配置記憶體）
+     * @return 所有延遲都在容量內
+     */
+    bool updateDelays() noexcept;
+
+    std::vector<std::unique_ptr<Step>> steps; // Topological order
+    std::vector<int> rootSteps;
+    std::vector<Source> outputs; // destinationChannel = device output channel
+    std::vector<int> pathLatency; // Per step, including the step's own latency
+    std::vector<float> delayPool;
+    std::vector<DelayLine> delayLines;
+    std::vector<Graph::Node::Ptr> retainedNodes; // A plan with a cycle has no steps to hold the captured nodes
+
+    juce::AudioBuffer<float> inputCopy;
+    NodeTimingMonitor *timing = nullptr;
+    int numInputs = 0;
+    int numOutputs = 0;
+    int blockSize = 0;
+    int currentNumSamples = 0;
+    int parallelWidth = 1;
+    int outputLatency = 0;
+    bool hasCycle = false;
+    std::atomic<bool> delayOverflow{false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GraphRenderPlan)
+};
@@ -0,0 +1,896 @@
+/*
+ * GraphSession.cpp
+ * LightHost - 工作階段模型與 AudioProcessorGraph 同步的實作
+ */
+
+#include "GraphSession.h"
+#include "GraphRenderPlan.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+    constexpr int maxPluginChannels = 8; // A Voicemeeter bus or strip (7.1)
+    constexpr int maxRestoreWorkers = 8;
+    constexpr size_t maxUndoSteps = 16;
+} // namespace
+
+//==============================================================================
+class GraphSession::ParameterListener : public juce::AudioProcessorListener
+{
+public:
+    explicit ParameterListener(GraphSession &ownerToUse) : owner(ownerToUse) {}
+
+    void audioProcessorChanged(juce::AudioProcessor *, const ChangeDetails &) override {}
+    void audioProcessorParameterChanged(juce::AudioProcessor *, int, float) override { owner.notifyChanged(); }
+
+private:
+    GraphSession &owner;
+};
+
+//==============================================================================
+GraphSession::GraphSession(Graph &graphToEdit, juce::AudioPluginFormatManager &formatManagerToUse,
+                           juce::KnownPluginList &knownPluginsToUse, juce::AudioDeviceManager *deviceManagerToUse)
+    : graph(graphToEdit), formatManager(formatManagerToUse), knownPlugins(knownPluginsToUse), deviceManager(deviceManagerToUse),
+      instanceCache(graphToEdit)
+{
+}
+
+GraphSession::~GraphSession()
+{
+    for (const auto &n : nodes)
+        unwatchParameters(n.graphNodeId);
+}
+
+void GraphSession::setPreparationSpec(double sampleRate, int blockSize) noexcept
+{
+    preparationSampleRate = sampleRate;
+    preparationBlockSize = blockSize;
+}
+
+void GraphSession::resetGraph()
+{
+    for (const auto &n : nodes)
+        unwatchParameters(n.graphNodeId);
+
+    nodes.clear();
+    wires.clear();
+    nextId = 1;
+    loadingPlugins.clear();
+    ++loadGeneration;
+    removedNodes.clear();
+    instanceCache.clear(); // Parked nodes go with the rest of the graph
+
+    graph.clear();
+    graph.addNode(std::make_unique<Graph::AudioGraphIOProcessor>(Graph::AudioGraphIOProcessor::audioInputNode),
+                  Graph::NodeID(inputNodeUid));
+    graph.addNode(std::make_unique<Graph::AudioGraphIOProcessor>(Graph::AudioGraphIOProcessor::audioOutputNode),
+                  Graph::NodeID(outputNodeUid));
+}
+
+void GraphSession::notifyChanged()
+{
+    if (onChanged != nullptr)
+        onChanged();
+}
+
+//==============================================================================
+const PluginNode *GraphSession::findNode(int nodeId) const noexcept
+{
+    for (const auto &n : nodes)
+        if (n.id == nodeId)
+            return &n;
+    return nullptr;
+}
+
+PluginNode *GraphSession::findNodeForEdit(int nodeId) noexcept
+{
+    return const_cast<PluginNode *>(findNode(nodeId));
+}
+
+const NodeWire *GraphSession::findWire(int fromNode, int toNode) const noexcept
+{
+    for (const auto &w : wires)
+        if (w.fromNode == fromNode && w.toNode == toNode)
+            return &w;
+    return nullptr;
+}
+
+NodeWire *GraphSession::findWireForEdit(int fromNode, int toNode) noexcept
+{
+    return const_cast<NodeWire *>(findWire(fromNode, toNode));
+}
+
+int GraphSession::getMaxWireChannels(const PluginNode &node) const
+{
+    if (node.type == NodeType::Plugin)
+        return maxPluginChannels;
+
+    auto *device = deviceManager != nullptr ? deviceManager->getCurrentAudioDevice() : nullptr;
+    if (device == nullptr)
+        return 2;
+    return node.type == NodeType::Input ? device->getInputChannelNames().size()
+                                        : device->getOutputChannelNames().size();
+}
+
+//==============================================================================
+std::pair<double, int> GraphSession::getPreparationSpec() const
+{
+    if (auto *device = deviceManager != nullptr ? deviceManager->getCurrentAudioDevice() : nullptr)
+        return {device->getCurrentSampleRate(), device->getCurrentBufferSizeSamples()};
+    return {preparationSampleRate, preparationBlockSize};
+}
+
+std::unique_ptr<juce::AudioPluginInstance> GraphSession::createPlugin(const juce::PluginDescription &description,
+                                                                      juce::String &errorMessage)
+{
+    const auto [sampleRate, blockSize] = getPreparationSpec();
+    auto instance = formatManager.createPluginInstance(description, sampleRate, blockSize, errorMessage);
+    if (instance != nullptr)
+        instance->prepareToPlay(sampleRate, blockSize);
+    return instance;
+}
+
+void GraphSession::watchParameters(Graph::Node &node)
+{
+    auto listener = std::make_unique<ParameterListener>(*this);
+    node.getProcessor()->addListener(listener.get());
+    parameterListeners[node.nodeID.uid] = std::move(listener);
+}
+
+void GraphSession::unwatchParameters(Graph::NodeID nodeId)
+{
+    const auto it = parameterListeners.find(nodeId.uid);
+    if (it == parameterListeners.end())
+        return;
+
+    // Render plans may keep the processor alive for a moment: it must not call a deleted listener
+    if (auto *node = graph.getNodeForId(nodeId))
+        node->getProcessor()->removeListener(it->second.get());
+    parameterListeners.erase(it);
+}
+
+//==============================================================================
+int GraphSession::addDeviceNode(const juce::String &name, NodeType type, juce::Point<int> pos)
+{
+    jassert(type != NodeType::Plugin);
+
+    PluginNode n;
+    n.id = nextId++;
+    n.type = type;
+    n.name = name;
+    n.pos = pos;
+    n.graphNodeId = Graph::NodeID(type == NodeType::Input ? inputNodeUid : outputNodeUid);
+
+    nodes.push_back(n);
+    notifyChanged();
+    return n.id;
+}
+
+int GraphSession::addPlugin(const juce::PluginDescription &description, juce::Point<int> pos, juce::String &errorMessage)
+{
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    // A recently removed instance of the same plugin comes back as it was, already prepared
+    auto nodePtr = instanceCache.take(description, std::nullopt);
+    if (nodePtr == nullptr)
+    {
+        auto instance = createPlugin(description, errorMessage);
+        if (instance == nullptr)
+            return -1;
+
+        nodePtr = graph.addNode(std::unique_ptr<juce::AudioProcessor>(std::move(instance)));
+        if (nodePtr == nullptr)
+            return -1;
+    }
+
+    return addPluginNode(*nodePtr, description.name, pos, juce::Time::getMillisecondCounterHiRes() - startMs);
+}
+
+int GraphSession::addPluginNode(Graph::Node &graphNode, const juce::String &name, juce::Point<int> pos, double loadMilliseconds)
+{
+    graphNode.setBypassed(false); // A cached instance may have been bypassed when it was removed
+
+    // Save when the plugin's parameters change
+    watchParameters(graphNode);
+
+    PluginNode n;
+    n.id = nextId++;
+    n.type = NodeType::Plugin;
+    n.name = name;
+    n.pos = pos;
+    n.graphNodeId = graphNode.nodeID;
+    n.loadMilliseconds = loadMilliseconds;
+
+    nodes.push_back(n);
+    notifyChanged();
+    return n.id;
+}
+
+int GraphSession::addPluginAsync(const juce::PluginDescription &description, juce::Point<int> pos, PluginLoadCallback onLoaded)
+{
+    // Cached: nothing to wait for
+    const auto cacheStartMs = juce::Time::getMillisecondCounterHiRes();
+    if (auto cached = instanceCache.take(description, std::nullopt))
+    {
+        const int nodeId = addPluginNode(*cached, description.name, pos, juce::Time::getMillisecondCounterHiRes() - cacheStartMs);
+        if (onLoaded != nullptr)
+            onLoaded(nodeId, {});
+        return nodeId;
+    }
+
+    PluginNode n;
+    n.id = nextId++;
+    n.type = NodeType::Plugin;
+    n.name = description.name;
+    n.pos = pos;
+    n.loading = true;
+
+    nodes.push_back(n);
+    loadingPlugins[n.id] = description;
+    notifyChanged();
+
+    // JUCE creates the instance on the message thread, but only once this call (and the menu or
+    // click that triggered it) has returned, so the placeholder is drawn first
+    const auto [sampleRate, blockSize] = getPreparationSpec();
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+    formatManager.createPluginInstanceAsync(
+        description, sampleRate, blockSize,
+        [session = juce::WeakReference<GraphSession>(this), nodeId = n.id, generation = loadGeneration, startMs,
+         onLoaded = std::move(onLoaded)](std::unique_ptr<juce::AudioPluginInstance> instance, const juce::String &error)
+        {
+            if (session == nullptr || session->loadGeneration != generation)
+                return; // Session gone or replaced: the instance is simply deleted
+
+            session->finishPluginLoad(nodeId, std::move(instance), error, juce::Time::getMillisecondCounterHiRes() - startMs,
+                                      onLoaded);
+        });
+    return n.id;
+}
+
+void GraphSession::finishPluginLoad(int nodeId, std::unique_ptr<juce::AudioPluginInstance> instance,
+                                    const juce::String &errorMessage, double loadMilliseconds, const PluginLoadCallback &onLoaded)
+{
+    auto *node = findNodeForEdit(nodeId);
+    if (node == nullptr || !node->loading)
+        return; // Placeholder deleted while loading
+
+    const auto name = node->name;
+    loadingPlugins.erase(nodeId);
+    node->loading = false;
+    node->loadMilliseconds = loadMilliseconds;
+    DBG("Loaded " << name << " in " << juce::String(loadMilliseconds, 1) << " ms");
+
+    if (instance == nullptr)
+    {
+        removeNode(nodeId);
+        if (onLoaded != nullptr)
+            onLoaded(nodeId, errorMessage.isNotEmpty() ? errorMessage : "cannot create " + name);
+        return;
+    }
+
+    // Prepared for the device as it is now: it may have changed while the plugin loaded
+    const auto [sampleRate, blockSize] = getPreparationSpec();
+    instance->prepareToPlay(sampleRate, blockSize);
+
+    // The node and every wire drawn to the placeholder go live in a single rebuild
+    GraphEditTransaction edit(graph);
+    auto nodePtr = edit.addNode(std::unique_ptr<juce::AudioProcessor>(std::move(instance)));
+    if (nodePtr != nullptr)
+    {
+        node->graphNodeId = nodePtr->nodeID;
+        nodePtr->setBypassed(node->bypassed);
+        watchParameters(*nodePtr);
+
+        for (auto &w : wires)
+            if (w.fromNode == nodeId || w.toNode == nodeId)
+                if (const auto *from = findNode(w.fromNode), *to = findNode(w.toNode); from != nullptr && to != nullptr)
+                    addGraphConnection(edit, *from, *to, w);
+    }
+    edit.commit();
+
+    notifyChanged();
+    if (onLoaded != nullptr)
+        onLoaded(nodeId, nodePtr != nullptr ? juce::String() : "cannot add " + name + " to the graph");
+}
+
+void GraphSession::removeNode(int nodeId)
+{
+    const auto *node = findNode(nodeId);
+    if (node == nullptr)
+        return;
+
+    // A loaded plugin can be brought back: remember the node, its wires and its state
+    std::optional<RemovedNode> removed;
+    if (auto graphNode = node->type == NodeType::Plugin ? graph.getNodeForId(node->graphNodeId) : nullptr)
+        if (auto *instance = dynamic_cast<juce::AudioPluginInstance *>(graphNode->getProcessor()))
+        {
+            removed.emplace();
+            removed->node = *node;
+            instance->fillInPluginDescription(removed->description);
+            instance->getStateInformation(removed->state);
+            for (const auto &w : wires)
+                if (w.fromNode == nodeId || w.toNode == nodeId)
+                    removed->wires.push_back(w);
+        }
+
+    // One rebuild for the node and all of its wires
+    GraphEditTransaction edit(graph);
+    for (auto &w : wires)
+        if (w.fromNode == nodeId || w.toNode == nodeId)
+            if (const auto *from = findNode(w.fromNode), *to = findNode(w.toNode); from != nullptr && to != nullptr)
+                removeGraphConnection(edit, *from, *to, w);
+
+    // Input / Output nodes only map the fixed graph I/O nodes, which stay in the graph
+    if (node->type == NodeType::Plugin && node->graphNodeId.uid != 0)
+    {
+        unwatchParameters(node->graphNodeId);
+
+        // Disconnected, the plugin waits in the cache, still prepared, for a re-add or an undo
+        if (!removed.has_value() || !instanceCache.park(node->graphNodeId, removed->description, removed->state))
+            edit.removeNode(node->graphNodeId);
+    }
+    edit.commit();
+
+    if (removed.has_value())
+    {
+        removedNodes.push_back(std::move(*removed));
+        if (removedNodes.size() > maxUndoSteps)
+            removedNodes.erase(removedNodes.begin());
+    }
+
+    wires.erase(std::remove_if(wires.begin(), wires.end(), [nodeId](const NodeWire &w)
+                               { return w.fromNode == nodeId || w.toNode == nodeId; }),
+                wires.end());
+    nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [nodeId](const PluginNode &n)
+                               { return n.id == nodeId; }),
+                nodes.end());
+    loadingPlugins.erase(nodeId);
+    notifyChanged();
+}
+
+int GraphSession::undoRemoveNode(juce::String &errorMessage)
+{
+    if (removedNodes.empty())
+        return -1;
+
+    auto removed = std::move(removedNodes.back());
+    removedNodes.pop_back();
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    GraphEditTransaction edit(graph);
+
+    // Still cached with the same state: instant. Evicted: created again from its saved state
+    auto nodePtr = instanceCache.take(removed.description, PluginInstanceCache::hashState(removed.state));
+    if (nodePtr == nullptr)
+    {
+        auto instance = createPlugin(removed.description, errorMessage);
+        if (instance == nullptr)
+            return -1;
+        if (removed.state.getSize() > 0)
+            instance->setStateInformation(removed.state.getData(), (int)removed.state.getSize());
+
+        nodePtr = edit.addNode(std::unique_ptr<juce::AudioProcessor>(std::move(instance)));
+        if (nodePtr == nullptr)
+            return -1;
+    }
+
+    auto n = removed.node;
+    n.graphNodeId = nodePtr->nodeID;
+    n.loadMilliseconds = juce::Time::getMillisecondCounterHiRes() - startMs;
+    nodePtr->setBypassed(n.bypassed);
+    watchParameters(*nodePtr);
+    nodes.push_back(n);
+
+    // Wires to nodes that were removed since stay gone
+    for (auto &w : removed.wires)
+    {
+        const auto *from = findNode(w.fromNode);
+        const auto *to = findNode(w.toNode);
+        if (from == nullptr || to == nullptr || findWire(w.fromNode, w.toNode) != nullptr)
+            continue;
+
+        addGraphConnection(edit, *from, *to, w);
+        wires.push_back(w);
+    }
+    edit.commit();
+
+    notifyChanged();
+    return n.id;
+}
+
+void GraphSession::disconnectNode(int nodeId)
+{
+    GraphEditTransaction edit(graph);
+    for (auto it = wires.begin(); it != wires.end();)
+    {
+        if (it->fromNode != nodeId && it->toNode != nodeId)
+        {
+            ++it;
+            continue;
+        }
+
+        const auto *from = findNode(it->fromNode);
+        const auto *to = findNode(it->toNode);
+        if (from != nullptr && to != nullptr)
+            removeGraphConnection(edit, *from, *to, *it);
+        it = wires.erase(it);
+    }
+    edit.commit();
+    notifyChanged();
+}
+
+void GraphSession::setNodePosition(int nodeId, juce::Point<int> pos)
+{
+    auto *node = findNodeForEdit(nodeId);
+    if (node == nullptr || node->pos == pos)
+        return;
+
+    node->pos = pos;
+    notifyChanged();
+}
+
+void GraphSession::setNodeBypassed(int nodeId, bool shouldBeBypassed)
+{
+    auto *node = findNodeForEdit(nodeId);
+    if (node == nullptr || node->type != NodeType::Plugin || node->bypassed == shouldBeBypassed)
+        return;
+
+    // The renderer reads the node's flag every block: no graph edit, no rebuild
+    if (auto *graphNode = graph.getNodeForId(node->graphNodeId))
+        graphNode->setBypassed(shouldBeBypassed);
+
+    node->bypassed = shouldBeBypassed;
+    notifyChanged();
+}
+
+//==============================================================================
+bool GraphSession::canConnect(int fromNode, int toNode) const
+{
+    if (fromNode == toNode)
+        return false;
+
+    const auto *from = findNode(fromNode);
+    const auto *to = findNode(toNode);
+    if (from == nullptr || to == nullptr)
+        return false;
+    if (!from->hasOutputPort() || !to->hasInputPort())
+        return false;
+    if (from->type == to->type && from->type != NodeType::Plugin)
+        return false;
+    return findWire(fromNode, toNode) == nullptr;
+}
+
+bool GraphSession::addWire(int fromNode, int toNode)
+{
+    if (!canConnect(fromNode, toNode))
+        return false;
+
+    const auto *from = findNode(fromNode);
+    const auto *to = findNode(toNode);
+    DBG("Wire connection: " << from->name << " -> " << to->name);
+
+    // Fan-in is allowed: the graph sums every wire into the port
+    NodeWire w{fromNode, toNode};
+    GraphEditTransaction edit(graph);
+    addGraphConnection(edit, *from, *to, w);
+    edit.commit();
+
+    wires.push_back(w);
+    notifyChanged();
+    return true;
+}
+
+void GraphSession::removeWire(int fromNode, int toNode)
+{
+    auto *wire = findWireForEdit(fromNode, toNode);
+    if (wire == nullptr)
+        return;
+
+    const auto *from = findNode(fromNode);
+    const auto *to = findNode(toNode);
+
+    GraphEditTransaction edit(graph);
+    if (from != nullptr && to != nullptr)
+        removeGraphConnection(edit, *from, *to, *wire);
+    edit.commit();
+
+    wires.erase(wires.begin() + (wire - wires.data()));
+    notifyChanged();
+}
+
+void GraphSession::setWireChannels(int fromNode, int toNode, const WireChannelMap &channels)
+{
+    auto *wire = findWireForEdit(fromNode, toNode);
+    const auto *from = findNode(fromNode);
+    const auto *to = findNode(toNode);
+    if (wire == nullptr || wire->channels == channels || from == nullptr || to == nullptr)
+        return;
+
+    // Swap the old routes for the new ones in a single rebuild
+    GraphEditTransaction edit(graph);
+    removeGraphConnection(edit, *from, *to, *wire);
+    wire->channels = channels;
+    addGraphConnection(edit, *from, *to, *wire);
+    edit.commit();
+
+    notifyChanged();
+}
+
+void GraphSession::setWireGain(int fromNode, int toNode, float gainDecibels)
+{
+    auto *wire = findWireForEdit(fromNode, toNode);
+    if (wire == nullptr || wire->gainDecibels == gainDecibels)
+        return;
+
+    const bool wasUnity = wire->gainDecibels == 0.f;
+    wire->gainDecibels = gainDecibels;
+
+    // The render plans ramp to the new value on their own: no graph edit, no rebuild
+    const auto *from = findNode(fromNode);
+    const auto *to = findNode(toNode);
+    if (from != nullptr && to != nullptr)
+        applyWireGain(*from, *to, *wire);
+
+    // Only whether a wire is unity matters to the topology (the pass-through fast path)
+    if (wasUnity != (gainDecibels == 0.f))
+        graph.sendChangeMessage();
+
+    notifyChanged();
+}
+
+//==============================================================================
+void GraphSession::addGraphConnection(GraphEditTransaction &edit, const PluginNode &from, const PluginNode &to, const NodeWire &wire)
+{
+    // Verify that nodes exist in the graph
+    if (graph.getNodeForId(from.graphNodeId) == nullptr)
+    {
+        DBG("WARNING: Source node " << from.graphNodeId.uid << " not found in graph!");
+        return;
+    }
+    if (graph.getNodeForId(to.graphNodeId) == nullptr)
+    {
+        DBG("WARNING: Target node " << to.graphNodeId.uid << " not found in graph!");
+        return;
+    }
+
+    const auto &channels = wire.channels;
+    DBG("Adding connection from " << from.graphNodeId.uid << " to " << to.graphNodeId.uid << " [" << channels.describe() << "]");
+
+    // Both ends must expose the mapped channels before the connections are legal
+    const int numSources = channels.getNumSourceChannels();
+    const int numDestinations = channels.getNumDestinationChannels();
+    if (from.type == NodeType::Input || to.type == NodeType::Output)
+        widenDeviceChannels(from.type == NodeType::Input ? numSources : 0,
+                            to.type == NodeType::Output ? numDestinations : 0);
+    if (from.type == NodeType::Plugin)
+        widenPluginChannels(edit, from, 0, numSources);
+    if (to.type == NodeType::Plugin)
+        widenPluginChannels(edit, to, numDestinations, 0);
+
+    for (const auto &route : channels.routes)
+    {
+        if (!edit.addConnection({{from.graphNodeId, route.source}, {to.graphNodeId, route.destination}}))
+        {
+            DBG("WARNING: Failed to add connection (channel " << route.source << " -> " << route.destination << ")");
+        }
+    }
+
+    // Every connection gets its gain cell now, even at unity, so later changes reach the running plan
+    applyWireGain(from, to, wire);
+}
+
+void GraphSession::removeGraphConnection(GraphEditTransaction &edit, const PluginNode &from, const PluginNode &to, const NodeWire &wire)
+{
+    for (const auto &route : wire.channels.routes)
+    {
+        const Graph::Connection connection{{from.graphNodeId, route.source}, {to.graphNodeId, route.destination}};
+        edit.removeConnection(connection);
+        GraphRenderPlan::removeWireGain(graph, connection);
+    }
+}
+
+void GraphSession::applyWireGain(const PluginNode &from, const PluginNode &to, const NodeWire &wire)
+{
+    // Applied as each connection is summed into its destination: no gain node, no extra buffer
+    const float gain = juce::Decibels::decibelsToGain(wire.gainDecibels, NodeWire::minusInfinityDb);
+    for (const auto &route : wire.channels.routes)
+        GraphRenderPlan::setWireGain(graph, {{from.graphNodeId, route.source}, {to.graphNodeId, route.destination}}, gain);
+}
+
+void GraphSession::widenPluginChannels(GraphEditTransaction &edit, const PluginNode &node, int numInputs, int numOutputs)
+{
+    auto graphNode = graph.getNodeForId(node.graphNodeId);
+    if (graphNode == nullptr)
+        return;
+
+    auto *proc = graphNode->getProcessor();
+    if (proc->getTotalNumInputChannels() >= numInputs && proc->getTotalNumOutputChannels() >= numOutputs)
+        return;
+
+    // Widen input and output together: most effects only accept matching main bus layouts
+    const int width = juce::jmax(numInputs, numOutputs, proc->getMainBusNumInputChannels(), proc->getMainBusNumOutputChannels());
+    auto layout = proc->getBusesLayout();
+    for (const auto &set : {juce::AudioChannelSet::canonicalChannelSet(width), juce::AudioChannelSet::discreteChannels(width)})
+    {
+        if (!layout.inputBuses.isEmpty())
+            layout.inputBuses.getReference(0) = set;
+        if (!layout.outputBuses.isEmpty())
+            layout.outputBuses.getReference(0) = set;
+        if (edit.setBusesLayout(node.graphNodeId, layout))
+        {
+            DBG("Widened " << node.name << " to " << set.getDescription());
+            return;
+        }
+    }
+    DBG("WARNING: " << node.name << " does not support " << width << " channels");
+}
+
+void GraphSession::widenDeviceChannels(int numInputs, int numOutputs)
+{
+    const int currentInputs = graph.getTotalNumInputChannels();
+    const int currentOutputs = graph.getTotalNumOutputChannels();
+    if (currentInputs >= numInputs && currentOutputs >= numOutputs)
+        return;
+
+    if (deviceManager == nullptr || deviceManager->getCurrentAudioDevice() == nullptr)
+    {
+        // Not playing yet (CLI, offline render, no device): widen the graph itself so the wires can
+        // connect; whoever prepares the graph later sets its real channel counts
+        graph.setPlayConfigDetails(juce::jmax(numInputs, currentInputs), juce::jmax(numOutputs, currentOutputs),
+                                   preparationSampleRate, preparationBlockSize);
+        for (const auto uid : {inputNodeUid, outputNodeUid})
+            if (auto *node = graph.getNodeForId(Graph::NodeID(uid)))
+                if (auto *io = dynamic_cast<Graph::AudioGraphIOProcessor *>(node->getProcessor()))
+                    io->setParentGraph(&graph); // Picks up the graph's new channel counts
+        return;
+    }
+
+    // Same contiguous range LightHostEngine keeps, so graph channel indices stay device channel indices
+    auto setup = deviceManager->getAudioDeviceSetup();
+    setup.useDefaultInputChannels = false;
+    setup.useDefaultOutputChannels = false;
+    setup.inputChannels.clear();
+    setup.outputChannels.clear();
+    setup.inputChannels.setRange(0, juce::jmax(numInputs, currentInputs), true);
+    setup.outputChannels.setRange(0, juce::jmax(numOutputs, currentOutputs), true);
+
+    // Reopens the device; the player re-prepares the graph with the wider I/O nodes
+    const auto error = deviceManager->setAudioDeviceSetup(setup, true);
+    if (error.isNotEmpty())
+    {
+        DBG("WARNING: Failed to open more device channels: " << error);
+    }
+}
+
+//==============================================================================
+std::unique_ptr<juce::XmlElement> GraphSession::saveState() const
+{
+    auto xml = std::make_unique<juce::XmlElement>("NodeGraph");
+    auto *xNodes = xml->createNewChildElement("Nodes");
+
+    for (const auto &n : nodes)
+    {
+        auto *xn = xNodes->createNewChildElement("Node");
+        xn->setAttribute("id", n.id);
+        xn->setAttribute("type", static_cast<int>(n.type));
+        xn->setAttribute("name", n.name);
+        xn->setAttribute("x", n.pos.x);
+        xn->setAttribute("y", n.pos.y);
+
+        if (n.type != NodeType::Plugin)
+            continue;
+
+        if (n.bypassed)
+            xn->setAttribute("bypassed", true);
+
+        if (auto *gNode = graph.getNodeForId(n.graphNodeId))
+        {
+            auto *proc = gNode->getProcessor();
+
+            juce::PluginDescription desc;
+            if (auto *pi = dynamic_cast<juce::AudioPluginInstance *>(proc))
+                pi->fillInPluginDescription(desc);
+            xn->setAttribute("pluginName", desc.name);
+            xn->setAttribute("pluginFormat", desc.pluginFormatName);
+            xn->setAttribute("pluginFileOrIdentifier", desc.fileOrIdentifier);
+
+            juce::MemoryBlock mb;
+            proc->getStateInformation(mb);
+            xn->createNewChildElement("PluginState")->addTextElement(mb.toBase64Encoding());
+        }
+        else if (const auto loading = loadingPlugins.find(n.id); loading != loadingPlugins.end())
+        {
+            // Still loading: keep the plugin in the session, with its default state
+            xn->setAttribute("pluginName", loading->second.name);
+            xn->setAttribute("pluginFormat", loading->second.pluginFormatName);
+            xn->setAttribute("pluginFileOrIdentifier", loading->second.fileOrIdentifier);
+        }
+    }
+
+    auto *xWires = xml->createNewChildElement("Wires");
+    for (const auto &w : wires)
+    {
+        auto *xw = xWires->createNewChildElement("Wire");
+        xw->setAttribute("from", w.fromNode);
+        xw->setAttribute("to", w.toNode);
+        xw->setAttribute("channels", w.channels.toString());
+        xw->setAttribute("gainDb", w.gainDecibels);
+    }
+
+    return xml;
+}
+
+void GraphSession::loadState(const juce::XmlElement &xml)
+{
+    resetGraph();
+    lastRestore = {};
+
+    const auto *xNodes = xml.getChildByName("Nodes");
+    if (xNodes == nullptr)
+        return;
+
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    // One entry per plugin node, in session order
+    std::vector<PluginRestore> restores;
+    restores.reserve((size_t)xNodes->getNumChildElements());
+
+    for (auto *xn : xNodes->getChildIterator())
+    {
+        PluginNode n;
+        n.id = xn->getIntAttribute("id");
+        n.type = static_cast<NodeType>(xn->getIntAttribute("type"));
+        n.name = xn->getStringAttribute("name");
+        n.pos = {xn->getIntAttribute("x"), xn->getIntAttribute("y")};
+        n.bypassed = xn->getBoolAttribute("bypassed", false);
+
+        nextId = juce::jmax(nextId, n.id + 1);
+
+        if (n.type == NodeType::Input)
+            n.graphNodeId = Graph::NodeID(inputNodeUid);
+        else if (n.type == NodeType::Output)
+            n.graphNodeId = Graph::NodeID(outputNodeUid);
+        else if (n.type == NodeType::Plugin)
+        {
+            // Prefer the full description from the scanned plugin list
+            PluginRestore restore;
+            restore.nodeIndex = nodes.size();
+            restore.description.fileOrIdentifier = xn->getStringAttribute("pluginFileOrIdentifier");
+            restore.description.name = xn->getStringAttribute("pluginName");
+            restore.description.pluginFormatName = xn->getStringAttribute("pluginFormat");
+            for (const auto &d : knownPlugins.getTypes())
+                if (d.fileOrIdentifier == restore.description.fileOrIdentifier)
+                {
+                    restore.description = d;
+                    break;
+                }
+
+            if (const auto *xState = xn->getChildByName("PluginState"))
+                restore.state.fromBase64Encoding(xState->getAllSubText());
+            restores.push_back(std::move(restore));
+        }
+        nodes.push_back(n);
+    }
+
+    restorePlugins(restores);
+
+    // Every restored node and wire lands in one transaction: a single rebuild at the end
+    GraphEditTransaction edit(graph);
+
+    for (auto &restore : restores)
+    {
+        auto &n = nodes[restore.nodeIndex];
+        lastRestore.sequentialMilliseconds += restore.workMilliseconds;
+        if (restore.instance == nullptr)
+        {
+            DBG("FAILED to create plugin instance: " << restore.description.name << " Error: " << restore.error);
+            continue;
+        }
+
+        n.loadMilliseconds = restore.workMilliseconds;
+        if (auto nodePtr = edit.addNode(std::unique_ptr<juce::AudioProcessor>(std::move(restore.instance))))
+        {
+            n.graphNodeId = nodePtr->nodeID;
+            nodePtr->setBypassed(n.bypassed);
+            watchParameters(*nodePtr);
+            ++lastRestore.numPlugins;
+            DBG("Successfully added plugin node: " << n.name << " ID: " << n.graphNodeId.uid);
+        }
+        else
+        {
+            DBG("FAILED to add plugin node to graph: " << n.name);
+        }
+    }
+
+    if (const auto *xWires = xml.getChildByName("Wires"))
+    {
+        for (auto *xw : xWires->getChildIterator())
+        {
+            NodeWire w;
+            w.fromNode = xw->getIntAttribute("from");
+            w.toNode = xw->getIntAttribute("to");
+            w.channels = WireChannelMap::fromString(xw->getStringAttribute("channels")); // Older sessions: stereo
+            w.gainDecibels = (float)xw->getDoubleAttribute("gainDb", 0.0);
+
+            const auto *from = findNode(w.fromNode);
+            const auto *to = findNode(w.toNode);
+            if (from != nullptr && to != nullptr && from->graphNodeId.uid != 0 && to->graphNodeId.uid != 0)
+            {
+                DBG("Restoring wire: " << from->name << " -> " << to->name);
+                addGraphConnection(edit, *from, *to, w);
+            }
+            wires.push_back(w);
+        }
+    }
+
+    edit.commit();
+
+    lastRestore.wallMilliseconds = juce::Time::getMillisecondCounterHiRes() - startMs;
+    DBG("Restored " << lastRestore.numPlugins << " plugins in " << juce::String(lastRestore.wallMilliseconds, 1) << " ms on "
+                    << lastRestore.numWorkers << " workers (" << juce::String(lastRestore.sequentialMilliseconds, 1)
+                    << " ms of plugin work)");
+}
+
+//==============================================================================
+int GraphSession::getNumRestoreWorkers() const
+{
+    return restoreWorkers >= 0 ? restoreWorkers : juce::jlimit(1, maxRestoreWorkers, juce::SystemStats::getNumCpus() - 1);
+}
+
+void GraphSession::restorePlugin(PluginRestore &restore, double sampleRate, int blockSize)
+{
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+    restore.instance->prepareToPlay(sampleRate, blockSize);
+    if (restore.state.getSize() > 0)
+        restore.instance->setStateInformation(restore.state.getData(), (int)restore.state.getSize());
+    restore.workMilliseconds += juce::Time::getMillisecondCounterHiRes() - startMs;
+}
+
+void GraphSession::restorePlugins(std::vector<PluginRestore> &restores)
+{
+    const auto [sampleRate, blockSize] = getPreparationSpec();
+    const int numWorkers = juce::jmin(getNumRestoreWorkers(), (int)restores.size());
+    lastRestore.numWorkers = numWorkers;
+
+    // Instances are always created here: JUCE creates plugins on the message thread whichever thread
+    // asks. Restoring their state and preparing them (often the slow part: sample libraries, impulse
+    // responses) overlaps with creating the next one.
+    // One count per queued job plus one held by this loop, so an early finisher cannot signal
+    // before the last job is queued. Declared before the pool, which joins its threads first.
+    std::atomic<int> pendingJobs{1};
+    juce::WaitableEvent jobsDone;
+
+    std::unique_ptr<juce::ThreadPool> pool;
+    if (numWorkers > 0)
+        pool = std::make_unique<juce::ThreadPool>(numWorkers);
+
+    for (auto &restore : restores)
+    {
+        DBG("Restoring plugin: " << restore.description.name << " [" << restore.description.pluginFormatName << "]");
+        const auto startMs = juce::Time::getMillisecondCounterHiRes();
+        restore.instance = formatManager.createPluginInstance(restore.description, sampleRate, blockSize, restore.error);
+        restore.workMilliseconds = juce::Time::getMillisecondCounterHiRes() - startMs;
+        if (restore.instance == nullptr)
+            continue;
+
+        if (pool == nullptr || PluginInstanceCache::needsMessageThread(restore.description))
+            restorePlugin(restore, sampleRate, blockSize);
+        else
+        {
+            ++pendingJobs;
+            pool->addJob([&restore, &pendingJobs, &jobsDone, sampleRate = sampleRate, blockSize = blockSize]
+                         {
+                             restorePlugin(restore, sampleRate, blockSize);
+                             if (--pendingJobs == 0)
+                                 jobsDone.signal();
+                         });
+        }
+    }
+
+    // Block without dispatching messages: nodes is half-built until loadState() finishes, and the
+    // formats that need the message thread were restored inline above
+    if (--pendingJobs > 0)
+        jobsDone.wait();
+}
@@ -0,0 +1,307 @@
+/*
+ * GraphSession.h
+ * LightHost - 工作階段模型（節點、連線）與 AudioProcessorGraph 的同步
+ *
+ * 功能說明：
+ * - 保存使用者編輯的節點（Input / Output / 外掛）與連線，並把每次編輯套用到圖形
+ * - 連線的通道對應與增益、外掛與設備通道的擴充都在這裡處理
+ * - saveState() / loadState() 讀寫 nodeGraphState XML（與托盤程式儲存的格式相同）
+ * - addPluginAsync() 先加入「載入中」的佔位節點，外掛實例就緒後才一次加入圖形並接上連線；
+ *   每個外掛記錄載入時間
+ * - 刪除的外掛暫存在 PluginInstanceCache（仍已準備好）：從清單重新加入同一外掛或復原刪除時立即取回
+ * - loadState() 在訊息執行緒依序建立外掛實例，同時以有限的工作執行緒池還原狀態與準備
+ *   （需要訊息執行緒的格式除外）；全部就緒後才接上連線
+ * - 不依賴任何視窗元件：NodeGraphCanvas 只負責繪製與把滑鼠操作轉成本類別的呼叫，
+ *   LightHostCli 不經過任何介面直接載入工作階段
+ *
+ * 執行緒：
+ * - 與 AudioProcessorGraph 的編輯方法相同，只能在訊息執行緒使用
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+#include "GraphEditTransaction.h"
+#include "PluginInstanceCache.h"
+#include "WireChannelMap.h"
+
+#include <functional>
+#include <utility>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+//==============================================================================
+enum class NodeType { Input, Output, Plugin };
+
+/** A session node. graphNodeId links it to the AudioProcessorGraph. */
+struct PluginNode
+{
+    int              id   { 0 };
+    NodeType         type { NodeType::Plugin };
+    juce::String     name;
+    juce::Point<int> pos  { 200, 100 }; // Canvas position, saved with the session
+
+    /** Corresponding AudioProcessorGraph NodeID (0 = not in graph yet). */
+    juce::AudioProcessorGraph::NodeID graphNodeId { 0 };
+
+    /** Plugin skipped by the renderer; its dry signal keeps the plugin's latency. */
+    bool bypassed { false };
+
+    /** Placeholder while addPluginAsync() creates the instance; wires wait for it. */
+    bool loading { false };
+
+    /** Time from the load request until the instance was ready (0 = not loaded). */
+    double loadMilliseconds { 0.0 };
+
+    bool hasInputPort()  const { return type != NodeType::Input;  }
+    bool hasOutputPort() const { return type != NodeType::Output; }
+};
+
+/** A wire; channels maps the source node's channels onto the destination's. */
+struct NodeWire
+{
+    int            fromNode { -1 };
+    int            toNode   { -1 };
+    WireChannelMap channels { WireChannelMap::stereo() };
+    float          gainDecibels { 0.f };
+
+    /** Gains at or below this are silence. */
+    static constexpr float minusInfinityDb = -100.0f;
+};
+
+//==============================================================================
+class GraphSession
+{
+public:
+    using Graph = juce::AudioProcessorGraph;
+
+    /** 圖形固定的 Input / Output 節點 ID */
+    static constexpr juce::uint32 inputNodeUid  = 1000000;
+    static constexpr juce::uint32 outputNodeUid = 1000001;
+
+    /**
+     * 建構子
+     *
+     * @param graph         要同步的圖形
+     * @param formatManager 建立外掛實例
+     * @param knownPlugins  載入工作階段時查詢完整的外掛描述
+     * @param deviceManager 連線需要更多設備通道時重新開啟設備；無設備（例如 CLI 的 null 設備）時為 nullptr
+     */
+    GraphSession(Graph &graph, juce::AudioPluginFormatManager &formatManager, juce::KnownPluginList &knownPlugins,
+                 juce::AudioDeviceManager *deviceManager = nullptr);
+    ~GraphSession();
+
+    [[nodiscard]] Graph &getGraph() noexcept { return graph; }
+    [[nodiscard]] juce::KnownPluginList &getKnownPlugins() noexcept { return knownPlugins; }
+
+    /** 刪除的外掛實例快取；預設停用，以 setLimits() 啟用 */
+    [[nodiscard]] PluginInstanceCache &getInstanceCache() noexcept { return instanceCache; }
+
+    /** 任何編輯（包括外掛參數變更）後呼叫，供儲存工作階段；loadState() 不呼叫 */
+    std::function<void()> onChanged;
+
+    /**
+     * setPreparationSpec() 方法
+     * 沒有開啟的設備時，新外掛以此採樣率與區塊大小準備（預設 44100 Hz / 512）
+     */
+    void setPreparationSpec(double sampleRate, int blockSize) noexcept;
+
+    /** 清空工作階段與圖形，重新建立固定的 Input / Output 節點 */
+    void resetGraph();
+
+    /**
+     * setRestoreWorkers() 方法
+     * loadState() 還原外掛狀態的工作執行緒數；0 = 全部在訊息執行緒依序還原（比較用的基準），
+     * -1（預設）= CPU 核心數 - 1，最多 8
+     */
+    void setRestoreWorkers(int numWorkers) noexcept { restoreWorkers = numWorkers; }
+
+    /** 上一次 loadState() 的耗時 */
+    struct RestoreReport
+    {
+        int numPlugins = 0;                 // 成功還原的外掛數
+        int numWorkers = 0;                 // 實際使用的工作執行緒數
+        double wallMilliseconds = 0.0;      // loadState() 的總耗時
+        double sequentialMilliseconds = 0.0; // 每個外掛建立、準備與還原狀態的耗時總和（依序還原的估計）
+
+        [[nodiscard]] double getSpeedup() const noexcept { return wallMilliseconds > 0.0 ? sequentialMilliseconds / wallMilliseconds : 0.0; }
+    };
+
+    [[nodiscard]] const RestoreReport &getLastRestoreReport() const noexcept { return lastRestore; }
+
+    //==============================================================================
+    [[nodiscard]] const std::vector<PluginNode> &getNodes() const noexcept { return nodes; }
+    [[nodiscard]] const std::vector<NodeWire> &getWires() const noexcept { return wires; }
+    [[nodiscard]] const PluginNode *findNode(int nodeId) const noexcept;
+    [[nodiscard]] const NodeWire *findWire(int fromNode, int toNode) const noexcept;
+
+    /** 連線一端最多可對應的通道數：設備的通道數，外掛為 8 */
+    [[nodiscard]] int getMaxWireChannels(const PluginNode &node) const;
+
+    //==============================================================================
+    /** 加入 Input 或 Output 節點（對應固定的圖形節點）；回傳節點 id */
+    int addDeviceNode(const juce::String &name, NodeType type, juce::Point<int> pos);
+
+    /**
+     * addPlugin() 方法
+     * 建立並準備外掛實例，加入圖形
+     *
+     * @param description  外掛描述
+     * @param pos          畫布位置
+     * @param errorMessage 失敗時的錯誤訊息
+     * @return 節點 id；失敗時為 -1
+     */
+    int addPlugin(const juce::PluginDescription &description, juce::Point<int> pos, juce::String &errorMessage);
+
+    /** addPluginAsync() 完成時呼叫（訊息執行緒；從快取取回時在返回前呼叫）；失敗時 errorMessage 不為空，佔位節點已移除 */
+    using PluginLoadCallback = std::function<void(int nodeId, const juce::String &errorMessage)>;
+
+    /**
+     * addPluginAsync() 方法
+     * 立即加入「載入中」的佔位節點（可以移動、連線、刪除），再以 createPluginInstanceAsync 建立實例；
+     * 實例就緒後在一次重建中加入圖形並接上期間建立的連線。佔位節點在完成前被刪除或工作階段被重設時，
+     * 實例直接丟棄、不呼叫 onLoaded
+     *
+     * @return 佔位節點的 id
+     */
+    int addPluginAsync(const juce::PluginDescription &description, juce::Point<int> pos, PluginLoadCallback onLoaded);
+
+    /** 移除節點與它的連線（一次重建）；已載入的外掛可以復原，快取啟用時實例暫存在快取 */
+    void removeNode(int nodeId);
+
+    /** 是否有可以復原的刪除 */
+    [[nodiscard]] bool canUndoRemoveNode() const noexcept { return !removedNodes.empty(); }
+
+    /**
+     * undoRemoveNode() 方法
+     * 復原最近一次刪除的外掛：相同的節點 id、位置、旁通、狀態與仍然存在的連線（一次重建）
+     * 實例仍在快取時直接取回；已被逐出時以刪除時的狀態重新建立
+     *
+     * @param errorMessage 重新建立失敗時的錯誤訊息
+     * @return 節點 id；沒有可以復原的刪除或失敗時為 -1
+     */
+    int undoRemoveNode(juce::String &errorMessage);
+
+    /** 移除節點的所有連線（一次重建） */
+    void disconnectNode(int nodeId);
+
+    void setNodePosition(int nodeId, juce::Point<int> pos);
+
+    /** 旁路或恢復外掛；渲染器每個區塊讀取旗標，不重建 */
+    void setNodeBypassed(int nodeId, bool shouldBeBypassed);
+
+    //==============================================================================
+    /** fromNode -> toNode 是否為合法的新連線（方向正確且尚未存在） */
+    [[nodiscard]] bool canConnect(int fromNode, int toNode) const;
+
+    /** 以立體聲、單位增益連接；允許多條連線匯入同一個埠（圖形會相加） */
+    bool addWire(int fromNode, int toNode);
+
+    void removeWire(int fromNode, int toNode);
+
+    /** 以新的通道對應重新連接（一次重建） */
+    void setWireChannels(int fromNode, int toNode, const WireChannelMap &channels);
+
+    /** 變更連線增益；渲染計畫在累加連線時套用並平滑過渡，不插入節點也不重建 */
+    void setWireGain(int fromNode, int toNode, float gainDecibels);
+
+    //==============================================================================
+    /** 以 nodeGraphState 格式儲存（包含每個外掛的狀態） */
+    [[nodiscard]] std::unique_ptr<juce::XmlElement> saveState() const;
+
+    /**
+     * loadState() 方法
+     * 取代目前的工作階段：重設圖形、還原所有外掛與連線（一次重建）
+     * 無法建立的外掛保留為沒有圖形節點的節點（graphNodeId 為 0），連線也一併保留
+     */
+    void loadState(const juce::XmlElement &xml);
+
+private:
+    class ParameterListener;
+
+    /** loadState() 中的一個外掛 */
+    struct PluginRestore
+    {
+        size_t nodeIndex = 0;
+        juce::PluginDescription description;
+        juce::MemoryBlock state;
+        std::unique_ptr<juce::AudioPluginInstance> instance;
+        juce::String error;
+        double workMilliseconds = 0.0; // Create + prepare + restore state
+    };
+
+    /** 可以復原的刪除 */
+    struct RemovedNode
+    {
+        PluginNode node;
+        std::vector<NodeWire> wires;
+        juce::PluginDescription description;
+        juce::MemoryBlock state;
+    };
+
+    PluginNode *findNodeForEdit(int nodeId) noexcept;
+    NodeWire *findWireForEdit(int fromNode, int toNode) noexcept;
+
+    /** 設備的採樣率與區塊大小；沒有開啟的設備時為 setPreparationSpec() 的設定 */
+    [[nodiscard]] std::pair<double, int> getPreparationSpec() const;
+
+    /** 建立並準備外掛實例 */
+    std::unique_ptr<juce::AudioPluginInstance> createPlugin(const juce::PluginDescription &description, juce::String &errorMessage);
+
+    /** 為已在圖形中的外掛節點建立工作階段節點 */
+    int addPluginNode(Graph::Node &graphNode, const juce::String &name, juce::Point<int> pos, double loadMilliseconds);
+
+    /** 建立所有外掛實例（訊息執行緒），準備並還原狀態（工作執行緒池或訊息執行緒） */
+    void restorePlugins(std::vector<PluginRestore> &restores);
+    static void restorePlugin(PluginRestore &restore, double sampleRate, int blockSize);
+    [[nodiscard]] int getNumRestoreWorkers() const;
+
+    /** addPluginAsync() 的實例就緒：加入圖形、接上佔位節點的連線 */
+    void finishPluginLoad(int nodeId, std::unique_ptr<juce::AudioPluginInstance> instance, const juce::String &errorMessage,
+                          double loadMilliseconds, const PluginLoadCallback &onLoaded);
+
+    /** 外掛參數變更時呼叫 onChanged */
+    void watchParameters(Graph::Node &node);
+    void unwatchParameters(Graph::NodeID nodeId);
+    void notifyChanged();
+
+    /** Connect a wire in the graph: one connection per mapped channel, each carrying the wire's gain. */
+    void addGraphConnection(GraphEditTransaction &edit, const PluginNode &from, const PluginNode &to, const NodeWire &wire);
+    /** Disconnect a wire in the graph, dropping its connections' gains. */
+    void removeGraphConnection(GraphEditTransaction &edit, const PluginNode &from, const PluginNode &to, const NodeWire &wire);
+    /** Hand the wire's gain to the render plans (GraphRenderPlan::setWireGain), one per connection. */
+    void applyWireGain(const PluginNode &from, const PluginNode &to, const NodeWire &wire);
+    /** Widen a plugin's main buses so it has at least numInputs / numOutputs channels. */
+    void widenPluginChannels(GraphEditTransaction &edit, const PluginNode &node, int numInputs, int numOutputs);
+    /** Open more device channels when a wire maps beyond the graph's current I/O channels
+        (without an open device, widen the graph's I/O nodes directly). */
+    void widenDeviceChannels(int numInputs, int numOutputs);
+
+    Graph &graph;
+    juce::AudioPluginFormatManager &formatManager;
+    juce::KnownPluginList &knownPlugins;
+    juce::AudioDeviceManager *deviceManager;
+
+    std::vector<PluginNode> nodes;
+    std::vector<NodeWire> wires;
+    int nextId { 1 };
+
+    double preparationSampleRate { 44100.0 };
+    int preparationBlockSize { 512 };
+
+    std::map<juce::uint32, std::unique_ptr<ParameterListener>> parameterListeners; // By graph node uid
+
+    std::map<int, juce::PluginDescription> loadingPlugins; // Placeholder node id -> plugin being created
+    juce::uint32 loadGeneration { 0 };                    // Bumped by resetGraph(): late instances are dropped
+
+    int restoreWorkers { -1 };
+    RestoreReport lastRestore;
+
+    std::vector<RemovedNode> removedNodes; // Oldest first
+    PluginInstanceCache instanceCache;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(GraphSession)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GraphSession)
+};
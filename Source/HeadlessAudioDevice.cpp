@@ -0,0 +1,191 @@
+/*
+ * HeadlessAudioDevice.cpp
+ * LightHost - 不需要音效卡的音頻設備實作
+ */
+
+#include "HeadlessAudioDevice.h"
+
+namespace
+{
+    constexpr int readAheadSamples = 1 << 16;  // Per channel, filled by the I/O thread
+    constexpr int writeBehindSamples = 1 << 16;
+    constexpr int readTimeoutMs = 100; // A slow disk stalls the stream instead of inserting silence
+
+    juce::StringArray makeChannelNames(const juce::String &prefix, int numChannels)
+    {
+        juce::StringArray names;
+        for (int ch = 0; ch < numChannels; ++ch)
+            names.add(prefix + " " + juce::String(ch + 1));
+        return names;
+    }
+} // namespace
+
+HeadlessAudioIODevice::HeadlessAudioIODevice(const juce::String &deviceName, int numInputChannels, int numOutputChannels)
+    : AudioIODevice(deviceName, "Headless"),
+      Thread("LightHost headless device"),
+      maxInputs(juce::jmax(0, numInputChannels)),
+      maxOutputs(juce::jmax(0, numOutputChannels))
+{
+}
+
+HeadlessAudioIODevice::~HeadlessAudioIODevice()
+{
+    close();
+}
+
+void HeadlessAudioIODevice::setInputReader(std::unique_ptr<juce::AudioFormatReader> reader, bool loop)
+{
+    jassert(!opened);
+    inputReader = reader != nullptr ? std::make_unique<juce::BufferingAudioReader>(reader.release(), ioThread, readAheadSamples)
+                                    : nullptr;
+    if (auto *buffering = dynamic_cast<juce::BufferingAudioReader *>(inputReader.get()))
+        buffering->setReadTimeout(readTimeoutMs);
+    loopInput = loop;
+}
+
+void HeadlessAudioIODevice::setOutputWriter(std::unique_ptr<juce::AudioFormatWriter> writer)
+{
+    jassert(!opened);
+    pendingWriter = std::move(writer);
+}
+
+juce::StringArray HeadlessAudioIODevice::getOutputChannelNames() { return makeChannelNames("Output", maxOutputs); }
+juce::StringArray HeadlessAudioIODevice::getInputChannelNames() { return makeChannelNames("Input", maxInputs); }
+juce::Array<double> HeadlessAudioIODevice::getAvailableSampleRates() { return {44100.0, 48000.0, 88200.0, 96000.0}; }
+juce::Array<int> HeadlessAudioIODevice::getAvailableBufferSizes() { return {32, 64, 128, 256, 480, 512, 1024, 2048}; }
+
+juce::String HeadlessAudioIODevice::open(const juce::BigInteger &inputChannels, const juce::BigInteger &outputChannels,
+                                         double newSampleRate, int bufferSizeSamples)
+{
+    close();
+
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 48000.0;
+    bufferSize = bufferSizeSamples > 0 ? bufferSizeSamples : getDefaultBufferSize();
+
+    activeInputs = inputChannels;
+    activeOutputs = outputChannels;
+    activeInputs.setRange(maxInputs, juce::jmax(0, activeInputs.getHighestBit() + 1 - maxInputs), false);
+    activeOutputs.setRange(maxOutputs, juce::jmax(0, activeOutputs.getHighestBit() + 1 - maxOutputs), false);
+
+    inputBuffer.setSize(juce::jmax(1, activeInputs.countNumberOfSetBits()), bufferSize);
+    outputBuffer.setSize(juce::jmax(1, activeOutputs.countNumberOfSetBits()), bufferSize);
+    readPointers.assign((size_t)inputBuffer.getNumChannels(), nullptr);
+
+    if (pendingWriter != nullptr)
+        outputWriter = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(pendingWriter.release(), ioThread, writeBehindSamples);
+
+    ioThread.startThread(juce::Thread::Priority::normal);
+    readPosition = 0;
+    finished.store(false);
+    opened = true;
+    lastError = {};
+    return {};
+}
+
+void HeadlessAudioIODevice::close()
+{
+    if (!opened)
+        return;
+
+    stop();
+    outputWriter.reset(); // Flushes the remaining samples to disk
+    ioThread.stopThread(5000);
+    opened = false;
+}
+
+void HeadlessAudioIODevice::start(juce::AudioIODeviceCallback *newCallback)
+{
+    if (!opened || newCallback == nullptr)
+        return;
+
+    stop();
+    newCallback->audioDeviceAboutToStart(this);
+    {
+        const juce::ScopedLock lock(callbackLock);
+        callback = newCallback;
+    }
+    startThread(juce::Thread::Priority::highest);
+}
+
+void HeadlessAudioIODevice::stop()
+{
+    stopThread(5000);
+
+    juce::AudioIODeviceCallback *stopped = nullptr;
+    {
+        const juce::ScopedLock lock(callbackLock);
+        std::swap(stopped, callback);
+    }
+    if (stopped != nullptr)
+        stopped->audioDeviceStopped();
+}
+
+void HeadlessAudioIODevice::readInput(int numSamples)
+{
+    inputBuffer.clear();
+    if (inputReader == nullptr || finished.load(std::memory_order_relaxed))
+        return;
+
+    const auto length = inputReader->lengthInSamples;
+    const int numChannels = juce::jmin(inputBuffer.getNumChannels(), (int)inputReader->numChannels);
+    int done = 0;
+    while (done < numSamples && length > 0)
+    {
+        if (readPosition >= length)
+        {
+            if (!loopInput)
+            {
+                finished.store(true, std::memory_order_release);
+                return;
+            }
+            readPosition = 0;
+        }
+
+        const int count = (int)juce::jmin((juce::int64)(numSamples - done), length - readPosition);
+        for (int ch = 0; ch < numChannels; ++ch)
+            readPointers[(size_t)ch] = inputBuffer.getWritePointer(ch, done);
+        inputReader->read(readPointers.data(), numChannels, readPosition, count);
+
+        readPosition += count;
+        done += count;
+    }
+}
+
+void HeadlessAudioIODevice::run()
+{
+    const double periodMs = 1000.0 * bufferSize / sampleRate;
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    juce::int64 block = 0;
+
+    while (!threadShouldExit())
+    {
+        const double blockStartMs = juce::Time::getMillisecondCounterHiRes();
+        const bool inputEnded = finished.load(std::memory_order_relaxed);
+        readInput(bufferSize);
+
+        {
+            const juce::ScopedLock lock(callbackLock);
+            if (callback != nullptr)
+            {
+                juce::AudioIODeviceCallbackContext context;
+                callback->audioDeviceIOCallbackWithContext(inputBuffer.getArrayOfReadPointers(), activeInputs.countNumberOfSetBits(),
+                                                           outputBuffer.getArrayOfWritePointers(), activeOutputs.countNumberOfSetBits(),
+                                                           bufferSize, context);
+            }
+        }
+
+        // The block that reached the end of the input is still written (its tail is silence)
+        if (outputWriter != nullptr && !inputEnded)
+            outputWriter->write(outputBuffer.getArrayOfReadPointers(), bufferSize);
+
+        numBlocks.store(++block, std::memory_order_relaxed);
+        if (juce::Time::getMillisecondCounterHiRes() - blockStartMs > periodMs)
+            xruns.fetch_add(1, std::memory_order_relaxed);
+
+        // Pace against the start time, so the average rate stays exact
+        const double dueMs = startMs + (double)block * periodMs;
+        const double waitMs = dueMs - juce::Time::getMillisecondCounterHiRes();
+        if (waitMs >= 1.0)
+            wait((int)waitMs);
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * HeadlessAudioDevice.h
+ * LightHost - 不需要音效卡的音頻設備（null / 檔案）
+ *
+ * 功能說明：
+ * - 以自己的執行緒按實際時間節奏（每個緩衝區週期一次）呼叫 AudioIODeviceCallback，
+ *   行為與真實設備相同，因此 LightHostCli 可在伺服器或 CI 上執行工作階段
+ * - null 設備：輸入靜音、輸出丟棄
+ * - 檔案設備：輸入來自音訊檔（可循環），輸出寫入音訊檔
+ *   讀寫都透過背景執行緒雙緩衝（BufferingAudioReader / ThreadedWriter），回調執行緒不做磁碟 I/O
+ * - 回調超過緩衝區週期時計為一次 xrun（getXRunCount()）
+ *
+ * 執行緒：
+ * - setInputReader() / setOutputWriter() 需在 open() 之前呼叫
+ * - 其餘與一般 AudioIODevice 相同
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class HeadlessAudioIODevice : public juce::AudioIODevice,
+                              private juce::Thread
+{
+public:
+    /**
+     * 建構子
+     *
+     * @param numInputChannels  輸入通道數（檔案設備可多於檔案的通道數，多出的通道為靜音）
+     * @param numOutputChannels 輸出通道數
+     */
+    HeadlessAudioIODevice(const juce::String &deviceName, int numInputChannels, int numOutputChannels);
+    ~HeadlessAudioIODevice() override;
+
+    /**
+     * setInputReader() 方法
+     * 以音訊檔取代靜音輸入
+     *
+     * @param reader 檔案讀取器（取得所有權）
+     * @param loop   讀完時從頭開始；否則讀完後 hasFinished() 回傳 true，輸入改為靜音
+     */
+    void setInputReader(std::unique_ptr<juce::AudioFormatReader> reader, bool loop);
+
+    /** 把輸出寫入檔案（取得所有權）；writer 的通道數應等於輸出通道數 */
+    void setOutputWriter(std::unique_ptr<juce::AudioFormatWriter> writer);
+
+    /** 非循環的輸入檔已讀完（任何執行緒） */
+    [[nodiscard]] bool hasFinished() const noexcept { return finished.load(std::memory_order_acquire); }
+
+    /** 已處理的區塊數（任何執行緒） */
+    [[nodiscard]] juce::int64 getNumBlocks() const noexcept { return numBlocks.load(std::memory_order_relaxed); }
+
+    //==============================================================================
+    juce::StringArray getOutputChannelNames() override;
+    juce::StringArray getInputChannelNames() override;
+    juce::Array<double> getAvailableSampleRates() override;
+    juce::Array<int> getAvailableBufferSizes() override;
+    int getDefaultBufferSize() override { return 512; }
+
+    juce::String open(const juce::BigInteger &inputChannels, const juce::BigInteger &outputChannels,
+                      double sampleRate, int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override { return opened; }
+
+    void start(juce::AudioIODeviceCallback *callback) override;
+    void stop() override;
+    bool isPlaying() override { return isThreadRunning(); }
+
+    juce::String getLastError() override { return lastError; }
+    int getCurrentBufferSizeSamples() override { return bufferSize; }
+    double getCurrentSampleRate() override { return sampleRate; }
+    int getCurrentBitDepth() override { return 32; }
+    juce::BigInteger getActiveOutputChannels() const override { return activeOutputs; }
+    juce::BigInteger getActiveInputChannels() const override { return activeInputs; }
+    int getOutputLatencyInSamples() override { return 0; }
+    int getInputLatencyInSamples() override { return 0; }
+    int getXRunCount() const noexcept override { return xruns.load(std::memory_order_relaxed); }
+
+private:
+    void run() override;
+
+    /** 讀取下一個輸入區塊到 inputBuffer（檔案或靜音） */
+    void readInput(int numSamples);
+
+    const int maxInputs, maxOutputs;
+
+    juce::TimeSliceThread ioThread{"LightHost headless device I/O"};
+    std::unique_ptr<juce::AudioFormatReader> inputReader;
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> outputWriter;
+    std::unique_ptr<juce::AudioFormatWriter> pendingWriter; // Until open() knows the block size
+    bool loopInput = false;
+    juce::int64 readPosition = 0;
+
+    juce::AudioBuffer<float> inputBuffer, outputBuffer;
+    std::vector<float *> readPointers; // Into inputBuffer, for the reader
+    juce::BigInteger activeInputs, activeOutputs;
+    double sampleRate = 48000.0;
+    int bufferSize = 512;
+    bool opened = false;
+    juce::String lastError;
+
+    juce::CriticalSection callbackLock;
+    juce::AudioIODeviceCallback *callback = nullptr;
+
+    std::atomic<bool> finished{false};
+    std::atomic<juce::int64> numBlocks{0};
+    std::atomic<int> xruns{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeadlessAudioIODevice)
+};
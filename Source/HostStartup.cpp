@@ -1,6 +1,7 @@
 #include "JuceHeader.h"
 #include "IconMenu.hpp"
 #include "LanguageManager.hpp"
+#include "RealtimeLog.h"
 
 #if ! (JUCE_PLUGINHOST_VST || JUCE_PLUGINHOST_VST3 || JUCE_PLUGINHOST_AU)
  #error "If you're building the audio plugin host, you probably want to enable VST and/or AU support"
@@ -25,12 +26,18 @@ public:
 
         LookAndFeel::setDefaultLookAndFeel (&lookAndFeel);
 
+        // Drains audio-thread log records to %APPDATA%/Light Host/Logs
+        RealtimeLog::getInstance().start (File::getSpecialLocation (File::userApplicationDataDirectory)
+                                              .getChildFile (getApplicationName())
+                                              .getChildFile ("Logs"));
+
         mainWindow.reset (new IconMenu());
     }
 
     void shutdown() override
     {
         mainWindow = nullptr;
+        RealtimeLog::getInstance().stop();
         appProperties = nullptr;
         LookAndFeel::setDefaultLookAndFeel (nullptr);
     }
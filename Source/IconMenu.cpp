@@ -14,29 +14,12 @@
 #include <ctime>
 #include <limits.h>
 #include "Windows.h"
-#include "VoicemeeterAudioDevice.h"  // Windows 專用：Voicemeeter 音頻設備支援
-
-// ==================== Windows 平台特定實現 ====================
-
-/**
- * LightHostAudioDeviceManager::createAudioDeviceTypes() 實現
- * 
- * 建立並註冊所有可用的音頻設備類型
- * 包括標準系統音頻設備和 Voicemeeter 虛擬設備
- * 
- * 步驟：
- * 1. 調用基類方法註冊標準設備
- * 2. 添加 Voicemeeter 自訂設備類型
- */
-void LightHostAudioDeviceManager::createAudioDeviceTypes (OwnedArray<AudioIODeviceType>& types)
-{
-    // 只添加 Voicemeeter 設備，移除所有標準系統音頻設備
-    types.add (new VoicemeeterAudioIODeviceType());
-}
 
 namespace
 {
 constexpr int languageMenuItemBase = 2000000000;  // 語言菜單項 ID 基數
+constexpr int fixedBlockSizeMenuItemBase = 100;   // 固定區塊大小菜單項 ID 基數
+constexpr int fixedBlockSizes[] = { 0, 64, 128, 256, 512, 1024 };  // 0 = 關閉
 }
 
 class IconMenu::PluginListWindow : public DocumentWindow
@@ -51,7 +34,7 @@ public:
 			->getFile().getSiblingFile("RecentlyCrashedPluginsList"));
 
 		setContentOwned(new PluginListComponent(pluginFormatManager,
-			owner.knownPluginList,
+			owner.engine.getKnownPlugins(),
 			deadMansPedalFile,
 			getAppProperties().getUserSettings()), true);
 
@@ -118,34 +101,26 @@ private:
 
 IconMenu::IconMenu() : INDEX_EDIT(1000000), INDEX_BYPASS(2000000), INDEX_DELETE(3000000), INDEX_MOVE_UP(4000000), INDEX_MOVE_DOWN(5000000)
 {
-    // Initiialization
-    addDefaultFormatsToManager(formatManager);
-    
     // Load saved language preference and apply it
     String savedLanguageId = getAppProperties().getUserSettings()->getValue("language", "English");
     LanguageManager::getInstance().setLanguageById(savedLanguageId);
     
     // Audio device
     std::unique_ptr<XmlElement> savedAudioState (getAppProperties().getUserSettings()->getXmlValue("audioDeviceState"));
-    deviceManager.initialise(256, 256, savedAudioState.get(), true);
-    player.setProcessor(&graph);
-    deviceManager.addAudioCallback(&player);
+    engine.getRenderer().setFadeOutInEnabled(getAppProperties().getUserSettings()->getBoolValue("topologyFadeOutIn", false));
+    engine.openDevice(savedAudioState.get(), getAppProperties().getUserSettings()->getIntValue("fixedBlockSize", 0));
     // Plugins - all
     std::unique_ptr<XmlElement> savedPluginList(getAppProperties().getUserSettings()->getXmlValue("pluginList"));
     if (savedPluginList != nullptr)
-        knownPluginList.recreateFromXml(*savedPluginList);
+        engine.getKnownPlugins().recreateFromXml(*savedPluginList);
     pluginSortMethod = KnownPluginList::sortByManufacturer;
-    knownPluginList.addChangeListener(this);
+    engine.getKnownPlugins().addChangeListener(this);
     // Plugins - active
     std::unique_ptr<XmlElement> savedPluginListActive(getAppProperties().getUserSettings()->getXmlValue("pluginListActive"));
     if (savedPluginListActive != nullptr)
         activePluginList.recreateFromXml(*savedPluginListActive);
     // Setup the main content and bind the graph change callback for saving
-    mainContent = std::make_unique<MainWindowContent>(
-        deviceManager,
-        knownPluginList,
-        formatManager,
-        graph);
+    mainContent = std::make_unique<MainWindowContent>(engine);
     
     mainContent->onManagePlugins = [this] { reloadPlugins(); };
     mainContent->onGraphChanged  = [this]
@@ -173,7 +148,7 @@ IconMenu::IconMenu() : INDEX_EDIT(1000000), INDEX_BYPASS(2000000), INDEX_DELETE(
     };
 
     // Load saved graph state after setting up fixed I/O nodes
-    // The loadActivePlugins() call now just setups the I/O nodes in AudioProcessorGraph
+    // The loadActivePlugins() call now just resets the session to its fixed I/O nodes
     loadActivePlugins();
     activePluginList.addChangeListener(this);
 
@@ -190,6 +165,8 @@ IconMenu::IconMenu() : INDEX_EDIT(1000000), INDEX_BYPASS(2000000), INDEX_DELETE(
 
 IconMenu::~IconMenu()
 {
+    engine.getKnownPlugins().removeChangeListener(this);
+    activePluginList.removeChangeListener(this);
 	savePluginStates();
     // clear window before tearing down device manager & graph
     mainWindow.reset();
@@ -215,24 +192,12 @@ void IconMenu::setIcon()
 
 void IconMenu::loadActivePlugins()
 {
-    const int INPUT  = 1000000;
-    const int OUTPUT = INPUT + 1;
-
     PluginWindow::closeAllCurrentlyOpenWindows();
-    graph.clear();
-
-    // Set up the graph's fixed I/O nodes.
-    // Audio routing is now driven by the NodeGraphCanvas UI.
-    inputNode  = graph.addNode(std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor>(
-                     AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode),
-                     AudioProcessorGraph::NodeID(INPUT));
-    outputNode = graph.addNode(std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor>(
-                     AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode),
-                     AudioProcessorGraph::NodeID(OUTPUT));
-
-    // NOTE: Plugin loading and connection routing is now handled by
-    // the NodeGraphCanvas (MainWindowContent). Draw wires in the canvas
-    // to route audio: Input → Plugin → Output.
+
+    // Empty session with the graph's fixed I/O nodes.
+    // Audio routing is driven by the NodeGraphCanvas UI, which edits the session:
+    // draw wires in the canvas to route audio: Input → Plugin → Output.
+    engine.getSession().resetGraph();
 }
 
 PluginDescription IconMenu::getNextPluginOlderThanTime(int &time)
@@ -257,9 +222,9 @@ PluginDescription IconMenu::getNextPluginOlderThanTime(int &time)
 
 void IconMenu::changeListenerCallback(ChangeBroadcaster* changed)
 {
-    if (changed == &knownPluginList)
+    if (changed == &engine.getKnownPlugins())
     {
-        std::unique_ptr<XmlElement> savedPluginList (knownPluginList.createXml());
+        std::unique_ptr<XmlElement> savedPluginList (engine.getKnownPlugins().createXml());
         if (savedPluginList != nullptr)
         {
             getAppProperties().getUserSettings()->setValue ("pluginList", savedPluginList.get());
@@ -277,6 +242,19 @@ void IconMenu::changeListenerCallback(ChangeBroadcaster* changed)
     }
 }
 
+/**
+ * setFixedBlockSize() 方法
+ * 儲存固定區塊大小設定，套用到 Voicemeeter 設備類型，並重新開啟目前的設備
+ *
+ * @param blockSize 固定區塊大小（樣本數），0 表示跟隨 Voicemeeter
+ */
+void IconMenu::setFixedBlockSize(int blockSize)
+{
+    getAppProperties().getUserSettings()->setValue("fixedBlockSize", blockSize);
+    getAppProperties().saveIfNeeded();
+
+    engine.setFixedBlockSize(blockSize);
+}
 
 void IconMenu::timerCallback()
 {
@@ -301,6 +279,21 @@ void IconMenu::timerCallback()
     
     menu.addSubMenu(LanguageManager::getInstance().getLanguageLabel(), languageMenu);
 
+    // Fixed plugin block size (re-blocking between Voicemeeter and the graph)
+    PopupMenu blockSizeMenu;
+    const int currentBlockSize = getAppProperties().getUserSettings()->getIntValue("fixedBlockSize", 0);
+    for (int i = 0; i < (int) std::size(fixedBlockSizes); ++i)
+    {
+        const int size = fixedBlockSizes[i];
+        const String label = size == 0 ? LanguageManager::getInstance().getText("fixedBlockSizeOff")
+                                        : String(size) + " " + LanguageManager::getInstance().getText("samples");
+        blockSizeMenu.addItem(fixedBlockSizeMenuItemBase + i, label, true, size == currentBlockSize);
+    }
+    menu.addSubMenu(LanguageManager::getInstance().getText("fixedBlockSize"), blockSizeMenu);
+
+    // Fade out / in when the wiring changes
+    menu.addItem(4, LanguageManager::getInstance().getText("topologyFadeOutIn"), true, engine.getRenderer().isFadeOutInEnabled());
+
     // Invert Icon Color
     menu.addItem(3, LanguageManager::getInstance().getText("invertIconColor"));
 
@@ -353,6 +346,21 @@ void IconMenu::menuInvocationCallback(int id, IconMenu* im)
         return im->setIcon();
     }
     
+    // ID 4: Fade out / in when the wiring changes
+    if (id == 4)
+    {
+        const bool fadeOutIn = !im->engine.getRenderer().isFadeOutInEnabled();
+        getAppProperties().getUserSettings()->setValue("topologyFadeOutIn", fadeOutIn);
+        getAppProperties().saveIfNeeded();
+        return im->engine.getRenderer().setFadeOutInEnabled(fadeOutIn);
+    }
+
+    // Fixed plugin block size
+    if (id >= fixedBlockSizeMenuItemBase && id < fixedBlockSizeMenuItemBase + (int) std::size(fixedBlockSizes))
+    {
+        return im->setFixedBlockSize(fixedBlockSizes[id - fixedBlockSizeMenuItemBase]);
+    }
+
     // Language selection - Handle dynamic language menu items
     if (id >= languageMenuItemBase)
     {
@@ -406,7 +414,7 @@ void IconMenu::savePluginStates()
     // This method iterates actual graph nodes and creates a plugin state backup
     // in case the node graph XML gets corrupted
     
-    for (const auto* node : graph.getNodes())
+    for (const auto* node : engine.getGraph().getNodes())
     {
         if (node == nullptr || node->getProcessor() == nullptr)
             continue;
@@ -444,7 +452,7 @@ void IconMenu::showAudioSettings()
 {
     // 只顯示 Voicemeeter 設備，不顯示採樣率、緩衝區或頻道設置
     AudioDeviceSelectorComponent audioSettingsComp(
-        deviceManager, 0, 0, 0, 0, false, false, false, false);
+        engine.getDeviceManager(), 0, 0, 0, 0, false, false, false, false);
     audioSettingsComp.setSize(300, 200);
     
     DialogWindow::LaunchOptions o;
@@ -458,7 +466,7 @@ void IconMenu::showAudioSettings()
 
     o.runModal();
         
-    std::unique_ptr<XmlElement> audioState(deviceManager.createStateXml());
+    std::unique_ptr<XmlElement> audioState(engine.getDeviceManager().createStateXml());
         
     getAppProperties().getUserSettings()->setValue("audioDeviceState", audioState.get());
     getAppProperties().getUserSettings()->saveIfNeeded();
@@ -467,16 +475,16 @@ void IconMenu::showAudioSettings()
 void IconMenu::reloadPlugins()
 {
 	if (pluginListWindow == nullptr)
-		pluginListWindow.reset (new PluginListWindow(*this, formatManager));
+		pluginListWindow.reset (new PluginListWindow(*this, engine.getFormatManager()));
 	pluginListWindow->toFront(true);
 }
 
 void IconMenu::removePluginsLackingInputOutput()
 {
 	// TODO needs sanity check
-    for (const auto& plugin : knownPluginList.getTypes())
+    for (const auto& plugin : engine.getKnownPlugins().getTypes())
     {
         if (plugin.numInputChannels < 2 || plugin.numOutputChannels < 2)
-		    knownPluginList.removeType(plugin);
+		    engine.getKnownPlugins().removeType(plugin);
     }
 }
@@ -10,37 +10,9 @@
 #define IconMenu_hpp
 
 #include "LanguageManager.hpp"
+#include "LightHostEngine.h"
 class MainWindowContent;
 
-// ==================== Windows 平台特定類別 ====================
-#if JUCE_WINDOWS
-class VoicemeeterAudioIODeviceType;
-
-/**
- * LightHostAudioDeviceManager 類別
- * 
- * Windows 平台自訂音頻設備管理器
- * 
- * 功能：
- * - 繼承自 JUCE AudioDeviceManager
- * - 註冊 Voicemeeter 虛擬音頻設備作為可用設備
- * - 支持與 Voicemeeter 的音頻互通
- * - Voicemeeter 允許應用程式互相連接音頻提供高度的靈活性
- */
-class LightHostAudioDeviceManager : public AudioDeviceManager
-{
-public:
-    /**
-     * 覆蓋 createAudioDeviceTypes() 方法
-     * 建立並註冊自訂的音頻設備類型
-     * 包括標準系統設備和 Voicemeeter 虛擬設備
-     * 
-     * @param types 用於儲存新建立的音頻設備類型的陣列
-     */
-    void createAudioDeviceTypes (OwnedArray<AudioIODeviceType>& types) override;
-};
-#endif
-
 // ==================== 全局函數宣告 ====================
 /**
  * getAppProperties() 函數
@@ -68,6 +40,7 @@ private:
     void reloadPlugins();
     void showAudioSettings();
     void loadActivePlugins();
+    void setFixedBlockSize(int blockSize);
     void savePluginStates();
     void deletePluginStates();
 	PluginDescription getNextPluginOlderThanTime(int &time);
@@ -77,19 +50,13 @@ private:
 
     // ==================== 音頻處理成員 ====================
     
-    LightHostAudioDeviceManager deviceManager;  // Windows 自訂設備管理器
+    LightHostEngine engine;  // 設備、外掛格式與清單、圖形、渲染器與工作階段（與 LightHostCli 共用）
     
-    AudioPluginFormatManager formatManager;
-    KnownPluginList knownPluginList;
     Array<PluginDescription> pluginMenuTypes;
     KnownPluginList activePluginList;
     KnownPluginList::SortMethod pluginSortMethod;
     PopupMenu menu;
     std::unique_ptr<PluginDirectoryScanner> scanner;
-    AudioProcessorGraph graph;
-    AudioProcessorPlayer player;
-    AudioProcessorGraph::Node *inputNode;
-    AudioProcessorGraph::Node *outputNode;
 
 	class PluginListWindow;
 	std::unique_ptr<PluginListWindow> pluginListWindow;
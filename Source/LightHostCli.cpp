@@ -0,0 +1,443 @@
+/*
+ * LightHostCli.cpp
+ * LightHost - 命令列宿主（無托盤、無視窗）
+ *
+ * 功能說明：
+ * - 以 LightHostEngine 載入儲存的工作階段（nodeGraphState）並執行，可用於伺服器、
+ *   效能分析與自動化測試
+ * - 執行對象：
+ *   - 音頻設備：預設使用工作階段一併儲存的設備設定，可用 --device-type / --device 指定
+ *   - null 設備（--null）：按實際時間節奏處理靜音，不需要音效卡
+ *   - 檔案設備（--input / --output）：按實際時間節奏從音訊檔讀取、寫入音訊檔
+ *   - 離線渲染（--render）：不需音頻設備、以全速處理一個或多個音訊檔，
+ *     多個檔案分散到不同核心同時渲染（每個檔案一個圖形實例），並列出即時倍率
+ * - 結束時列出每個外掛的負載（平滑 / 峰值，佔緩衝區週期的比例）
+ *
+ * 用法：
+ *   LightHostCli [--session=<file>] [--seconds=0] [--strict] [--restore-workers=-1]
+ *                [--device-type=<type>] [--device=<name>] [--list-devices]
+ *                [--null | --input=<wav/aiff> [--loop]] [--output=<wav/aiff>]
+ *                [--rate=48000] [--block=480] [--channels=2]
+ *   LightHostCli --render [--session=<file>] [--strict] [--block=512] [--jobs=<n>]
+ *                [--out-dir=<dir>] <wav/aiff>... | --input=<wav/aiff> [--output=<wav/aiff>]
+ *
+ * --session 可以是托盤程式的設定檔（預設為目前使用者的 Light Host.settings），
+ * 也可以是單獨儲存的 NodeGraph XML。--seconds=0 表示執行到輸入檔結束或 Ctrl+C。
+ * --strict 時有外掛無法載入就以結束碼 2 結束。
+ * --restore-workers 為載入工作階段時還原外掛的工作執行緒數（0 = 依序還原，用來量測基準）；
+ * 啟動時列出還原耗時與依序還原的估計值。
+ * --render 的輸出預設為輸入檔旁的 <名稱>-rendered.<副檔名>；--jobs 預設為檔案數與 CPU 核心數的較小值。
+ */
+
+#include "JuceHeader.h"
+#include "GraphAnalysis.h"
+#include "HeadlessAudioDevice.h"
+#include "LightHostEngine.h"
+#include "OfflineRenderJob.h"
+
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    std::atomic<bool> interrupted{false};
+
+    void handleInterrupt(int) { interrupted.store(true); }
+
+    /** 工作階段檔案的內容 */
+    struct SavedSession
+    {
+        std::unique_ptr<juce::XmlElement> graph;       // nodeGraphState
+        std::unique_ptr<juce::XmlElement> audioDevice; // audioDeviceState
+        std::unique_ptr<juce::XmlElement> pluginList;  // pluginList
+        int fixedBlockSize = 0;
+    };
+
+    /** 與 HostStartup 相同的設定檔選項，預設路徑因此指向托盤程式的設定檔 */
+    juce::PropertiesFile::Options getSettingsOptions()
+    {
+        juce::PropertiesFile::Options options;
+        options.applicationName = "Light Host";
+        options.filenameSuffix = "settings";
+        return options;
+    }
+
+    SavedSession loadSession(const juce::File &file, juce::String &error)
+    {
+        SavedSession session;
+        auto xml = juce::parseXML(file);
+        if (xml == nullptr)
+        {
+            error = "cannot read " + file.getFullPathName();
+            return session;
+        }
+
+        if (xml->hasTagName("NodeGraph"))
+        {
+            session.graph = std::move(xml);
+            return session;
+        }
+
+        juce::PropertiesFile settings(file, getSettingsOptions());
+        session.graph = settings.getXmlValue("nodeGraphState");
+        session.audioDevice = settings.getXmlValue("audioDeviceState");
+        session.pluginList = settings.getXmlValue("pluginList");
+        session.fixedBlockSize = settings.getIntValue("fixedBlockSize", 0);
+        if (session.graph == nullptr)
+            error = file.getFullPathName() + " has no saved session (nodeGraphState)";
+        return session;
+    }
+
+    void listDevices(LightHostAudioDeviceManager &deviceManager)
+    {
+        for (auto *type : deviceManager.getAvailableDeviceTypes())
+        {
+            type->scanForDevices();
+            std::cout << type->getTypeName() << "\n";
+            for (const auto &name : type->getDeviceNames())
+                std::cout << "  " << name << "\n";
+        }
+    }
+
+    /** 開啟音頻設備：工作階段的設備設定，再套用命令列指定的類型、名稱、採樣率與區塊大小 */
+    juce::String openDevice(LightHostEngine &engine, const SavedSession &session, const juce::ArgumentList &args)
+    {
+        auto &deviceManager = engine.getDeviceManager();
+        auto error = engine.openDevice(session.audioDevice.get(), session.fixedBlockSize);
+
+        if (args.containsOption("--device-type"))
+            deviceManager.setCurrentAudioDeviceType(args.getValueForOption("--device-type").unquoted(), true);
+
+        auto setup = deviceManager.getAudioDeviceSetup();
+        if (args.containsOption("--device"))
+            setup.inputDeviceName = setup.outputDeviceName = args.getValueForOption("--device").unquoted();
+        if (args.containsOption("--rate"))
+            setup.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+        if (args.containsOption("--block"))
+            setup.bufferSize = args.getValueForOption("--block").getIntValue();
+        if (args.containsOption("--device") || args.containsOption("--rate") || args.containsOption("--block"))
+            error = deviceManager.setAudioDeviceSetup(setup, true);
+
+        if (error.isEmpty() && deviceManager.getCurrentAudioDevice() == nullptr)
+            error = "no audio device could be opened";
+        return error;
+    }
+
+    juce::String formatRealtimeFactor(double audioSeconds, double renderSeconds)
+    {
+        return renderSeconds > 0.0 ? juce::String(audioSeconds / renderSeconds, 1) + "x realtime" : juce::String("-");
+    }
+
+    /**
+     * 離線渲染 --render：每個檔案一個 OfflineRenderJob，在訊息執行緒準備，在執行緒池同時渲染
+     *
+     * @return 結束碼
+     */
+    int renderOffline(const juce::File &sessionFile, const SavedSession &session, juce::KnownPluginList &knownPlugins,
+                      const juce::ArgumentList &args, juce::AudioFormatManager &audioFormats)
+    {
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+        std::vector<std::pair<juce::File, juce::File>> files; // Input, output
+
+        auto outputFor = [&](const juce::File &inputFile)
+        {
+            const auto dir = args.containsOption("--out-dir") ? cwd.getChildFile(args.getValueForOption("--out-dir").unquoted())
+                                                              : inputFile.getParentDirectory();
+            return dir.getChildFile(inputFile.getFileNameWithoutExtension() + "-rendered" + inputFile.getFileExtension());
+        };
+
+        if (args.containsOption("--input"))
+        {
+            const auto inputFile = cwd.getChildFile(args.getValueForOption("--input").unquoted());
+            files.emplace_back(inputFile, args.containsOption("--output") ? cwd.getChildFile(args.getValueForOption("--output").unquoted())
+                                                                          : outputFor(inputFile));
+        }
+        for (const auto &arg : args.arguments)
+            if (!arg.isOption())
+                files.emplace_back(arg.resolveAsFile(), outputFor(arg.resolveAsFile()));
+
+        if (files.empty())
+        {
+            std::cerr << "LightHostCli: --render needs at least one input file" << std::endl;
+            return 1;
+        }
+        if (args.containsOption("--out-dir"))
+            cwd.getChildFile(args.getValueForOption("--out-dir").unquoted()).createDirectory();
+
+        const int numJobs = juce::jlimit(1, (int)files.size(),
+                                         args.containsOption("--jobs") ? args.getValueForOption("--jobs").getIntValue()
+                                                                       : juce::SystemStats::getNumCpus());
+        const int blockSize = juce::jmax(16, args.containsOption("--block") ? args.getValueForOption("--block").getIntValue() : 512);
+
+        // Files already fill the cores when several render at once; a single file spreads its branches instead
+        const int numWorkers = numJobs > 1 ? 0 : -1;
+
+        juce::TimeSliceThread ioThread("LightHost offline render I/O");
+        ioThread.startThread(juce::Thread::Priority::normal);
+
+        // Plugins are created and destroyed on the message thread
+        std::vector<std::unique_ptr<OfflineRenderJob>> jobs;
+        int numMissing = 0;
+        for (const auto &[inputFile, outputFile] : files)
+        {
+            auto job = std::make_unique<OfflineRenderJob>(knownPlugins, numWorkers);
+            const auto error = job->prepare(*session.graph, inputFile, outputFile, blockSize, audioFormats, ioThread);
+            if (error.isNotEmpty())
+            {
+                std::cerr << "LightHostCli: " << inputFile.getFileName() << ": " << error << std::endl;
+                return 1;
+            }
+            if (jobs.empty())
+                for (const auto &name : job->getMissingPlugins())
+                {
+                    std::cerr << "LightHostCli: plugin not loaded: " << name << std::endl;
+                    ++numMissing;
+                }
+            jobs.push_back(std::move(job));
+        }
+        if (numMissing > 0 && args.containsOption("--strict"))
+            return 2;
+
+        std::cout << "LightHost: rendering " << jobs.size() << " file(s) through " << sessionFile.getFileName()
+                  << ", " << numJobs << " at a time, " << blockSize << " samples per block" << std::endl;
+
+        std::vector<OfflineRenderJob::Result> results(jobs.size());
+        std::atomic<int> numDone{0};
+        {
+            juce::ThreadPool pool(numJobs);
+            for (size_t i = 0; i < jobs.size(); ++i)
+                pool.addJob([&, i]
+                            {
+                                results[i] = jobs[i]->render(interrupted);
+                                numDone.fetch_add(1);
+                            });
+
+            // Keep the message thread running: some plugins post to it while processing
+            const auto startMs = juce::Time::getMillisecondCounterHiRes();
+            while (numDone.load() < (int)jobs.size())
+                juce::MessageManager::getInstance()->runDispatchLoopUntil(50);
+            const double wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startMs) * 0.001;
+
+            double totalAudioSeconds = 0.0;
+            bool failed = false;
+            for (size_t i = 0; i < jobs.size(); ++i)
+            {
+                const auto &result = results[i];
+                std::cout << "  " << jobs[i]->getInputFile().getFileName() << " -> " << jobs[i]->getOutputFile().getFullPathName() << ": ";
+                if (result.error.isNotEmpty())
+                {
+                    std::cout << result.error << "\n";
+                    failed = true;
+                    continue;
+                }
+                totalAudioSeconds += result.getAudioSeconds();
+                std::cout << juce::String(result.getAudioSeconds(), 1) << " s in " << juce::String(result.renderSeconds, 2) << " s, "
+                          << formatRealtimeFactor(result.getAudioSeconds(), result.renderSeconds)
+                          << (result.cancelled ? " (cancelled)" : "") << "\n";
+            }
+            std::cout << "Rendered " << juce::String(totalAudioSeconds, 1) << " s of audio in " << juce::String(wallSeconds, 2)
+                      << " s, " << formatRealtimeFactor(totalAudioSeconds, wallSeconds) << std::endl;
+
+            if (failed || interrupted.load())
+                return 1;
+        }
+        return 0;
+    }
+
+    void printRestoreReport(const GraphSession &session)
+    {
+        const auto &report = session.getLastRestoreReport();
+        std::cout << "Restored " << report.numPlugins << " plugin(s) in " << juce::String(report.wallMilliseconds, 1) << " ms on "
+                  << report.numWorkers << " worker(s); sequential " << juce::String(report.sequentialMilliseconds, 1) << " ms ("
+                  << juce::String(report.getSpeedup(), 2) << "x)" << std::endl;
+    }
+
+    void printNodeLoads(LightHostEngine &engine)
+    {
+        auto &timing = engine.getRenderer().getTimingMonitor();
+        for (const auto &node : engine.getSession().getNodes())
+        {
+            if (node.type != NodeType::Plugin)
+                continue;
+
+            const auto reading = timing.getReading(node.graphNodeId.uid);
+            std::cout << "  " << node.name;
+            if (node.loadMilliseconds > 0.0)
+                std::cout << " (loaded in " << juce::roundToInt(node.loadMilliseconds) << " ms)";
+            std::cout << ": ";
+            if (node.graphNodeId.uid == 0)
+                std::cout << "not loaded\n";
+            else if (node.bypassed)
+                std::cout << "bypassed\n";
+            else if (reading.numBlocks == 0)
+                std::cout << "not timed\n";
+            else
+                std::cout << juce::String(reading.load * 100.0, 1) << "% / peak " << juce::String(reading.peakLoad * 100.0, 1)
+                          << "% of the buffer period\n";
+        }
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // Message thread for plugins; no window is created
+
+    const juce::ArgumentList args(argc, argv);
+    auto readInt = [&args](const juce::String &option, int fallback)
+    { return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : fallback; };
+    auto readFile = [&args](const juce::String &option)
+    { return juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption(option).unquoted()); };
+
+    LightHostEngine engine;
+    engine.getDeviceManager().setIncludeSystemDevices(true);
+
+    if (args.containsOption("--list-devices"))
+    {
+        listDevices(engine.getDeviceManager());
+        return 0;
+    }
+
+    const auto sessionFile = args.containsOption("--session") ? readFile("--session")
+                                                              : getSettingsOptions().getDefaultFile();
+    juce::String error;
+    const auto session = loadSession(sessionFile, error);
+    if (error.isNotEmpty())
+    {
+        std::cerr << "LightHostCli: " << error << std::endl;
+        return 1;
+    }
+    if (session.pluginList != nullptr)
+        engine.getKnownPlugins().recreateFromXml(*session.pluginList);
+    engine.getSession().setRestoreWorkers(readInt("--restore-workers", -1));
+
+    juce::AudioFormatManager audioFormats;
+    audioFormats.registerBasicFormats();
+
+    std::signal(SIGINT, handleInterrupt);
+    std::signal(SIGTERM, handleInterrupt);
+
+    if (args.containsOption("--render"))
+        return renderOffline(sessionFile, session, engine.getKnownPlugins(), args, audioFormats);
+
+    const bool headless = args.containsOption("--null") || args.containsOption("--input") || args.containsOption("--output");
+    std::unique_ptr<HeadlessAudioIODevice> headlessDevice;
+    juce::AudioIODevice *device = nullptr;
+
+    if (headless)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader;
+        if (args.containsOption("--input"))
+        {
+            reader.reset(audioFormats.createReaderFor(readFile("--input")));
+            if (reader == nullptr)
+            {
+                std::cerr << "LightHostCli: cannot read " << args.getValueForOption("--input") << std::endl;
+                return 1;
+            }
+        }
+
+        const double sampleRate = args.containsOption("--rate") ? args.getValueForOption("--rate").getDoubleValue()
+                                  : reader != nullptr           ? reader->sampleRate
+                                                                : 48000.0;
+        const int blockSize = juce::jmax(16, readInt("--block", 480));
+
+        // Plugins are prepared once, at the rate the headless device runs at
+        engine.getSession().setPreparationSpec(sampleRate, blockSize);
+        engine.getSession().loadState(*session.graph);
+
+        const auto used = GraphAnalysis::getUsedIOChannels(engine.getGraph());
+        const int numInputs = readInt("--channels", juce::jmax(2, used.numInputs, reader != nullptr ? (int)reader->numChannels : 0));
+        const int numOutputs = readInt("--channels", juce::jmax(2, used.numOutputs));
+
+        headlessDevice = std::make_unique<HeadlessAudioIODevice>(reader != nullptr ? "File" : "Null", numInputs, numOutputs);
+        if (reader != nullptr)
+            headlessDevice->setInputReader(std::move(reader), args.containsOption("--loop"));
+
+        if (args.containsOption("--output"))
+        {
+            const auto outputFile = readFile("--output");
+            auto *format = audioFormats.findFormatForFileExtension(outputFile.getFileExtension());
+            auto stream = std::make_unique<juce::FileOutputStream>(outputFile);
+            if (format == nullptr || !stream->openedOk() || !stream->setPosition(0) || !stream->truncate().wasOk())
+            {
+                std::cerr << "LightHostCli: cannot write " << outputFile.getFullPathName() << std::endl;
+                return 1;
+            }
+
+            std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, (unsigned int)numOutputs, 24, {}, 0));
+            if (writer == nullptr)
+            {
+                std::cerr << "LightHostCli: " << format->getFormatName() << " cannot write " << numOutputs << " channels at "
+                          << sampleRate << " Hz" << std::endl;
+                return 1;
+            }
+            stream.release(); // Owned by the writer
+            headlessDevice->setOutputWriter(std::move(writer));
+        }
+
+        juce::BigInteger inputs, outputs;
+        inputs.setRange(0, numInputs, true);
+        outputs.setRange(0, numOutputs, true);
+        error = headlessDevice->open(inputs, outputs, sampleRate, blockSize);
+        if (error.isEmpty())
+        {
+            headlessDevice->start(&engine.getPlayer());
+            device = headlessDevice.get();
+        }
+    }
+    else
+    {
+        // Same order as the tray app: plugins are created at the open device's rate
+        error = openDevice(engine, session, args);
+        engine.getSession().loadState(*session.graph);
+        device = engine.getDeviceManager().getCurrentAudioDevice();
+    }
+
+    if (error.isNotEmpty() || device == nullptr)
+    {
+        std::cerr << "LightHostCli: " << (error.isNotEmpty() ? error : juce::String("no audio device")) << std::endl;
+        return 1;
+    }
+
+    int numMissing = 0;
+    for (const auto &node : engine.getSession().getNodes())
+        if (node.type == NodeType::Plugin && node.graphNodeId.uid == 0)
+        {
+            std::cerr << "LightHostCli: plugin not loaded: " << node.name << std::endl;
+            ++numMissing;
+        }
+    if (numMissing > 0 && args.containsOption("--strict"))
+        return 2;
+
+    printRestoreReport(engine.getSession());
+    std::cout << "LightHost: " << sessionFile.getFileName() << " on " << device->getTypeName() << " / " << device->getName()
+              << " (" << device->getCurrentSampleRate() << " Hz, " << device->getCurrentBufferSizeSamples() << " samples, "
+              << device->getActiveInputChannels().countNumberOfSetBits() << " in, "
+              << device->getActiveOutputChannels().countNumberOfSetBits() << " out)" << std::endl;
+
+    const int seconds = juce::jmax(0, readInt("--seconds", 0));
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+    while (!interrupted.load())
+    {
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(100);
+
+        if (seconds > 0 && juce::Time::getMillisecondCounterHiRes() - startMs >= seconds * 1000.0)
+            break;
+        if (headlessDevice != nullptr && headlessDevice->hasFinished())
+            break;
+    }
+
+    std::cout << "Ran " << juce::String((juce::Time::getMillisecondCounterHiRes() - startMs) * 0.001, 1) << " s"
+              << (engine.getRenderer().isRenderingInParallel() ? ", parallel render" : ", serial render");
+    if (device->getXRunCount() >= 0)
+        std::cout << ", " << device->getXRunCount() << " xruns";
+    std::cout << "\n";
+    printNodeLoads(engine);
+
+    if (headlessDevice != nullptr)
+        headlessDevice->close(); // Flushes the output file
+    engine.closeDevice();
+    return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * LightHostEngine.cpp
+ * LightHost - 無介面音頻引擎的實作
+ */
+
+#include "LightHostEngine.h"
+#include "GraphAnalysis.h"
+#include "VoicemeeterAudioDevice.h"
+
+#define LIGHTHOST_HAS_VOICEMEETER (JUCE_WINDOWS || LIGHTHOST_VOICEMEETER_STANDIN)
+
+//==============================================================================
+void LightHostAudioDeviceManager::setFixedBlockSize(int blockSize)
+{
+    fixedBlockSize = juce::jmax(0, blockSize);
+
+#if LIGHTHOST_HAS_VOICEMEETER
+    for (auto *type : getAvailableDeviceTypes())
+        if (auto *voicemeeterType = dynamic_cast<VoicemeeterAudioIODeviceType *>(type))
+            voicemeeterType->setFixedBlockSize(fixedBlockSize);
+#endif
+}
+
+void LightHostAudioDeviceManager::createAudioDeviceTypes(juce::OwnedArray<juce::AudioIODeviceType> &types)
+{
+#if LIGHTHOST_HAS_VOICEMEETER
+    // The tray app only offers Voicemeeter; the standard system devices are left out
+    if (includeSystemDevices)
+        AudioDeviceManager::createAudioDeviceTypes(types);
+
+    auto *voicemeeterType = new VoicemeeterAudioIODeviceType();
+    voicemeeterType->setFixedBlockSize(fixedBlockSize);
+    types.add(voicemeeterType);
+#else
+    AudioDeviceManager::createAudioDeviceTypes(types);
+#endif
+}
+
+//==============================================================================
+LightHostEngine::LightHostEngine()
+{
+    juce::addDefaultFormatsToManager(formatManager);
+
+    // The graph stays the editing model; the renderer processes its independent branches in parallel
+    player.setProcessor(&renderer);
+
+    // Re-evaluate the pass-through fast path whenever the wiring or the device changes
+    graph.addChangeListener(this);
+    deviceManager.addChangeListener(this);
+    renderer.addListener(this);
+
+    // Deleted plugins stay warm for a while, so re-adding or undoing a delete is instant
+    PluginInstanceCache::Limits cacheLimits;
+    cacheLimits.maxInstances = 8;
+    session.getInstanceCache().setLimits(cacheLimits);
+
+    session.resetGraph();
+}
+
+LightHostEngine::~LightHostEngine()
+{
+    renderer.removeListener(this);
+    graph.removeChangeListener(this);
+    deviceManager.removeChangeListener(this);
+    cancelPendingUpdate();
+    closeDevice();
+    player.setProcessor(nullptr);
+}
+
+juce::String LightHostEngine::openDevice(const juce::XmlElement *savedState, int fixedBlockSize)
+{
+    deviceManager.setFixedBlockSize(fixedBlockSize);
+    const auto error = deviceManager.initialise(256, 256, savedState, true);
+
+    if (!deviceOpen)
+    {
+        deviceManager.addAudioCallback(&player);
+        deviceOpen = true;
+    }
+
+    updateDeviceChannels();
+    updatePassThrough();
+    updateGraphLatency();
+    return error;
+}
+
+void LightHostEngine::setFixedBlockSize(int blockSize)
+{
+    deviceManager.setFixedBlockSize(blockSize);
+
+    // The block size is applied in open(): reopen the current device with the same setup
+    deviceManager.closeAudioDevice();
+    deviceManager.restartLastAudioDevice();
+}
+
+void LightHostEngine::closeDevice()
+{
+    if (!deviceOpen)
+        return;
+
+    deviceManager.removeAudioCallback(&player);
+    deviceManager.closeAudioDevice();
+    deviceOpen = false;
+}
+
+void LightHostEngine::changeListenerCallback(juce::ChangeBroadcaster *source)
+{
+    if (source == &graph || source == &deviceManager)
+    {
+        updateDeviceChannels();
+        updatePassThrough();
+        updateGraphLatency();
+    }
+}
+
+void LightHostEngine::audioProcessorChanged(juce::AudioProcessor *processor, const ChangeDetails &details)
+{
+    if (processor == &renderer && details.latencyChanged)
+        triggerAsyncUpdate();
+}
+
+void LightHostEngine::handleAsyncUpdate()
+{
+    updateGraphLatency();
+}
+
+void LightHostEngine::updateGraphLatency()
+{
+#if LIGHTHOST_HAS_VOICEMEETER
+    // The device only sees AudioDeviceManager's callback, never the player or the renderer
+    if (auto *device = dynamic_cast<VoicemeeterAudioIODevice *>(deviceManager.getCurrentAudioDevice()))
+        device->setGraphLatencySamples(renderer.getLatencySamples());
+#endif
+}
+
+void LightHostEngine::updatePassThrough()
+{
+#if LIGHTHOST_HAS_VOICEMEETER
+    auto *device = dynamic_cast<VoicemeeterAudioIODevice *>(deviceManager.getCurrentAudioDevice());
+    if (device == nullptr)
+        return;
+
+    const int numInputs = device->getActiveInputChannels().countNumberOfSetBits();
+    const int numOutputs = device->getActiveOutputChannels().countNumberOfSetBits();
+
+    // Outputs without a matching input channel would need silence, not pass-through
+    device->setPassThrough(numOutputs <= numInputs && GraphAnalysis::isPassThrough(graph, numOutputs));
+#endif
+}
+
+void LightHostEngine::updateDeviceChannels()
+{
+    auto *device = deviceManager.getCurrentAudioDevice();
+    if (device == nullptr)
+        return;
+
+    const auto used = GraphAnalysis::getUsedIOChannels(graph);
+    const int numInputs = juce::jmin(juce::jmax(2, used.numInputs), device->getInputChannelNames().size());
+    const int numOutputs = juce::jmin(juce::jmax(2, used.numOutputs), device->getOutputChannelNames().size());
+
+    auto setup = deviceManager.getAudioDeviceSetup();
+    juce::BigInteger inputChannels, outputChannels;
+    inputChannels.setRange(0, numInputs, true);
+    outputChannels.setRange(0, numOutputs, true);
+
+    if (!setup.useDefaultInputChannels && !setup.useDefaultOutputChannels
+        && setup.inputChannels == inputChannels && setup.outputChannels == outputChannels)
+        return;
+
+    setup.useDefaultInputChannels = false;
+    setup.useDefaultOutputChannels = false;
+    setup.inputChannels = inputChannels;
+    setup.outputChannels = outputChannels;
+    deviceManager.setAudioDeviceSetup(setup, true);
+}
@@ -0,0 +1,123 @@
+/*
+ * LightHostEngine.h
+ * LightHost - 無介面的音頻引擎（設備、圖形、渲染器、工作階段）
+ *
+ * 功能說明：
+ * - 擁有托盤程式與 LightHostCli 共用的所有音頻物件：
+ *   設備管理器、外掛格式與清單、AudioProcessorGraph、ParallelGraphProcessor、
+ *   AudioProcessorPlayer 與 GraphSession
+ * - 設備處理：開啟（含 Voicemeeter 固定區塊大小）、只開啟連線用到的通道、
+ *   圖形只剩直通時讓 Voicemeeter 設備略過圖形、渲染器的延遲變更時告知 Voicemeeter 設備
+ * - 不使用任何視窗、托盤或應用程式設定；持久化由呼叫端負責
+ *
+ * 註：JUCE 的外掛宿主模組本身依賴 juce_gui_extra（外掛編輯器），因此仍需連結 GUI 模組，
+ *     但引擎可在沒有任何視窗的情況下於 ScopedJuceInitialiser_GUI 下執行
+ *
+ * 執行緒：
+ * - 除非另有說明，所有方法只能在訊息執行緒呼叫
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+#include "GraphSession.h"
+#include "ParallelGraphProcessor.h"
+
+//==============================================================================
+/**
+ * LightHostAudioDeviceManager 類別
+ *
+ * 註冊 Voicemeeter 虛擬音頻設備（Windows 或 stand-in 建置）
+ * 托盤程式只列出 Voicemeeter；setIncludeSystemDevices(true) 時也列出系統設備（CLI 使用）
+ * 沒有 Voicemeeter 的平台一律使用系統設備
+ */
+class LightHostAudioDeviceManager : public juce::AudioDeviceManager
+{
+public:
+    /** 在第一次開啟設備之前設定 */
+    void setIncludeSystemDevices(bool shouldInclude) noexcept { includeSystemDevices = shouldInclude; }
+
+    /** 設定 Voicemeeter 的固定區塊大小（0 = 跟隨 Voicemeeter）；下次開啟設備時生效 */
+    void setFixedBlockSize(int blockSize);
+
+    void createAudioDeviceTypes(juce::OwnedArray<juce::AudioIODeviceType> &types) override;
+
+private:
+    bool includeSystemDevices = false;
+    int fixedBlockSize = 0;
+};
+
+//==============================================================================
+class LightHostEngine : private juce::ChangeListener,
+                        private juce::AudioProcessorListener,
+                        private juce::AsyncUpdater
+{
+public:
+    LightHostEngine();
+    ~LightHostEngine() override;
+
+    /**
+     * openDevice() 方法
+     * 開啟音頻設備並開始以渲染器處理
+     *
+     * @param savedState     AudioDeviceManager::createStateXml() 儲存的設定；nullptr 表示預設設備
+     * @param fixedBlockSize Voicemeeter 固定區塊大小（0 = 關閉）
+     * @return 錯誤訊息；成功時為空字串
+     */
+    juce::String openDevice(const juce::XmlElement *savedState, int fixedBlockSize = 0);
+
+    /** 變更 Voicemeeter 固定區塊大小並以相同設定重新開啟目前的設備 */
+    void setFixedBlockSize(int blockSize);
+
+    /** 停止處理並關閉設備 */
+    void closeDevice();
+
+    //==============================================================================
+    [[nodiscard]] LightHostAudioDeviceManager &getDeviceManager() noexcept { return deviceManager; }
+    [[nodiscard]] juce::AudioPluginFormatManager &getFormatManager() noexcept { return formatManager; }
+    [[nodiscard]] juce::KnownPluginList &getKnownPlugins() noexcept { return knownPlugins; }
+    [[nodiscard]] juce::AudioProcessorGraph &getGraph() noexcept { return graph; }
+    [[nodiscard]] ParallelGraphProcessor &getRenderer() noexcept { return renderer; }
+    [[nodiscard]] juce::AudioProcessorPlayer &getPlayer() noexcept { return player; }
+    [[nodiscard]] GraphSession &getSession() noexcept { return session; }
+
+private:
+    void changeListenerCallback(juce::ChangeBroadcaster *source) override;
+
+    // The renderer's latency may change on any thread: forwarded to the message thread
+    void audioProcessorParameterChanged(juce::AudioProcessor *, int, float) override {}
+    void audioProcessorChanged(juce::AudioProcessor *processor, const ChangeDetails &details) override;
+    void handleAsyncUpdate() override;
+
+    /**
+     * updateDeviceChannels() 方法
+     * 設備只開啟連線實際用到的通道（從 0 起的連續範圍，至少立體聲）
+     *
+     * 立體聲鏈不必為 8 通道的匯流排配置與複製緩衝區；未開啟的 Voicemeeter 通道
+     * 維持原樣直通。範圍保持連續，圖形的通道索引才會與設備通道一致。
+     * 通道組合不變時不重新開啟設備；工作階段加入超出範圍的連線時會先自行擴充。
+     */
+    void updateDeviceChannels();
+
+    /**
+     * updatePassThrough() 方法
+     * 圖形只剩 Input -> Output（或只經過已旁通的外掛）時，
+     * 讓 Voicemeeter 設備略過 AudioProcessorPlayer，直接直通音頻
+     */
+    void updatePassThrough();
+
+    /** 把渲染器目前的延遲告知 Voicemeeter 設備（計入設備回報的輸出延遲） */
+    void updateGraphLatency();
+
+    LightHostAudioDeviceManager deviceManager;
+    juce::AudioPluginFormatManager formatManager;
+    juce::KnownPluginList knownPlugins;
+    juce::AudioProcessorGraph graph;
+    ParallelGraphProcessor renderer{graph}; // 平行渲染 graph；player 的處理器
+    juce::AudioProcessorPlayer player;
+    GraphSession session{graph, formatManager, knownPlugins, &deviceManager};
+
+    bool deviceOpen = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LightHostEngine)
+};
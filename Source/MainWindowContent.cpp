@@ -3,6 +3,7 @@
 #include "IconMenu.hpp"
 #include "LanguageManager.hpp"
 #include "AudioDeviceSettings.h"
+#include "VoicemeeterAudioDevice.h"
 
 // ============================================================
 // Palette — matches original LightHost light-grey system UI
@@ -197,39 +198,106 @@ private:
 };
 
 // ============================================================
-// ScaleSettingsDialog - Settings window for scale factor
+// NodeGraphCanvas — constructor
 // ============================================================
-class PluginParameterListener : public AudioProcessorListener
+
+NodeGraphCanvas::NodeGraphCanvas(GraphSession& s,
+                                 AudioDeviceManager& dm,
+                                 NodeTimingMonitor& timing)
+    : session(s), deviceManager(dm), timingMonitor(timing),
+      nodes(s.getNodes()), wires(s.getWires())
 {
-public:
-    explicit PluginParameterListener(std::function<void()> callback)
-        : onParameterChanged(std::move(callback)) {}
-    
-    void audioProcessorChanged(AudioProcessor*, const ChangeDetails&) override { }
-    void audioProcessorParameterChanged(AudioProcessor*, int, float) override
-    {
-        if (onParameterChanged) onParameterChanged();
-    }
+    setOpaque(true);
+    setWantsKeyboardFocus(true);  // Enable keyboard focus for Delete key handling
+    startTimer(100);              // Load meters; latency labels every fifth tick
 
-private:
-    std::function<void()> onParameterChanged;
-};
+    // Not a repaint: parameter changes may be reported from the audio thread
+    session.onChanged = [this] { if (onGraphChanged) onGraphChanged(); };
+}
 
-// Global map to hold plugin listeners and keep them alive
-static std::map<uint32, std::unique_ptr<PluginParameterListener>> g_pluginListeners;
+NodeGraphCanvas::~NodeGraphCanvas()
+{
+    session.onChanged = nullptr;
+}
 
 // ============================================================
-// NodeGraphCanvas — constructor
+// Latency breakdown
 // ============================================================
 
-NodeGraphCanvas::NodeGraphCanvas(AudioDeviceManager& dm,
-                                 KnownPluginList& kpl,
-                                 AudioPluginFormatManager& fmt,
-                                 AudioProcessorGraph& g)
-    : deviceManager(dm), knownPlugins(kpl), formatManager(fmt), graph(g)
+void NodeGraphCanvas::timerCallback()
 {
-    setOpaque(true);
-    setWantsKeyboardFocus(true);  // Enable keyboard focus for Delete key handling
+    refreshTimings();
+
+    // Latency labels follow plugins that change latency while running
+    if (++timerTicks % 5 == 0)
+        refreshLatencies();
+}
+
+void NodeGraphCanvas::refreshTimings()
+{
+    std::map<AudioProcessorGraph::NodeID, NodeTimingMonitor::Reading> updated;
+    for (const auto& n : nodes)
+        if (n.type == NodeType::Plugin && n.graphNodeId.uid != 0)
+            updated[n.graphNodeId] = timingMonitor.getReading(n.graphNodeId.uid);
+
+    // Compared at the precision drawn, so a steady meter does not repaint the canvas
+    auto drawnAs = [](double load) { return roundToInt(load * 1000.0); };
+    const bool changed = updated.size() != timings.size()
+        || !std::equal(updated.begin(), updated.end(), timings.begin(), [&](const auto& a, const auto& b)
+               { return a.first == b.first && drawnAs(a.second.load) == drawnAs(b.second.load)
+                     && drawnAs(a.second.peakLoad) == drawnAs(b.second.peakLoad); });
+
+    if (changed)
+    {
+        timings = std::move(updated);
+        repaint();
+    }
+}
+
+String NodeGraphCanvas::getGraphNodeLabel(AudioProcessorGraph::NodeID graphNodeId) const
+{
+    for (const auto& n : nodes)
+        if (n.graphNodeId == graphNodeId)
+            return n.name;
+    return {};
+}
+
+void NodeGraphCanvas::refreshLatencies()
+{
+    auto* device = deviceManager.getCurrentAudioDevice();
+    const double sampleRate = device != nullptr ? device->getCurrentSampleRate() : 0.0;
+
+    auto updated = GraphAnalysis::computePathLatencies(session.getGraph());
+    const bool changed = sampleRate != latencySampleRate
+        || updated.size() != latencies.size()
+        || !std::equal(updated.begin(), updated.end(), latencies.begin(), [](const auto& a, const auto& b)
+               { return a.first == b.first && a.second.ownSamples == b.second.ownSamples
+                     && a.second.pathSamples == b.second.pathSamples; });
+
+    if (changed)
+    {
+        latencies = std::move(updated);
+        latencySampleRate = sampleRate;
+        repaint();
+    }
+}
+
+String NodeGraphCanvas::formatWireGain(float gainDecibels)
+{
+    return gainDecibels <= NodeWire::minusInfinityDb ? LanguageManager::getInstance().getText("mute")
+                                                             : Decibels::toString(gainDecibels, 1);
+}
+
+String NodeGraphCanvas::formatLoadTime(double milliseconds)
+{
+    return milliseconds < 1000.0 ? String(roundToInt(milliseconds)) + " ms" : String(milliseconds * 0.001, 1) + " s";
+}
+
+String NodeGraphCanvas::formatLatency(int samples) const
+{
+    if (latencySampleRate <= 0.0)
+        return String(samples) + " smp";
+    return String(samples * 1000.0 / latencySampleRate, 1) + " ms";
 }
 
 // ============================================================
@@ -247,14 +315,16 @@ Point<int> NodeGraphCanvas::inputPortPos(const PluginNode& n) const
 {
     if (n.type == NodeType::Input)  return { -999, -999 };
     if (n.type == NodeType::Output) { auto b = nodeBounds(n); return { b.getX(), b.getCentreY() }; }
-    return n.inputPort();
+    const auto b = pluginBounds(n);
+    return { b.getX(), b.getCentreY() };
 }
 
 Point<int> NodeGraphCanvas::outputPortPos(const PluginNode& n) const
 {
     if (n.type == NodeType::Output) return { -999, -999 };
     if (n.type == NodeType::Input)  { auto b = nodeBounds(n); return { b.getRight(), b.getCentreY() }; }
-    return n.outputPort();
+    const auto b = pluginBounds(n);
+    return { b.getRight(), b.getCentreY() };
 }
 
 Rectangle<int> NodeGraphCanvas::nodeBounds(const PluginNode& n) const
@@ -271,134 +341,29 @@ Rectangle<int> NodeGraphCanvas::nodeBounds(const PluginNode& n) const
                 ++slot;
             }
         }
-        int y = getHeaderHeight() + 6 + slot * (PluginNode::getSideHeight() + 6);
+        int y = getHeaderHeight() + 6 + slot * (getSideHeight() + 6);
         int x = (n.type == NodeType::Input) ? 0 : getWidth() - getZoneWidth();
-        return { x, y, getZoneWidth(), PluginNode::getSideHeight() };
+        return { x, y, getZoneWidth(), getSideHeight() };
     }
-    return n.bounds();
+    return pluginBounds(n);
 }
 
-// ============================================================
-// addNode — visual + audio graph
-// ============================================================
-
-void NodeGraphCanvas::addNode(const String& name, NodeType type)
+Rectangle<int> NodeGraphCanvas::pluginBounds(const PluginNode& n)
 {
-    PluginNode n;
-    n.id   = nextId++;
-    n.type = type;
-    n.name = name;
-
-    // Set position
-    if (type == NodeType::Input)
-    {
-        int cnt = 0;
-        for (const auto& x : nodes) if (x.type == NodeType::Input) ++cnt;
-        n.pos = { 0, getHeaderHeight() + 6 + cnt * (PluginNode::getSideHeight() + 6) };
-        n.graphNodeId = AudioProcessorGraph::NodeID(kInputNodeUID);
-    }
-    else if (type == NodeType::Output)
-    {
-        int cnt = 0;
-        for (const auto& x : nodes) if (x.type == NodeType::Output) ++cnt;
-        n.pos = { getWidth() - getZoneWidth(), getHeaderHeight() + 6 + cnt * (PluginNode::getSideHeight() + 6) };
-        n.graphNodeId = AudioProcessorGraph::NodeID(kOutputNodeUID);
-    }
-    // Plugin nodes are added via showPluginPicker, which sets graphNodeId itself.
-
-    nodes.push_back(n);
-    if (onGraphChanged) onGraphChanged();
-    repaint();
+    return { n.pos.x, n.pos.y, getNodeWidth(), getNodeHeight() };
 }
 
 // ============================================================
-// AudioProcessorGraph helpers
+// addNode — side-panel device node
 // ============================================================
 
-void NodeGraphCanvas::addGraphConnection(const PluginNode& from, const PluginNode& to)
-{
-    // Verify that nodes exist in the graph
-    if (!graph.getNodeForId(from.graphNodeId)) {
-        DBG("WARNING: Source node " << from.graphNodeId.uid << " not found in graph!");
-        return;
-    }
-    if (!graph.getNodeForId(to.graphNodeId)) {
-        DBG("WARNING: Target node " << to.graphNodeId.uid << " not found in graph!");
-        return;
-    }
-    
-    DBG("Adding connection from " << from.graphNodeId.uid << " to " << to.graphNodeId.uid);
-    
-    if (!graph.addConnection({ { from.graphNodeId, 0 }, { to.graphNodeId, 0 } })) {
-        DBG("WARNING: Failed to add connection (channel 0)");
-    }
-    if (!graph.addConnection({ { from.graphNodeId, 1 }, { to.graphNodeId, 1 } })) {
-        DBG("WARNING: Failed to add connection (channel 1)");
-    }
-    
-    graph.rebuild();  // Rebuild the graph topology to apply new connections
-}
-
-void NodeGraphCanvas::removeGraphConnection(const PluginNode& from, const PluginNode& to)
-{
-    graph.removeConnection({ { from.graphNodeId, 0 }, { to.graphNodeId, 0 } });
-    graph.removeConnection({ { from.graphNodeId, 1 }, { to.graphNodeId, 1 } });
-    graph.rebuild();  // Rebuild the graph topology after removing connections
-}
-
-void NodeGraphCanvas::clearGraphInputConnections(const PluginNode& toNode)
+void NodeGraphCanvas::addNode(const String& name, NodeType type)
 {
-    // Remove all existing connections going INTO toNode from the graph
-    for (const auto& w : wires)
-    {
-        if (w.toNode != toNode.id) continue;
-        for (const auto& fn : nodes)
-        {
-            if (fn.id == w.fromNode)
-            {
-                removeGraphConnection(fn, toNode);
-                break;
-            }
-        }
-    }
-    // Remove from wire list
-    wires.erase(std::remove_if(wires.begin(), wires.end(),
-        [&toNode](const NodeWire& w) { return w.toNode == toNode.id; }),
-        wires.end());
-}
+    int cnt = 0;
+    for (const auto& nd : nodes) if (nd.type == type) ++cnt;
 
-void NodeGraphCanvas::disconnectNode(int nodeId)
-{
-    // Disconnect all wires connected to this node (both input and output)
-    std::vector<int> wiresToRemove;
-    
-    for (size_t i = 0; i < wires.size(); ++i)
-    {
-        if (wires[i].fromNode == nodeId || wires[i].toNode == nodeId)
-            wiresToRemove.push_back((int)i);
-    }
-    
-    // Remove wires in reverse order to maintain indices
-    for (int idx = (int)wiresToRemove.size() - 1; idx >= 0; --idx)
-    {
-        const auto& w = wires[wiresToRemove[idx]];
-        
-        // Find the from and to nodes and remove the graph connection
-        const PluginNode *frNode = nullptr, *toNode = nullptr;
-        for (const auto& nd : nodes)
-        {
-            if (nd.id == w.fromNode) frNode = &nd;
-            if (nd.id == w.toNode)   toNode = &nd;
-        }
-        
-        if (frNode && toNode)
-            removeGraphConnection(*frNode, *toNode);
-        
-        wires.erase(wires.begin() + wiresToRemove[idx]);
-    }
-    
-    graph.rebuild();
-    if (onGraphChanged) onGraphChanged();
+    const int x = type == NodeType::Input ? 0 : getWidth() - getZoneWidth();
+    session.addDeviceNode(name, type, { x, getHeaderHeight() + 6 + cnt * (getSideHeight() + 6) });
     repaint();
 }
 
@@ -471,9 +436,21 @@ void NodeGraphCanvas::drawNode(Graphics& g, const PluginNode& n) const
         g.setFont(Font(FontOptions{}.withHeight(12.f * getFontScaleFactor())));
         g.drawText(n.name, textRect, Justification::centredLeft, true);
 
+        // Total graph latency arriving at the output
+        if (!isInput)
+        {
+            const auto it = latencies.find(n.graphNodeId);
+            if (it != latencies.end() && it->second.pathSamples > 0)
+            {
+                g.setColour(NP::nodeHint);
+                g.setFont(Font(FontOptions{}.withHeight(10.f * getFontScaleFactor())));
+                g.drawText(formatLatency(it->second.pathSamples), textRect, Justification::centredRight, false);
+            }
+        }
+
         // Port dot on inner edge
         const auto portPt = isInput ? outputPortPos(n) : inputPortPos(n);
-        const float pr = (float)PluginNode::getPortRadius();
+        const float pr = (float)getPortRadius();
         g.setColour(isInput ? NP::portOut : NP::portIn);
         g.fillEllipse(portPt.x - pr, portPt.y - pr, pr*2, pr*2);
         g.setColour(NP::nodeBorder);
@@ -482,10 +459,10 @@ void NodeGraphCanvas::drawNode(Graphics& g, const PluginNode& n) const
     }
 
     // --- Floating plugin node ---
-    const auto bf = n.bounds().toFloat();
+    const auto bf = pluginBounds(n).toFloat();
     g.setColour(Colour(0x40000000));
     g.fillRoundedRectangle(bf.translated(2, 2), 6.f);
-    g.setColour(NP::nodePlugin);
+    g.setColour(n.bypassed || n.loading ? NP::canvas : NP::nodePlugin);
     g.fillRoundedRectangle(bf, 6.f);
     g.setColour(NP::nodeBorder);
     g.drawRoundedRectangle(bf, 6.f, 1.5f);
@@ -497,35 +474,97 @@ void NodeGraphCanvas::drawNode(Graphics& g, const PluginNode& n) const
         g.drawRoundedRectangle(bf.expanded(2.f), 6.f, 3.f);
     }
 
-    g.setColour(NP::nodeText);
+    g.setColour(n.bypassed || n.loading ? NP::nodeHint : NP::nodeText);
     g.setFont(Font(FontOptions{}.withHeight(12.f * getFontScaleFactor()).withStyle("Bold")));
-    g.drawText(n.name, n.bounds().reduced(PluginNode::getPortRadius() + 4, 0), Justification::centred, true);
+    g.drawText(n.name, pluginBounds(n).reduced(getPortRadius() + 4, 0), Justification::centred, true);
+
+    // Lower half: loading or bypass state, else the load once the renderer has timed the node, else the hint
+    const auto timing = timings.find(n.graphNodeId);
+    const bool hasTiming = timing != timings.end() && timing->second.numBlocks > 0;
+    const Colour loadColour = hasTiming && timing->second.peakLoad >= 0.5 ? NP::wireBad : NP::portIn;
+    const auto lowerHalf = pluginBounds(n).withTrimmedTop(pluginBounds(n).getHeight() / 2 + 2);
 
-    g.setColour(NP::nodeHint);
     g.setFont(Font(FontOptions{}.withHeight(10.f * getFontScaleFactor())));
-    g.drawText(LanguageManager::getInstance().getText("doubleClick"), n.bounds().withTrimmedTop(n.bounds().getHeight() / 2 + 2),
-               Justification::centred, false);
+    if (n.loading)
+    {
+        g.setColour(NP::nodeHint);
+        g.drawText(LanguageManager::getInstance().getText("loadingPlugin"), lowerHalf, Justification::centred, false);
+    }
+    else if (n.bypassed)
+    {
+        g.setColour(NP::portOut);
+        g.drawText(LanguageManager::getInstance().getText("bypassed"), lowerHalf, Justification::centred, false);
+    }
+    else if (hasTiming)
+    {
+        // processBlock time as a share of the buffer period: smoothed / held peak
+        g.setColour(loadColour);
+        g.drawText(String(timing->second.load * 100.0, 1) + "% / " + String(timing->second.peakLoad * 100.0, 1) + "%",
+                   lowerHalf, Justification::centred, false);
+    }
+    else
+    {
+        g.setColour(NP::nodeHint);
+        g.drawText(LanguageManager::getInstance().getText("doubleClick"), lowerHalf, Justification::centred, false);
+    }
+
+    // How long the plugin took to load, so slow plugins stand out
+    if (n.loadMilliseconds > 0.0)
+    {
+        g.setColour(n.loadMilliseconds >= 1000.0 ? NP::portOut : NP::nodeHint);
+        g.setFont(Font(FontOptions{}.withHeight(9.f * getFontScaleFactor())));
+        g.drawText(formatLoadTime(n.loadMilliseconds),
+                   pluginBounds(n).withHeight(pluginBounds(n).getHeight() / 4 + 4).reduced(getPortRadius() + 4, 2),
+                   Justification::centredLeft, false);
+    }
+
+    // Latency: this plugin's own delay, then the total along the longest path up to here
+    const auto latency = latencies.find(n.graphNodeId);
+    if (latency != latencies.end() && latency->second.pathSamples > 0)
+    {
+        const auto text = "+" + formatLatency(latency->second.ownSamples) + " / " + formatLatency(latency->second.pathSamples);
+        g.setColour(latency->second.ownSamples > 0 ? NP::portOut : NP::nodeHint);
+        g.setFont(Font(FontOptions{}.withHeight(9.f * getFontScaleFactor())));
+        g.drawText(text, pluginBounds(n).withHeight(pluginBounds(n).getHeight() / 4 + 4).reduced(getPortRadius() + 4, 2),
+                   Justification::centredRight, false);
+    }
+
+    // Load bar with a tick at the held peak
+    if (hasTiming && !n.bypassed)
+    {
+        const auto bar = bf.reduced(8.f, 0.f).withTop(bf.getBottom() - 6.f).withHeight(3.f);
+        g.setColour(NP::zoneBg);
+        g.fillRect(bar);
+        g.setColour(loadColour);
+        g.fillRect(bar.withWidth(bar.getWidth() * (float)jlimit(0.0, 1.0, timing->second.load)));
+        g.fillRect(bar.getX() + bar.getWidth() * (float)jlimit(0.0, 1.0, timing->second.peakLoad) - 1.f, bar.getY(), 2.f, bar.getHeight());
+    }
 
     auto drawPort = [&](Point<int> pt, Colour col)
     {
-        const float pr = (float)PluginNode::getPortRadius();
+        const float pr = (float)getPortRadius();
         g.setColour(col);
         g.fillEllipse(pt.x - pr, pt.y - pr, pr*2, pr*2);
         g.setColour(NP::nodeBorder);
         g.drawEllipse(pt.x - pr, pt.y - pr, pr*2, pr*2, 1.f);
     };
-    drawPort(n.inputPort(),  NP::portIn);
-    drawPort(n.outputPort(), NP::portOut);
+    drawPort(inputPortPos(n),  NP::portIn);
+    drawPort(outputPortPos(n), NP::portOut);
 }
 
-void NodeGraphCanvas::drawWire(Graphics& g, Point<int> a, Point<int> b, bool active) const
+Path NodeGraphCanvas::makeWirePath(Point<int> a, Point<int> b)
 {
-    g.setColour(active ? NP::wireActive : NP::wireCol);
     Path p;
     p.startNewSubPath(a.toFloat());
     const float cx = (a.x + b.x) * 0.5f;
     p.cubicTo(cx, (float)a.y, cx, (float)b.y, (float)b.x, (float)b.y);
-    g.strokePath(p, PathStrokeType(2.f));
+    return p;
+}
+
+void NodeGraphCanvas::drawWire(Graphics& g, Point<int> a, Point<int> b, bool active) const
+{
+    g.setColour(active ? NP::wireActive : NP::wireCol);
+    g.strokePath(makeWirePath(a, b), PathStrokeType(2.f));
 }
 
 void NodeGraphCanvas::paint(Graphics& g)
@@ -547,7 +586,29 @@ void NodeGraphCanvas::paint(Graphics& g)
             if (nd.id == wire.fromNode) fr = &nd;
             if (nd.id == wire.toNode)   to = &nd;
         }
-        if (fr && to) drawWire(g, outputPortPos(*fr), inputPortPos(*to), false);
+        if (!fr || !to) continue;
+
+        const auto a = outputPortPos(*fr), b = inputPortPos(*to);
+        drawWire(g, a, b, false);
+
+        // Label anything but a unity-gain stereo pair at the wire's midpoint
+        if (!wire.channels.isStereo() || wire.gainDecibels != 0.f)
+        {
+            const Font font(FontOptions{}.withHeight(9.f * getFontScaleFactor()));
+            StringArray parts;
+            if (!wire.channels.isStereo()) parts.add(wire.channels.describe());
+            if (wire.gainDecibels != 0.f)  parts.add(formatWireGain(wire.gainDecibels));
+            const auto text = parts.joinIntoString("  ");
+            const auto label = Rectangle<float>(GlyphArrangement::getStringWidth(font, text) + 8.f, font.getHeight() + 4.f)
+                                   .withCentre(((a + b) / 2).toFloat());
+            g.setColour(NP::canvas);
+            g.fillRoundedRectangle(label, 3.f);
+            g.setColour(NP::wireCol);
+            g.drawRoundedRectangle(label, 3.f, 1.f);
+            g.setColour(NP::rowText);
+            g.setFont(font);
+            g.drawText(text, label, Justification::centred, false);
+        }
     }
 
     // Live drag
@@ -562,20 +623,15 @@ void NodeGraphCanvas::paint(Graphics& g)
             if (!wireDragFromInput)
             {
                 anchor = outputPortPos(nd);
-                valid  = nearInputPort(wireCursor, dummy) && isValidWire(wireFrom, dummy);
+                valid  = nearInputPort(wireCursor, dummy) && session.canConnect(wireFrom, dummy);
             }
             else
             {
                 anchor = inputPortPos(nd);
-                valid  = nearOutputPort(wireCursor, dummy) && isValidWire(dummy, wireFrom);
+                valid  = nearOutputPort(wireCursor, dummy) && session.canConnect(dummy, wireFrom);
             }
             g.setColour(valid ? NP::wireActive : NP::wireBad);
-            Path p;
-            const float cx = (anchor.x + wireCursor.x) * 0.5f;
-            p.startNewSubPath(anchor.toFloat());
-            p.cubicTo(cx, (float)anchor.y, cx, (float)wireCursor.y,
-                      (float)wireCursor.x, (float)wireCursor.y);
-            g.strokePath(p, PathStrokeType(2.f));
+            g.strokePath(makeWirePath(anchor, wireCursor), PathStrokeType(2.f));
             break;
         }
     }
@@ -607,7 +663,7 @@ int NodeGraphCanvas::nodeAtPoint(Point<int> p) const
 
 bool NodeGraphCanvas::nearOutputPort(Point<int> p, int& outId) const
 {
-    const int kSnap = PluginNode::getPortRadius() + 6;
+    const int kSnap = getPortRadius() + 6;
     for (const auto& nd : nodes)
         if (nd.hasOutputPort() && outputPortPos(nd).getDistanceFrom(p) <= kSnap)
         { outId = nd.id; return true; }
@@ -616,27 +672,32 @@ bool NodeGraphCanvas::nearOutputPort(Point<int> p, int& outId) const
 
 bool NodeGraphCanvas::nearInputPort(Point<int> p, int& outId) const
 {
-    const int kSnap = PluginNode::getPortRadius() + 6;
+    const int kSnap = getPortRadius() + 6;
     for (const auto& nd : nodes)
         if (nd.hasInputPort() && inputPortPos(nd).getDistanceFrom(p) <= kSnap)
         { outId = nd.id; return true; }
     return false;
 }
 
-bool NodeGraphCanvas::isValidWire(int fromId, int toId) const
+int NodeGraphCanvas::wireAtPoint(Point<int> p) const
 {
-    if (fromId == toId) return false;
-    const PluginNode *fr = nullptr, *to = nullptr;
-    for (const auto& nd : nodes)
+    const float kSnap = 6.f * getDPIScaleFactor();
+    for (int i = (int)wires.size() - 1; i >= 0; --i)
     {
-        if (nd.id == fromId) fr = &nd;
-        if (nd.id == toId)   to = &nd;
+        const PluginNode *fr = nullptr, *to = nullptr;
+        for (const auto& nd : nodes)
+        {
+            if (nd.id == wires[(size_t)i].fromNode) fr = &nd;
+            if (nd.id == wires[(size_t)i].toNode)   to = &nd;
+        }
+        if (!fr || !to) continue;
+
+        Point<float> nearest;
+        makeWirePath(outputPortPos(*fr), inputPortPos(*to)).getNearestPoint(p.toFloat(), nearest);
+        if (nearest.getDistanceFrom(p.toFloat()) <= kSnap)
+            return i;
     }
-    if (!fr || !to) return false;
-    if (!fr->hasOutputPort() || !to->hasInputPort())                         return false;
-    if (fr->type == NodeType::Input  && to->type == NodeType::Input)         return false;
-    if (fr->type == NodeType::Output && to->type == NodeType::Output)        return false;
-    return true;
+    return -1;
 }
 
 // ============================================================
@@ -712,22 +773,28 @@ void NodeGraphCanvas::mouseDown(const MouseEvent& e)
                 }
                 else if (nd.type == NodeType::Plugin)
                 {
-                    // Plugin node: New Plugin, Disconnect, Delete
+                    // Plugin node: New Plugin, Bypass, Disconnect, Delete
                     PopupMenu m;
                     m.addItem(1, LanguageManager::getInstance().getText("addPlugin"));
+                    m.addItem(4, LanguageManager::getInstance().getText("bypass"), true, nd.bypassed);
                     m.addItem(2, LanguageManager::getInstance().getText("disconnectAllWires"));
                     m.addSeparator();
                     m.addItem(3, LanguageManager::getInstance().getText("delete"));
                     m.showMenuAsync(PopupMenu::Options().withTargetScreenArea({screenPos.x, screenPos.y, 1, 1}),
-                        [this, hitNode, ePos = e.getPosition()](int result) {
+                        [this, hitNode, bypassed = nd.bypassed, ePos = e.getPosition()](int result) {
                             if (result == 1) showPluginPicker(ePos);
                             else if (result == 2) disconnectNode(hitNode);
                             else if (result == 3) removeNode(hitNode);
+                            else if (result == 4) setNodeBypassed(hitNode, !bypassed);
                         });
                 }
                 return;
             }
         }
+        else if (const int hitWire = wireAtPoint(e.getPosition()); hitWire >= 0)
+        {
+            showWireMenu(hitWire, screenPos);
+        }
         else
         {
             // Right-click on empty area
@@ -799,22 +866,13 @@ void NodeGraphCanvas::mouseDrag(const MouseEvent& e)
     if (draggingWire) { wireCursor = e.getPosition(); repaint(); return; }
     if (draggingNode >= 0)
     {
-        for (auto& nd : nodes)
-        {
-            if (nd.id != draggingNode) continue;
-            const int lo = getZoneWidth();
-            const int hi = getWidth() - getZoneWidth() - PluginNode::getWidth();
-            
-            auto newPos = Point<int>(std::max(lo, std::min(hi, e.x - PluginNode::getWidth() / 2)),
-                                     std::max(0,  std::min(getHeight() - PluginNode::getHeight(), e.y - PluginNode::getHeight() / 2)));
-            if (nd.pos != newPos)
-            {
-                nd.pos = newPos;
-                if (onGraphChanged) onGraphChanged();
-                repaint();
-            }
-            break;
-        }
+        const int lo = getZoneWidth();
+        const int hi = getWidth() - getZoneWidth() - getNodeWidth();
+
+        session.setNodePosition(draggingNode,
+                                { std::max(lo, std::min(hi, e.x - getNodeWidth() / 2)),
+                                  std::max(0,  std::min(getHeight() - getNodeHeight(), e.y - getNodeHeight() / 2)) });
+        repaint();
     }
 }
 
@@ -822,47 +880,17 @@ void NodeGraphCanvas::mouseUp(const MouseEvent& e)
 {
     if (draggingWire && wireFrom >= 0)
     {
+        // Fan-in is allowed: the graph sums every wire into the port
         int target = -1;
         if (!wireDragFromInput)
         {
-            if (nearInputPort(e.getPosition(), target) && isValidWire(wireFrom, target))
-            {
-                // Find from/to nodes
-                const PluginNode *frNode = nullptr, *toNode = nullptr;
-                for (const auto& nd : nodes)
-                {
-                    if (nd.id == wireFrom) frNode = &nd;
-                    if (nd.id == target)   toNode = &nd;
-                }
-                if (frNode && toNode)
-                {
-                    DBG("Wire connection: " << frNode->name << " -> " << toNode->name);
-                    clearGraphInputConnections(*toNode);   // remove old wires (visual+audio)
-                    addGraphConnection(*frNode, *toNode);  // add new audio connection
-                    wires.push_back({ wireFrom, target }); // add visual wire
-                    if (onGraphChanged) onGraphChanged();
-                }
-            }
+            if (nearInputPort(e.getPosition(), target))
+                session.addWire(wireFrom, target);
         }
         else
         {
-            if (nearOutputPort(e.getPosition(), target) && isValidWire(target, wireFrom))
-            {
-                const PluginNode *frNode = nullptr, *toNode = nullptr;
-                for (const auto& nd : nodes)
-                {
-                    if (nd.id == target)   frNode = &nd;
-                    if (nd.id == wireFrom) toNode = &nd;
-                }
-                if (frNode && toNode)
-                {
-                    DBG("Wire connection: " << frNode->name << " -> " << toNode->name);
-                    clearGraphInputConnections(*toNode);
-                    addGraphConnection(*frNode, *toNode);
-                    wires.push_back({ target, wireFrom });
-                    if (onGraphChanged) onGraphChanged();
-                }
-            }
+            if (nearOutputPort(e.getPosition(), target))
+                session.addWire(target, wireFrom);
         }
     }
     draggingWire      = false;
@@ -879,7 +907,7 @@ void NodeGraphCanvas::mouseUp(const MouseEvent& e)
 void NodeGraphCanvas::showPluginPicker(Point<int> canvasPos)
 {
     PopupMenu m;
-    auto types = knownPlugins.getTypes();
+    auto types = session.getKnownPlugins().getTypes();
     if (!types.isEmpty())
     {
         m.addSectionHeader(LanguageManager::getInstance().getText("availablePlugins"));
@@ -899,52 +927,20 @@ void NodeGraphCanvas::showPluginPicker(Point<int> canvasPos)
 
             const auto& desc = types[result - 1];
 
-            String err;
-            double sr = 44100.0;
-            int    bs = 512;
-            if (auto* dev = deviceManager.getCurrentAudioDevice())
-            {
-                sr = dev->getCurrentSampleRate();
-                bs = dev->getCurrentBufferSizeSamples();
-            }
-
-            auto instance = formatManager.createPluginInstance(desc, sr, bs, err);
-            if (!instance)
-            {
-                AlertWindow::showMessageBoxAsync(MessageBoxIconType::WarningIcon,
-                    LanguageManager::getInstance().getText("cannotLoadPlugin"), err.isEmpty() ? LanguageManager::getInstance().getText("unknownError") : err);
-                return;
-            }
-            instance->prepareToPlay(sr, bs);
-
-            // addNode() returns Node::Ptr (ReferenceCountedObjectPtr), not Node*
-            auto nodePtr = graph.addNode(
-                std::unique_ptr<AudioProcessor>(std::move(instance)));
-            if (!nodePtr) return;
-            
-            // Add parameter change listener so we save when plugin params change
-            if (auto* proc = nodePtr->getProcessor())
-            {
-                auto listener = std::make_unique<PluginParameterListener>(
-                    [this] { if (onGraphChanged) onGraphChanged(); });
-                proc->addListener(listener.get());
-                // Store the listener in global map to keep it alive
-                g_pluginListeners[nodePtr->nodeID.uid] = std::move(listener);
-            }
-
-            PluginNode n;
-            n.id          = nextId++;
-            n.type        = NodeType::Plugin;
-            n.name        = desc.name;
-            n.graphNodeId = nodePtr->nodeID;
-
-            const int cx = (getWidth() - getZoneWidth() * 2) / 2 + getZoneWidth() - PluginNode::getWidth() / 2;
+            const int cx = (getWidth() - getZoneWidth() * 2) / 2 + getZoneWidth() - getNodeWidth() / 2;
             int cnt = 0;
             for (const auto& x : nodes) if (x.type == NodeType::Plugin) ++cnt;
-            n.pos = { cx, 60 + cnt * (PluginNode::getHeight() + 20) };
 
-            nodes.push_back(n);
-            if (onGraphChanged) onGraphChanged();
+            // The placeholder shows up right away; heavy plugins no longer freeze the canvas while the menu closes
+            session.addPluginAsync(desc, { cx, 60 + cnt * (getNodeHeight() + 20) },
+                [safeThis = Component::SafePointer<NodeGraphCanvas>(this)](int, const String& err)
+                {
+                    if (err.isNotEmpty())
+                        AlertWindow::showMessageBoxAsync(MessageBoxIconType::WarningIcon,
+                            LanguageManager::getInstance().getText("cannotLoadPlugin"), err);
+                    if (safeThis != nullptr)
+                        safeThis->repaint();
+                });
             repaint();
         });
 }
@@ -960,7 +956,7 @@ void NodeGraphCanvas::openPluginEditor(int nodeId)
         if (nd.id == nodeId) { cn = &nd; break; }
     if (!cn || cn->type != NodeType::Plugin) return;
 
-    auto* graphNode = graph.getNodeForId(cn->graphNodeId);
+    auto* graphNode = session.getGraph().getNodeForId(cn->graphNodeId);
     if (!graphNode) return;
 
     // Open the plugin editor (Normal if available, otherwise Generic)
@@ -973,37 +969,152 @@ void NodeGraphCanvas::openPluginEditor(int nodeId)
 
 void NodeGraphCanvas::removeNode(int nodeId)
 {
-    // Allow removing all node types (Plugin, Input, Output)
+    // A removed plugin may live on in the instance cache: its editor has to go now
     for (const auto& nd : nodes)
+        if (nd.id == nodeId && nd.type == NodeType::Plugin && nd.graphNodeId.uid != 0)
+            PluginWindow::closeCurrentlyOpenWindowsFor(nd.graphNodeId.uid);
+
+    session.removeNode(nodeId);
+    if (selectedNode == nodeId)
+        selectedNode = -1;
+    repaint();
+}
+
+void NodeGraphCanvas::disconnectNode(int nodeId)
+{
+    session.disconnectNode(nodeId);
+    repaint();
+}
+
+// ============================================================
+// Bypass
+// ============================================================
+
+void NodeGraphCanvas::setNodeBypassed(int nodeId, bool shouldBeBypassed)
+{
+    session.setNodeBypassed(nodeId, shouldBeBypassed);
+    repaint();
+}
+
+// ============================================================
+// Wire channel maps
+// ============================================================
+
+void NodeGraphCanvas::showWireMenu(int wireIndex, Point<int> screenPos)
+{
+    const auto w = wires[(size_t)wireIndex];
+    const PluginNode *fr = nullptr, *to = nullptr;
+    for (const auto& nd : nodes)
+    {
+        if (nd.id == w.fromNode) fr = &nd;
+        if (nd.id == w.toNode)   to = &nd;
+    }
+    if (!fr || !to) return;
+
+    const int numSources      = session.getMaxWireChannels(*fr);
+    const int numDestinations = session.getMaxWireChannels(*to);
+
+    // Menu item i (1-based) applies presets[i - 1]
+    std::vector<WireChannelMap> presets;
+    PopupMenu m;
+    m.addSectionHeader(LanguageManager::getInstance().getText("wireChannels") + ": " + w.channels.describe());
+    auto addPreset = [&](const String& label, WireChannelMap map)
     {
-        if (nd.id == nodeId)
+        const bool current = map == w.channels;
+        presets.push_back(std::move(map));
+        m.addItem((int)presets.size(), label, true, current);
+    };
+
+    // Every stereo pair of the source onto every stereo pair of the destination
+    for (int src = 0; src + 1 < numSources; src += 2)
+        for (int dst = 0; dst + 1 < numDestinations; dst += 2)
         {
-            // Remove from audio graph if it's in the graph
-            if (nd.graphNodeId != AudioProcessorGraph::NodeID(0))
-            {
-                // Clean up the listener
-                g_pluginListeners.erase(nd.graphNodeId.uid);
-                if (auto* graphNode = graph.getNodeForId(nd.graphNodeId))
-                    graph.removeNode(graphNode);
-            }
-            
-            // Remove from visual nodes
-            nodes.erase(std::remove_if(nodes.begin(), nodes.end(),
-                [nodeId](const PluginNode& n) { return n.id == nodeId; }),
-                nodes.end());
-            
-            // Remove wires connected to this node
-            wires.erase(std::remove_if(wires.begin(), wires.end(),
-                [nodeId](const NodeWire& w) { return w.fromNode == nodeId || w.toNode == nodeId; }),
-                wires.end());
-            
-            selectedNode = -1;
-            graph.rebuild();  // Rebuild graph after removing node
-            if (onGraphChanged) onGraphChanged();
-            repaint();
-            return;
+            auto map = WireChannelMap::straight(src, dst, 2);
+            addPreset(map.describe(), std::move(map));
         }
+
+    const int numAll = jmin(numSources, numDestinations);
+    if (numAll > 2)
+        addPreset(LanguageManager::getInstance().getText("allChannels") + " (" + String(numAll) + ")",
+                  WireChannelMap::straight(0, 0, numAll));
+
+    constexpr int kCustom = 100000;
+    m.addSeparator();
+    m.addItem(kCustom, LanguageManager::getInstance().getText("customChannels"));
+
+    // Gain presets; item kGainBase + i applies kGains[i]
+    constexpr int kGainBase = 200000;
+    static constexpr float kGains[] = { 6.f, 3.f, 0.f, -3.f, -6.f, -10.f, -20.f, NodeWire::minusInfinityDb };
+    PopupMenu gainMenu;
+    for (int i = 0; i < (int)std::size(kGains); ++i)
+    {
+        const auto label = kGains[i] <= NodeWire::minusInfinityDb
+            ? LanguageManager::getInstance().getText("mute")
+            : Decibels::toString(kGains[i], 0);
+        gainMenu.addItem(kGainBase + i, label, true, kGains[i] == w.gainDecibels);
     }
+    m.addSubMenu(LanguageManager::getInstance().getText("wireGain") + ": " + formatWireGain(w.gainDecibels), gainMenu);
+
+    constexpr int kDelete = 300000;
+    m.addSeparator();
+    m.addItem(kDelete, LanguageManager::getInstance().getText("deleteWire"));
+
+    m.showMenuAsync(PopupMenu::Options().withTargetScreenArea({screenPos.x, screenPos.y, 1, 1}),
+        [this, presets, fromNode = w.fromNode, toNode = w.toNode](int result) {
+            if (result == kCustom) showCustomChannelsDialog(fromNode, toNode);
+            else if (result == kDelete) removeWire(fromNode, toNode);
+            else if (result >= kGainBase && result < kGainBase + (int)std::size(kGains)) setWireGain(fromNode, toNode, kGains[result - kGainBase]);
+            else if (result > 0 && result <= (int)presets.size()) setWireChannels(fromNode, toNode, presets[(size_t)result - 1]);
+        });
+}
+
+void NodeGraphCanvas::showCustomChannelsDialog(int fromNode, int toNode)
+{
+    WireChannelMap current;
+    for (const auto& w : wires)
+        if (w.fromNode == fromNode && w.toNode == toNode) current = w.channels;
+    if (current.isEmpty()) return;
+
+    auto* dialog = new AlertWindow(LanguageManager::getInstance().getText("wireChannels"),
+                                   LanguageManager::getInstance().getText("customChannelsHint"),
+                                   MessageBoxIconType::NoIcon, this);
+    dialog->addTextEditor("channels", current.describe());
+    dialog->addButton(TRANS("OK"), 1, KeyPress(KeyPress::returnKey));
+    dialog->addButton(TRANS("Cancel"), 0, KeyPress(KeyPress::escapeKey));
+
+    Component::SafePointer<NodeGraphCanvas> safeThis(this);
+    dialog->enterModalState(true, ModalCallbackFunction::create([safeThis, dialog, fromNode, toNode](int result)
+    {
+        if (result != 1 || safeThis == nullptr) return;
+
+        const auto map = WireChannelMap::parseDescription(dialog->getTextEditorContents("channels"));
+        if (map.isEmpty())
+        {
+            AlertWindow::showMessageBoxAsync(MessageBoxIconType::WarningIcon,
+                LanguageManager::getInstance().getText("wireChannels"),
+                LanguageManager::getInstance().getText("invalidChannelMap"));
+            return;
+        }
+        safeThis->setWireChannels(fromNode, toNode, map);
+    }), true);
+}
+
+void NodeGraphCanvas::setWireChannels(int fromNode, int toNode, const WireChannelMap& channels)
+{
+    session.setWireChannels(fromNode, toNode, channels);
+    repaint();
+}
+
+void NodeGraphCanvas::setWireGain(int fromNode, int toNode, float gainDecibels)
+{
+    session.setWireGain(fromNode, toNode, gainDecibels);
+    repaint();
+}
+
+void NodeGraphCanvas::removeWire(int fromNode, int toNode)
+{
+    session.removeWire(fromNode, toNode);
+    repaint();
 }
 
 // ============================================================
@@ -1017,23 +1128,181 @@ bool NodeGraphCanvas::keyPressed(const KeyPress& key)
         removeNode(selectedNode);
         return true;
     }
+    if (key == KeyPress('z', ModifierKeys::commandModifier, 0) && session.canUndoRemoveNode())
+    {
+        String error;
+        const int nodeId = session.undoRemoveNode(error);
+        if (nodeId < 0)
+            AlertWindow::showMessageBoxAsync(MessageBoxIconType::WarningIcon,
+                LanguageManager::getInstance().getText("cannotLoadPlugin"), error);
+        else
+            selectedNode = nodeId;
+        repaint();
+        return true;
+    }
+    if (key.isKeyCode('B') && selectedNode >= 0)
+    {
+        for (const auto& nd : nodes)
+            if (nd.id == selectedNode && nd.type == NodeType::Plugin)
+            {
+                setNodeBypassed(nd.id, !nd.bypassed);
+                return true;
+            }
+    }
     return false;
 }
 
+// ============================================================
+// DeadlineStrip
+// ============================================================
+
+DeadlineStrip::DeadlineStrip(AudioDeviceManager& dm)
+    : deviceManager(dm),
+      resetBtn(LanguageManager::getInstance().getText("resetStats")),
+      saveBtn (LanguageManager::getInstance().getText("saveReport")),
+      timingCsvBtn(LanguageManager::getInstance().getText("nodeTimingCsv"))
+{
+    resetBtn.onClick = [this]
+    {
+        if (auto* monitor = getMonitor())
+            monitor->reset();
+    };
+    saveBtn.onClick = [this] { saveReport(); };
+    timingCsvBtn.onClick = [this] { saveNodeTimings(); };
+    addAndMakeVisible(resetBtn);
+    addAndMakeVisible(saveBtn);
+    addAndMakeVisible(timingCsvBtn);
+
+    startTimer(500);
+}
+
+DeadlineMonitor* DeadlineStrip::getMonitor() const
+{
+    if (auto* device = dynamic_cast<VoicemeeterAudioIODevice*>(deviceManager.getCurrentAudioDevice()))
+        return &device->getDeadlineMonitor();
+    return nullptr;
+}
+
+void DeadlineStrip::timerCallback()
+{
+    auto* device = dynamic_cast<VoicemeeterAudioIODevice*>(deviceManager.getCurrentAudioDevice());
+    hasMonitor = device != nullptr;
+    snapshot = hasMonitor ? device->getDeadlineMonitor().getSnapshot() : DeadlineMonitor::Snapshot{};
+
+    const auto reconnect = hasMonitor ? device->getReconnectStats() : VoicemeeterAudioIODevice::ReconnectStats{};
+    numReconnects = reconnect.numReconnects;
+    lastGapMs = reconnect.lastGapMilliseconds;
+    repaint();
+}
+
+void DeadlineStrip::resized()
+{
+    const int btnW = static_cast<int>(60 * getDPIScaleFactor());
+    auto r = getLocalBounds().reduced(2);
+    timingCsvBtn.setBounds(r.removeFromRight(btnW));
+    r.removeFromRight(2);
+    saveBtn.setBounds(r.removeFromRight(btnW));
+    r.removeFromRight(2);
+    resetBtn.setBounds(r.removeFromRight(btnW));
+}
+
+void DeadlineStrip::paint(Graphics& g)
+{
+    auto r = getLocalBounds();
+    g.setColour(NP::zoneHeader);
+    g.fillRect(r);
+    g.setColour(NP::zoneBorder);
+    g.drawRect(r, 1);
+
+    r.removeFromRight(static_cast<int>(186 * getDPIScaleFactor()));
+    r = r.reduced(6, 2);
+
+    auto& lang = LanguageManager::getInstance();
+    g.setFont(Font(FontOptions{}.withHeight(12.0f * getFontScaleFactor())));
+
+    if (!hasMonitor || snapshot.numBuffers == 0)
+    {
+        g.setColour(NP::nodeHint);
+        g.drawText(lang.getText("deadlineNoData"), r, Justification::centredLeft, true);
+        return;
+    }
+
+    // Histogram of the 0..100% range; everything beyond lands in the last column
+    auto histArea = r.removeFromRight(jmin(r.getWidth() / 3, static_cast<int>(120 * getDPIScaleFactor())));
+    const int columns = jmax(1, histArea.getWidth() / 2);
+    const int binsPerColumn = jmax(1, (int)std::ceil(1.0 / DeadlineMonitor::binWidth / columns));
+    std::vector<uint64> counts((size_t)columns, 0);
+    for (int i = 0; i < DeadlineMonitor::numBins; ++i)
+        counts[(size_t)jmin(columns - 1, i / binsPerColumn)] += snapshot.bins[(size_t)i];
+
+    const auto peak = *std::max_element(counts.begin(), counts.end());
+    g.setColour(NP::zoneBg);
+    g.fillRect(histArea);
+    for (int c = 0; c < columns && peak > 0; ++c)
+    {
+        // Log scale so the rare slow buffers stay visible next to the bulk
+        const float h = (float)(std::log1p((double)counts[(size_t)c]) / std::log1p((double)peak)) * (float)histArea.getHeight();
+        g.setColour(c == columns - 1 ? NP::wireBad : NP::portIn);
+        g.fillRect((float)(histArea.getX() + c * 2), (float)histArea.getBottom() - h, 2.0f, h);
+    }
+
+    auto percent = [](double load) { return String(load * 100.0, 1) + "%"; };
+    const String text = lang.getText("deadlineLoad") + ": "
+                      + percent(snapshot.meanLoad) + " / p99 " + percent(snapshot.p99Load)
+                      + " / p99.9 " + percent(snapshot.p999Load) + " / max " + percent(snapshot.maxLoad)
+                      + "   " + lang.getText("overruns") + ": "
+                      + String((int64)snapshot.numOverruns) + " / " + String((int64)snapshot.numBuffers)
+                      + (numReconnects > 0 ? "   " + lang.getText("reconnects") + ": " + String(numReconnects)
+                                                 + " (" + String(lastGapMs, 0) + " ms)"
+                                           : String());
+
+    g.setColour(snapshot.numOverruns > 0 ? NP::wireBad : NP::rowText);
+    g.drawText(text, r.withTrimmedRight(6), Justification::centredLeft, true);
+}
+
+void DeadlineStrip::saveReport()
+{
+    auto* device = deviceManager.getCurrentAudioDevice();
+    auto* monitor = getMonitor();
+    if (device == nullptr || monitor == nullptr)
+        return;
+
+    saveTextFile("LightHost-deadline.txt", monitor->createReport(device->getName()));
+}
+
+void DeadlineStrip::saveNodeTimings()
+{
+    if (createNodeTimingCsv != nullptr)
+        saveTextFile("LightHost-node-timing.csv", createNodeTimingCsv());
+}
+
+void DeadlineStrip::saveTextFile(const String& defaultName, const String& text)
+{
+    fileChooser = std::make_unique<FileChooser>(LanguageManager::getInstance().getText("saveReport"),
+        File::getSpecialLocation(File::userDocumentsDirectory).getChildFile(defaultName),
+        "*.txt;*.csv");
+    fileChooser->launchAsync(FileBrowserComponent::saveMode | FileBrowserComponent::canSelectFiles
+                                 | FileBrowserComponent::warnAboutOverwriting,
+        [text](const FileChooser& chooser)
+        {
+            const auto file = chooser.getResult();
+            if (file != File())
+                file.replaceWithText(text);
+        });
+}
+
 // ============================================================
 // MainWindowContent
 // ============================================================
 
-MainWindowContent::MainWindowContent(AudioDeviceManager&      dm,
-                                     KnownPluginList&          kpl,
-                                     AudioPluginFormatManager& fmt,
-                                     AudioProcessorGraph&      g)
-    : deviceManager(dm), knownPlugins(kpl), formatManager(fmt), graph(g)
+MainWindowContent::MainWindowContent(LightHostEngine& e)
+    : engine(e)
 {
     // Load scale settings from ApplicationProperties
     ScaleSettingsManager::getInstance().loadSettings();
     
-    graphCanvas = std::make_unique<NodeGraphCanvas>(dm, kpl, fmt, g);
+    graphCanvas = std::make_unique<NodeGraphCanvas>(engine.getSession(), engine.getDeviceManager(),
+                                                    engine.getRenderer().getTimingMonitor());
 
     graphCanvas->onDoubleClickLeft  = [this] { showInputDialog();  };
     graphCanvas->onDoubleClickRight = [this] { showOutputDialog(); };
@@ -1044,12 +1313,12 @@ MainWindowContent::MainWindowContent(AudioDeviceManager&      dm,
             type == NodeType::Input 
                 ? LanguageManager::getInstance().getText("audioInput")
                 : LanguageManager::getInstance().getText("audioOutput"),
-            deviceManager,
+            engine.getDeviceManager(),
             type == NodeType::Input ? 256 : 0,
             type == NodeType::Output ? 256 : 0,
             [this](const String&) { 
                 // Save audio device configuration when editing device settings
-                std::unique_ptr<XmlElement> audioState(deviceManager.createStateXml());
+                std::unique_ptr<XmlElement> audioState(engine.getDeviceManager().createStateXml());
                 getAppProperties().getUserSettings()->setValue("audioDeviceState", audioState.get());
                 getAppProperties().saveIfNeeded();
             });
@@ -1067,17 +1336,24 @@ MainWindowContent::MainWindowContent(AudioDeviceManager&      dm,
     settingsBtn->onClick = [this] { showScaleSettings(); };
     settingsBtn->setBounds(8, 8, 70, 28);  // Initial bounds
     addAndMakeVisible(*settingsBtn);
+
+    deadlineStrip = std::make_unique<DeadlineStrip>(engine.getDeviceManager());
+    deadlineStrip->createNodeTimingCsv = [this]
+    {
+        return engine.getRenderer().getTimingMonitor().createCsv([this](uint32 uid) { return graphCanvas->getGraphNodeLabel(AudioProcessorGraph::NodeID(uid)); });
+    };
+    addAndMakeVisible(*deadlineStrip);
 }
 
 void MainWindowContent::showInputDialog()
 {
     auto* wnd = new DeviceSelectorWindow(
         LanguageManager::getInstance().getText("audioInput"),
-        deviceManager, 256, 0,
+        engine.getDeviceManager(), 256, 0,
         [this](const String& name) { 
             graphCanvas->addNode(name, NodeType::Input);
             // Save audio device configuration
-            std::unique_ptr<XmlElement> audioState(deviceManager.createStateXml());
+            std::unique_ptr<XmlElement> audioState(engine.getDeviceManager().createStateXml());
             getAppProperties().getUserSettings()->setValue("audioDeviceState", audioState.get());
             getAppProperties().saveIfNeeded();
         });
@@ -1090,11 +1366,11 @@ void MainWindowContent::showOutputDialog()
 {
     auto* wnd = new DeviceSelectorWindow(
         LanguageManager::getInstance().getText("audioOutput"),
-        deviceManager, 0, 256,
+        engine.getDeviceManager(), 0, 256,
         [this](const String& name) { 
             graphCanvas->addNode(name, NodeType::Output);
             // Save audio device configuration
-            std::unique_ptr<XmlElement> audioState(deviceManager.createStateXml());
+            std::unique_ptr<XmlElement> audioState(engine.getDeviceManager().createStateXml());
             getAppProperties().getUserSettings()->setValue("audioDeviceState", audioState.get());
             getAppProperties().saveIfNeeded();
         });
@@ -1144,196 +1420,20 @@ void MainWindowContent::resized()
     // Settings button at bottom-left (positioned after canvas so it's in front)
     int bottomY = getHeight() - btnHeight - padding;
     settingsBtn->setBounds(padding, bottomY, btnWidth, btnHeight);
-}
-
-std::unique_ptr<XmlElement> NodeGraphCanvas::saveState() const
-{
-    auto xml = std::make_unique<XmlElement>("NodeGraph");
-    auto* xNodes = new XmlElement("Nodes");
-    xml->addChildElement(xNodes);
-
-    for (const auto& n : nodes)
-    {
-        auto* xn = new XmlElement("Node");
-        xn->setAttribute("id", n.id);
-        xn->setAttribute("type", static_cast<int>(n.type));
-        xn->setAttribute("name", n.name);
-        xn->setAttribute("x", n.pos.x);
-        xn->setAttribute("y", n.pos.y);
-
-        if (n.type == NodeType::Plugin)
-        {
-            if (auto* gNode = graph.getNodeForId(n.graphNodeId))
-            {
-                if (auto* proc = gNode->getProcessor())
-                {
-                    PluginDescription desc;
-                    if (auto* pi = dynamic_cast<AudioPluginInstance*>(proc))
-                        pi->fillInPluginDescription(desc);
-                    xn->setAttribute("pluginName", desc.name);
-                    xn->setAttribute("pluginFormat", desc.pluginFormatName);
-                    xn->setAttribute("pluginFileOrIdentifier", desc.fileOrIdentifier);
-
-                    MemoryBlock mb;
-                    proc->getStateInformation(mb);
-                    auto* stateXml = new XmlElement("PluginState");
-                    stateXml->addTextElement(mb.toBase64Encoding());
-                    xn->addChildElement(stateXml);
-                }
-            }
-        }
-        xNodes->addChildElement(xn);
-    }
-
-    auto* xWires = new XmlElement("Wires");
-    xml->addChildElement(xWires);
-    for (const auto& w : wires)
-    {
-        auto* xw = new XmlElement("Wire");
-        xw->setAttribute("from", w.fromNode);
-        xw->setAttribute("to", w.toNode);
-        xWires->addChildElement(xw);
-    }
-
-    return xml;
-}
-
-void NodeGraphCanvas::loadState(const XmlElement& xml)
-{
-    // IMPORTANT: Do NOT call graph.clear() here!
-    // The INPUT/OUTPUT nodes (UIDs 1000000-1000001) must remain in the graph
-    // IconMenu's loadActivePlugins() already created them and we depend on them
-    
-    nodes.clear();
-    wires.clear();
-
-    // The graph must have fixed input and output nodes first (created by IconMenu)
-    // We assume they already exist in the graph. We just map them to canvas.
-
-    const auto* xNodes = xml.getChildByName("Nodes");
-    if (!xNodes) return;
-
-    for (auto* xn : xNodes->getChildIterator())
-    {
-        PluginNode n;
-        n.id   = xn->getIntAttribute("id");
-        n.type = static_cast<NodeType>(xn->getIntAttribute("type"));
-        n.name = xn->getStringAttribute("name");
-        n.pos  = { xn->getIntAttribute("x"), xn->getIntAttribute("y") };
-
-        if (n.id >= nextId) nextId = n.id + 1;
-
-        if (n.type == NodeType::Input)
-            n.graphNodeId = AudioProcessorGraph::NodeID(kInputNodeUID);
-        else if (n.type == NodeType::Output)
-            n.graphNodeId = AudioProcessorGraph::NodeID(kOutputNodeUID);
-        else if (n.type == NodeType::Plugin)
-        {
-            // Restore plugin
-            String pluginName = xn->getStringAttribute("pluginName");
-            String formatName = xn->getStringAttribute("pluginFormat");
-            String identifier = xn->getStringAttribute("pluginFileOrIdentifier");
-
-            // Look up the full PluginDescription from knownPlugins
-            PluginDescription desc;
-            desc.fileOrIdentifier = identifier;
-            desc.name = pluginName;
-            desc.pluginFormatName = formatName;
-
-            // Try to find a better description match in our known list
-            for (const auto& d : knownPlugins.getTypes())
-            {
-                if (d.fileOrIdentifier == identifier)
-                {
-                    desc = d;
-                    break;
-                }
-            }
-
-            String err;
-            double sr = 44100.0;
-            int bs = 512;
-            if (auto* dev = deviceManager.getCurrentAudioDevice())
-            {
-                sr = dev->getCurrentSampleRate();
-                bs = dev->getCurrentBufferSizeSamples();
-            }
-
-            DBG("Restoring plugin: " << desc.name << " [" << desc.pluginFormatName << "]");
-            auto instance = formatManager.createPluginInstance(desc, sr, bs, err);
-            if (instance)
-            {
-                if (const auto* xState = xn->getChildByName("PluginState"))
-                {
-                    MemoryBlock mb;
-                    mb.fromBase64Encoding(xState->getAllSubText());
-                    instance->setStateInformation(mb.getData(), (int)mb.getSize());
-                }
-                instance->prepareToPlay(sr, bs);
-                auto nodePtr = graph.addNode(std::unique_ptr<AudioProcessor>(std::move(instance)));
-                if (nodePtr) 
-                {
-                    n.graphNodeId = nodePtr->nodeID;
-                    
-                    // Add parameter change listener so we save when plugin params change
-                    if (auto* proc = nodePtr->getProcessor())
-                    {
-                        auto listener = std::make_unique<PluginParameterListener>(
-                            [this] { if (onGraphChanged) onGraphChanged(); });
-                        proc->addListener(listener.get());
-                        // Store the listener in global map to keep it alive
-                        g_pluginListeners[nodePtr->nodeID.uid] = std::move(listener);
-                    }
-                    
-                    DBG("Successfully added plugin node: " << n.name << " ID: " << n.graphNodeId.uid);
-                }
-                else
-                {
-                    DBG("FAILED to add plugin node to graph: " << n.name);
-                }
-            }
-            else
-            {
-                DBG("FAILED to create plugin instance: " << desc.name << " Error: " << err);
-            }
-        }
-        nodes.push_back(n);
-    }
-
-    const auto* xWires = xml.getChildByName("Wires");
-    if (xWires)
-    {
-        for (auto* xw : xWires->getChildIterator())
-        {
-            NodeWire w;
-            w.fromNode = xw->getIntAttribute("from");
-            w.toNode   = xw->getIntAttribute("to");
-            wires.push_back(w);
 
-            const PluginNode *fr = nullptr, *to = nullptr;
-            for (const auto& nd : nodes)
-            {
-                if (nd.id == w.fromNode) fr = &nd;
-                if (nd.id == w.toNode)   to = &nd;
-            }
-            if (fr && to && fr->graphNodeId.uid != 0 && to->graphNodeId.uid != 0)
-            {
-                DBG("Restoring wire: " << fr->name << " -> " << to->name);
-                addGraphConnection(*fr, *to);
-            }
-        }
-    }
-
-    graph.rebuild();
-    repaint();
+    // Deadline strip along the bottom of the plugin zone
+    const int zoneW = NodeGraphCanvas::getZoneWidth();
+    deadlineStrip->setBounds(zoneW + padding, bottomY, jmax(0, getWidth() - 2 * (zoneW + padding)), btnHeight);
 }
 
 std::unique_ptr<XmlElement> MainWindowContent::saveState() const
 {
-    return graphCanvas->saveState();
+    return engine.getSession().saveState();
 }
 
 void MainWindowContent::loadState(const XmlElement& xml)
 {
-    graphCanvas->loadState(xml);
+    PluginWindow::closeAllCurrentlyOpenWindows();  // Editors of the plugins being replaced
+    engine.getSession().loadState(xml);
+    graphCanvas->repaint();
 }
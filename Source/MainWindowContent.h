@@ -2,6 +2,11 @@
 
 #include "JuceHeader.h"
 #include "AudioDeviceSettings.h"
+#include "GraphAnalysis.h"
+#include "DeadlineMonitor.h"
+#include "NodeTimingMonitor.h"
+#include "GraphSession.h"
+#include "LightHostEngine.h"
 
 // ============================================================
 // DPI Scaling utility
@@ -9,86 +14,63 @@
 inline float getDPIScaleFactor();  // Forward declaration, defined in .cpp
 inline float getFontScaleFactor();  // Combined DPI + language font scaling, defined in .cpp
 
-//==============================================================================
-enum class NodeType { Input, Output, Plugin };
-
-//==============================================================================
-/** A visual + audio node. graphNodeId links this to the AudioProcessorGraph. */
-struct PluginNode
-{
-    int        id   { 0 };
-    NodeType   type { NodeType::Plugin };
-    String     name;
-    Point<int> pos  { 200, 100 };
-
-    /** Corresponding AudioProcessorGraph NodeID (0 = not in graph yet). */
-    AudioProcessorGraph::NodeID graphNodeId { 0 };
-
-    // Base sizes (will be scaled by DPI factor)
-    static constexpr int kW      = 140;
-    static constexpr int kH      = 56;
-    static constexpr int kSideH  = 40;
-    static constexpr int kPortR  = 7;
-    
-    // Methods to get scaled sizes
-    static int getWidth()    { return static_cast<int>(kW * getDPIScaleFactor()); }
-    static int getHeight()   { return static_cast<int>(kH * getDPIScaleFactor()); }
-    static int getSideHeight() { return static_cast<int>(kSideH * getDPIScaleFactor()); }
-    static int getPortRadius() { return static_cast<int>(kPortR * getDPIScaleFactor()); }
-
-    bool hasInputPort()  const { return type != NodeType::Input;  }
-    bool hasOutputPort() const { return type != NodeType::Output; }
-
-    Point<int> inputPort()  const { return { pos.x,              pos.y + getHeight() / 2 }; }
-    Point<int> outputPort() const { return { pos.x + getWidth(), pos.y + getHeight() / 2 }; }
-    Rectangle<int> bounds() const { return { pos.x, pos.y, getWidth(), getHeight() }; }
-};
-
-struct NodeWire { int fromNode { -1 }; int toNode { -1 }; };
-
 //==============================================================================
 /**
- * NodeGraphCanvas — visual + audio routing graph.
+ * NodeGraphCanvas — draws the GraphSession and turns mouse actions into session edits.
  *   Left  zone: Input device nodes  (fixed, port on right edge)
  *   Centre zone: Plugin nodes (freely movable, double-click = open editor)
  *   Right zone:  Output device nodes (fixed, port on left edge)
  *
- * All wires immediately update the AudioProcessorGraph.
+ * The session applies every edit to the AudioProcessorGraph at once. Each wire carries a
+ * channel map (stereo by default; right-click a wire to change it), and only
+ * the channels it maps are connected. A port may take any number of wires:
+ * the graph sums them into the destination, each through its own gain.
+ * Plugin and Output nodes show their latency along the longest wired path,
+ * refreshed periodically so plugins changing latency on a live stream show up.
+ * A plugin can be bypassed (node menu or B) for instant A/B comparisons
+ * without re-instantiating it. Each plugin shows its processBlock time as a
+ * share of the buffer period (smoothed / held peak), from the NodeTimingMonitor.
  */
-class NodeGraphCanvas : public Component
+class NodeGraphCanvas : public Component,
+                        private Timer
 {
 public:
     // Base sizes (will be scaled by DPI factor)
     static constexpr int kZoneW = 170;
     static constexpr int kHdrH  = 34;
+    static constexpr int kNodeW = 140;
+    static constexpr int kNodeH = 56;
+    static constexpr int kSideH = 40;
+    static constexpr int kPortR = 7;
     
     // Methods to get scaled sizes
     static int getZoneWidth()  { return static_cast<int>(kZoneW * getDPIScaleFactor()); }
     static int getHeaderHeight() { return static_cast<int>(kHdrH * getDPIScaleFactor()); }
+    static int getNodeWidth()  { return static_cast<int>(kNodeW * getDPIScaleFactor()); }
+    static int getNodeHeight() { return static_cast<int>(kNodeH * getDPIScaleFactor()); }
+    static int getSideHeight() { return static_cast<int>(kSideH * getDPIScaleFactor()); }
+    static int getPortRadius() { return static_cast<int>(kPortR * getDPIScaleFactor()); }
 
-    static constexpr uint32 kInputNodeUID  = 1000000;
-    static constexpr uint32 kOutputNodeUID = 1000001;
-
-    NodeGraphCanvas(AudioDeviceManager&      dm,
-                    KnownPluginList&          knownPlugins,
-                    AudioPluginFormatManager& fmt,
-                    AudioProcessorGraph&      graph);
-    ~NodeGraphCanvas() override = default;
+    NodeGraphCanvas(GraphSession&       session,
+                    AudioDeviceManager& dm,
+                    NodeTimingMonitor&  timingMonitor);
+    ~NodeGraphCanvas() override;
 
-    /** Add an Input or Output side-panel node (graphNodeId pre-set to known IDs). */
+    /** Add an Input or Output side-panel node below the existing ones of its type. */
     void addNode(const String& name, NodeType type);
 
     const std::vector<PluginNode>& getNodes() const noexcept { return nodes; }
 
+    /** Display name of a graph node: the canvas node's name. */
+    String getGraphNodeLabel(AudioProcessorGraph::NodeID graphNodeId) const;
+
     std::function<void()> onManagePlugins;
     std::function<void()> onDoubleClickLeft;
     std::function<void()> onDoubleClickRight;
     std::function<void(int, NodeType)> onEditNode;
+    /** Any session edit, including plugin parameter changes (which may arrive off the message thread). */
     std::function<void()> onGraphChanged;
 
-    std::unique_ptr<XmlElement> saveState() const;
-    void loadState(const XmlElement& xml);
-
     void paint(Graphics& g) override;
     void mouseDoubleClick(const MouseEvent& e) override;
     void mouseDown(const MouseEvent& e) override;
@@ -97,14 +79,21 @@ public:
     bool keyPressed(const KeyPress& key) override;
 
 private:
-    AudioDeviceManager&       deviceManager;
-    KnownPluginList&          knownPlugins;
-    AudioPluginFormatManager& formatManager;
-    AudioProcessorGraph&      graph;
+    GraphSession&       session;
+    AudioDeviceManager& deviceManager;
+    NodeTimingMonitor&  timingMonitor;
 
-    std::vector<PluginNode> nodes;
-    std::vector<NodeWire>   wires;
-    int nextId { 1 };
+    // The session's model, read-only here: every edit goes through the session
+    const std::vector<PluginNode>& nodes;
+    const std::vector<NodeWire>&   wires;
+
+    // Per-node latency breakdown, refreshed by the timer
+    GraphAnalysis::LatencyMap latencies;
+    double latencySampleRate { 0.0 };
+
+    // Per-node processBlock load, refreshed by the timer
+    std::map<AudioProcessorGraph::NodeID, NodeTimingMonitor::Reading> timings;
+    int timerTicks { 0 };
 
     // Selection state
     int        selectedNode { -1 };
@@ -122,45 +111,106 @@ private:
     Point<int>     inputPortPos (const PluginNode& n) const;
     Point<int>     outputPortPos(const PluginNode& n) const;
     Rectangle<int> nodeBounds   (const PluginNode& n) const;
+    /** A plugin node's box at its session position. */
+    static Rectangle<int> pluginBounds(const PluginNode& n);
 
     // ---- Drawing -----------------------------------------------------
     void drawZoneBackgrounds(Graphics& g) const;
     void drawNode(Graphics& g, const PluginNode& n) const;
     void drawWire(Graphics& g, Point<int> a, Point<int> b, bool active) const;
+    /** The bezier curve drawn for a wire from a to b (also used for hit testing). */
+    static Path makeWirePath(Point<int> a, Point<int> b);
+    /** Milliseconds label for a latency in samples at the current device rate. */
+    String formatLatency(int samples) const;
+    /** "-6.0 dB", or the mute label at minus infinity. */
+    static String formatWireGain(float gainDecibels);
+    /** "350 ms" / "2.4 s" for a plugin's load time. */
+    static String formatLoadTime(double milliseconds);
+
+    // ---- Latency and load ---------------------------------------------
+    void timerCallback() override;
+    /** Recompute the per-node latencies; repaints only if something changed. */
+    void refreshLatencies();
+    /** Read the plugin nodes' load meters; repaints only if something changed. */
+    void refreshTimings();
 
     // ---- Hit testing -------------------------------------------------
     int  nodeAtPoint   (Point<int> p) const;
     bool nearOutputPort(Point<int> p, int& outId) const;
     bool nearInputPort (Point<int> p, int& outId) const;
-    bool isValidWire   (int fromId, int toId) const;
-
-    // ---- Graph interaction -------------------------------------------
-    /** Connect two canvas nodes in the AudioProcessorGraph (stereo, ch 0+1). */
-    void addGraphConnection   (const PluginNode& from, const PluginNode& to);
-    /** Disconnect two canvas nodes in the AudioProcessorGraph. */
-    void removeGraphConnection(const PluginNode& from, const PluginNode& to);
-    /** Remove all graph connections that go into a given node (single-input rule). */
-    void clearGraphInputConnections(const PluginNode& to);
-    /** Disconnect all wires connected to a node (both input and output). */
-    void disconnectNode(int nodeId);
+    /** Index into wires of the wire under p, or -1. */
+    int  wireAtPoint   (Point<int> p) const;
 
     // ---- Actions -----------------------------------------------------
+    // Session edits; each repaints the canvas afterwards.
     void showPluginPicker(Point<int> canvasPos);
     void openPluginEditor(int nodeId);
     void removeNode(int nodeId);
+    void disconnectNode(int nodeId);
+    /** Bypass or re-enable a plugin node; takes effect on the next block, no rebuild. */
+    void setNodeBypassed(int nodeId, bool shouldBeBypassed);
+    void showWireMenu(int wireIndex, Point<int> screenPos);
+    void showCustomChannelsDialog(int fromNode, int toNode);
+    void setWireChannels(int fromNode, int toNode, const WireChannelMap& channels);
+    void setWireGain(int fromNode, int toNode, float gainDecibels);
+    void removeWire(int fromNode, int toNode);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NodeGraphCanvas)
 };
 
 //==============================================================================
-/** Top-level content. Owns NodeGraphCanvas and shows add-device dialogs. */
+/**
+ * DeadlineStrip — audio-thread load summary for the active Voicemeeter device.
+ * Shows mean / p99 / p99.9 / max load, the overrun count and a small histogram
+ * of the device's DeadlineMonitor, plus how often the connection watchdog had
+ * to reconnect; Reset clears the statistics and Save writes the full report
+ * (summary + histogram CSV) to a text file. Node CSV exports the per-node
+ * load history (createNodeTimingCsv) for post-mortems on glitched streams.
+ */
+class DeadlineStrip : public Component,
+                      private Timer
+{
+public:
+    explicit DeadlineStrip(AudioDeviceManager& dm);
+    ~DeadlineStrip() override = default;
+
+    void paint(Graphics& g) override;
+    void resized() override;
+
+    /** Produces the per-node load history CSV; the Node CSV button is disabled without it. */
+    std::function<String()> createNodeTimingCsv;
+
+private:
+    AudioDeviceManager& deviceManager;
+
+    DeadlineMonitor::Snapshot snapshot;
+    bool hasMonitor { false };
+    int numReconnects { 0 };
+    double lastGapMs { 0.0 };
+
+    TextButton resetBtn;
+    TextButton saveBtn;
+    TextButton timingCsvBtn;
+    std::unique_ptr<FileChooser> fileChooser;
+
+    /** The monitor of the current device, or nullptr for non-Voicemeeter devices. */
+    DeadlineMonitor* getMonitor() const;
+
+    void timerCallback() override;
+    void saveReport();
+    void saveNodeTimings();
+    /** Ask for a file (suggesting defaultName) and write text to it. */
+    void saveTextFile(const String& defaultName, const String& text);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeadlineStrip)
+};
+
+//==============================================================================
+/** Top-level content. Owns NodeGraphCanvas (a view of the engine's session) and shows add-device dialogs. */
 class MainWindowContent : public Component
 {
 public:
-    MainWindowContent(AudioDeviceManager&      deviceManager,
-                      KnownPluginList&          knownPlugins,
-                      AudioPluginFormatManager& formatManager,
-                      AudioProcessorGraph&      graph);
+    explicit MainWindowContent(LightHostEngine& engine);
     ~MainWindowContent() override = default;
 
     void resized() override;
@@ -174,13 +224,11 @@ public:
     void loadState(const XmlElement& xml);
 
 private:
-    AudioDeviceManager&       deviceManager;
-    KnownPluginList&          knownPlugins;
-    AudioPluginFormatManager& formatManager;
-    AudioProcessorGraph&      graph;
+    LightHostEngine& engine;
 
     std::unique_ptr<NodeGraphCanvas> graphCanvas;
     std::unique_ptr<TextButton> settingsBtn;
+    std::unique_ptr<DeadlineStrip> deadlineStrip;
     Component::SafePointer<Component> scaleSettingsWnd;  // Track open scale settings window
 
     void showInputDialog();
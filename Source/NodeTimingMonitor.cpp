@@ -0,0 +1,162 @@
+/*
+ * NodeTimingMonitor.cpp
+ * LightHost - 每個節點的 processBlock 耗時監測實作
+ */
+
+#include "NodeTimingMonitor.h"
+
+#include <algorithm>
+
+namespace
+{
+    /** 平滑係數：每個區塊向新讀數靠近的比例 */
+    constexpr double smoothing = 0.1;
+} // namespace
+
+std::vector<int> NodeTimingMonitor::assignSlots(const std::vector<juce::uint32> &nodeUids)
+{
+    const juce::ScopedLock lock(assignLock);
+    std::vector<int> assigned(nodeUids.size(), -1);
+
+    auto isWanted = [&nodeUids](juce::uint32 uid)
+    { return std::find(nodeUids.begin(), nodeUids.end(), uid) != nodeUids.end(); };
+
+    // Nodes keep their slot across plans, so their readings survive a rebuild
+    for (size_t i = 0; i < nodeUids.size(); ++i)
+        for (int s = 0; s < maxSlots; ++s)
+            if (slots[(size_t)s].nodeUid.load(std::memory_order_relaxed) == nodeUids[i])
+            {
+                assigned[i] = s;
+                break;
+            }
+
+    // New nodes take free slots, then the slots of nodes that left the graph. A departed node's
+    // slot stays put while an older plan holds it: that plan may still be rendering it.
+    for (size_t i = 0; i < nodeUids.size(); ++i)
+    {
+        if (assigned[i] >= 0 || nodeUids[i] == 0)
+            continue;
+
+        for (int s = 0; s < maxSlots && assigned[i] < 0; ++s)
+        {
+            auto &slot = slots[(size_t)s];
+            const auto owner = slot.nodeUid.load(std::memory_order_relaxed);
+            if (owner == 0 || (slot.planRefs == 0 && !isWanted(owner)))
+            {
+                clearSlot(slot);
+                slot.nodeUid.store(nodeUids[i], std::memory_order_release);
+                assigned[i] = s;
+            }
+        }
+    }
+
+    for (const int s : assigned)
+        if (s >= 0)
+            ++slots[(size_t)s].planRefs;
+
+    return assigned;
+}
+
+void NodeTimingMonitor::releaseSlots(const std::vector<int> &slotIndices)
+{
+    const juce::ScopedLock lock(assignLock);
+    for (const int s : slotIndices)
+        if (s >= 0)
+        {
+            jassert(slots[(size_t)s].planRefs > 0);
+            --slots[(size_t)s].planRefs;
+        }
+}
+
+void NodeTimingMonitor::clearSlot(Slot &slot) noexcept
+{
+    slot.load.store(0.0, std::memory_order_relaxed);
+    slot.peakLoad.store(0.0, std::memory_order_relaxed);
+    slot.peakHoldRemaining.store(0.0, std::memory_order_relaxed);
+    slot.numBlocks.store(0, std::memory_order_relaxed);
+}
+
+void NodeTimingMonitor::record(int slotIndex, juce::int64 elapsedTicks, int numSamples) noexcept
+{
+    const double rate = sampleRate.load(std::memory_order_relaxed);
+    if (slotIndex < 0 || numSamples <= 0 || rate <= 0.0)
+        return;
+
+    auto &slot = slots[(size_t)slotIndex];
+    const double period = (double)numSamples / rate;
+    const double load = juce::Time::highResolutionTicksToSeconds(elapsedTicks) / period;
+
+    // Single writer per block: plain load/store pairs instead of read-modify-write
+    const double smoothed = slot.load.load(std::memory_order_relaxed);
+    slot.load.store(smoothed + (load - smoothed) * smoothing, std::memory_order_relaxed);
+
+    const double hold = slot.peakHoldRemaining.load(std::memory_order_relaxed) - period;
+    if (load >= slot.peakLoad.load(std::memory_order_relaxed) || hold <= 0.0)
+    {
+        slot.peakLoad.store(load, std::memory_order_relaxed);
+        slot.peakHoldRemaining.store(peakHoldSeconds, std::memory_order_relaxed);
+    }
+    else
+    {
+        slot.peakHoldRemaining.store(hold, std::memory_order_relaxed);
+    }
+
+    slot.numBlocks.store(slot.numBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+NodeTimingMonitor::Reading NodeTimingMonitor::getReading(juce::uint32 nodeUid) const noexcept
+{
+    Reading reading;
+    if (nodeUid == 0)
+        return reading;
+
+    for (const auto &slot : slots)
+        if (slot.nodeUid.load(std::memory_order_acquire) == nodeUid)
+        {
+            reading.numBlocks = slot.numBlocks.load(std::memory_order_acquire);
+            reading.load = slot.load.load(std::memory_order_relaxed);
+            reading.peakLoad = slot.peakLoad.load(std::memory_order_relaxed);
+            break;
+        }
+    return reading;
+}
+
+void NodeTimingMonitor::captureHistory()
+{
+    const double now = juce::Time::getMillisecondCounterHiRes() * 0.001 - startSeconds;
+    for (const auto &slot : slots)
+    {
+        const auto uid = slot.nodeUid.load(std::memory_order_acquire);
+        if (uid == 0 || slot.numBlocks.load(std::memory_order_acquire) == 0)
+            continue;
+
+        history.push_back({now, uid, (float)slot.load.load(std::memory_order_relaxed),
+                           (float)slot.peakLoad.load(std::memory_order_relaxed)});
+    }
+
+    while (history.size() > maxHistoryRows)
+        history.pop_front();
+}
+
+void NodeTimingMonitor::clearHistory()
+{
+    history.clear();
+}
+
+juce::String NodeTimingMonitor::createCsv(const std::function<juce::String(juce::uint32)> &nameForNode) const
+{
+    juce::MemoryOutputStream csv;
+    csv << "time_s,node_id,node,load_percent,peak_percent\n";
+
+    for (const auto &row : history)
+    {
+        auto name = nameForNode != nullptr ? nameForNode(row.nodeUid) : juce::String();
+        if (name.isEmpty())
+            name = "node " + juce::String(row.nodeUid);
+
+        csv << juce::String(row.seconds, 3) << "," << (int)row.nodeUid << ","
+            << name.replace(",", " ").replace("\"", "'") << ","
+            << juce::String(row.load * 100.0f, 2) << "," << juce::String(row.peakLoad * 100.0f, 2) << "\n";
+    }
+    return csv.toString();
+}
@@ -0,0 +1,123 @@
+/*
+ * NodeTimingMonitor.h
+ * LightHost - 每個節點的 processBlock 耗時監測（lock-free 槽位）
+ *
+ * 功能說明：
+ * - GraphRenderPlan 以 Time::getHighResolutionTicks() 量測每個步驟呼叫 processBlock 的耗時，
+ *   記錄到該節點的槽位，換算成「耗時 / 緩衝區週期」的負載
+ * - 每個槽位保存平滑後的負載與峰值（峰值保持 peakHoldSeconds 秒後才回落）
+ * - captureHistory() 定期把所有節點的負載記入有上限的歷史，createCsv() 匯出時間序列，
+ *   供串流出現爆音後檢查是哪個外掛超時
+ *
+ * 執行緒：
+ * - assignSlots() 在編譯計畫的執行緒（背景編譯執行緒或 prepareToPlay），releaseSlots() 在釋放計畫的
+ *   執行緒（ParallelGraphProcessor 的回收計時器），兩者以內部鎖序列化
+ * - 計畫持有它取得的槽位直到被釋放：離開圖形的節點的槽，要等仍在渲染它的舊計畫回收後才會給新節點
+ * - record() 在渲染執行緒；同一個區塊內每個槽位只有一個寫入者，只做原子載入 / 儲存
+ * - getReading() 可在任何執行緒呼叫；captureHistory() / createCsv() / clearHistory() 在訊息執行緒
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+class NodeTimingMonitor
+{
+public:
+    static constexpr int maxSlots = 256;            // 超出的節點不計時
+    static constexpr double peakHoldSeconds = 2.0;
+    static constexpr size_t maxHistoryRows = 200000; // 約 10 個節點 × 4 Hz × 80 分鐘
+
+    /** 負載以緩衝區週期的比例表示（1.0 = 剛好用完整個週期） */
+    struct Reading
+    {
+        double load = 0.0;     // 平滑後
+        double peakLoad = 0.0; // 峰值保持
+        std::uint64_t numBlocks = 0;
+    };
+
+    /** 設定採樣率（prepareToPlay 時） */
+    void setSampleRate(double newSampleRate) noexcept { sampleRate.store(newSampleRate, std::memory_order_relaxed); }
+
+    /**
+     * assignSlots() 方法
+     * 為每個節點取得槽位：沿用同一節點原本的槽位，否則取用空槽，或不在 nodeUids 內、
+     * 也沒有任何計畫持有的節點的槽。呼叫端持有取得的槽位，直到以 releaseSlots() 歸還
+     *
+     * @param nodeUids 計畫中所有節點的 NodeID::uid
+     * @return 與 nodeUids 對應的槽位索引；槽位用完時為 -1
+     */
+    [[nodiscard]] std::vector<int> assignSlots(const std::vector<juce::uint32> &nodeUids);
+
+    /**
+     * releaseSlots() 方法
+     * 歸還 assignSlots() 取得的槽位（計畫釋放時；不可在渲染執行緒呼叫）
+     *
+     * @param slotIndices assignSlots() 的結果；-1 時忽略
+     */
+    void releaseSlots(const std::vector<int> &slotIndices);
+
+    /**
+     * record() 方法
+     * 記錄一個節點處理一個區塊的耗時（渲染執行緒）
+     *
+     * @param slot         assignSlots() 取得的槽位；-1 時忽略
+     * @param elapsedTicks Time::getHighResolutionTicks() 量得的耗時
+     * @param numSamples   區塊樣本數
+     */
+    void record(int slot, juce::int64 elapsedTicks, int numSamples) noexcept;
+
+    /** 節點目前的讀數；沒有槽位時全為 0（任何執行緒） */
+    [[nodiscard]] Reading getReading(juce::uint32 nodeUid) const noexcept;
+
+    /** 把所有有槽位的節點目前的讀數記入歷史（訊息執行緒，一般由計時器呼叫） */
+    void captureHistory();
+
+    /** 清除歷史（訊息執行緒） */
+    void clearHistory();
+
+    /**
+     * createCsv() 方法
+     * 匯出歷史為 CSV：time_s,node_id,node,load_percent,peak_percent（訊息執行緒）
+     *
+     * @param nameForNode 節點 uid 對應的名稱；空字串時以 "node <uid>" 代替
+     */
+    [[nodiscard]] juce::String createCsv(const std::function<juce::String(juce::uint32)> &nameForNode) const;
+
+private:
+    struct Slot
+    {
+        std::atomic<juce::uint32> nodeUid{0}; // 0 = free
+        std::atomic<double> load{0.0};
+        std::atomic<double> peakLoad{0.0};
+        std::atomic<double> peakHoldRemaining{0.0}; // Seconds; writer only
+        std::atomic<std::uint64_t> numBlocks{0};
+        int planRefs = 0; // Plans that may still record into the slot; guarded by assignLock
+    };
+
+    struct HistoryRow
+    {
+        double seconds;
+        juce::uint32 nodeUid;
+        float load;
+        float peakLoad;
+    };
+
+    void clearSlot(Slot &slot) noexcept;
+
+    std::array<Slot, maxSlots> slots;
+    std::atomic<double> sampleRate{0.0};
+    juce::CriticalSection assignLock; // Plan compilers and plan release; never taken while rendering
+
+    std::deque<HistoryRow> history;
+    const double startSeconds = juce::Time::getMillisecondCounterHiRes() * 0.001;
+
+    JUCE_DECLARE_NON_COPYABLE(NodeTimingMonitor)
+};
@@ -0,0 +1,145 @@
+/*
+ * OfflineRenderJob.cpp
+ * LightHost - 離線渲染實作
+ */
+
+#include "OfflineRenderJob.h"
+#include "GraphAnalysis.h"
+
+namespace
+{
+    constexpr int readAheadSamples = 1 << 16;   // Per channel, filled by the I/O thread
+    constexpr int writeBehindSamples = 1 << 17; // Larger than the read side: encoding is the slower half
+} // namespace
+
+OfflineRenderJob::OfflineRenderJob(juce::KnownPluginList &knownPlugins, int numWorkers)
+    : renderer(graph, numWorkers),
+      session(graph, formatManager, knownPlugins)
+{
+    juce::addDefaultFormatsToManager(formatManager);
+}
+
+OfflineRenderJob::~OfflineRenderJob()
+{
+    writer.reset(); // Flushes whatever a cancelled render left behind
+    if (blockSize > 0)
+        renderer.releaseResources();
+}
+
+juce::String OfflineRenderJob::prepare(const juce::XmlElement &sessionState, const juce::File &inputFile, const juce::File &outputFile,
+                                       int newBlockSize, juce::AudioFormatManager &audioFormats, juce::TimeSliceThread &ioThread)
+{
+    jassert(blockSize == 0); // One prepare() per job
+    input = inputFile;
+    output = outputFile;
+
+    std::unique_ptr<juce::AudioFormatReader> fileReader(audioFormats.createReaderFor(input));
+    if (fileReader == nullptr)
+        return "cannot read " + input.getFullPathName();
+
+    sampleRate = fileReader->sampleRate;
+    const int fileChannels = (int)fileReader->numChannels;
+    const int bitsPerSample = fileReader->usesFloatingPointData ? 32 : juce::jlimit(16, 32, (int)fileReader->bitsPerSample);
+
+    // A disk that falls behind stalls the render instead of inserting silence
+    auto buffering = std::make_unique<juce::BufferingAudioReader>(fileReader.release(), ioThread, readAheadSamples);
+    buffering->setReadTimeout(-1);
+    reader = std::move(buffering);
+
+    // Plugins are prepared once, at the file's rate and the render block size
+    session.setPreparationSpec(sampleRate, newBlockSize);
+    session.loadState(sessionState);
+    for (const auto &node : session.getNodes())
+        if (node.type == NodeType::Plugin && node.graphNodeId.uid == 0)
+            missingPlugins.add(node.name);
+
+    const auto used = GraphAnalysis::getUsedIOChannels(graph);
+    const int numInputs = juce::jmax(2, used.numInputs, fileChannels);
+    numOutputs = juce::jmax(2, used.numOutputs);
+
+    auto *format = audioFormats.findFormatForFileExtension(output.getFileExtension());
+    if (format == nullptr)
+        return "no audio format for " + output.getFileName();
+
+    output.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(output);
+    if (!stream->openedOk())
+        return "cannot write " + output.getFullPathName();
+
+    std::unique_ptr<juce::AudioFormatWriter> fileWriter(format->createWriterFor(stream.get(), sampleRate, (unsigned int)numOutputs,
+                                                                                bitsPerSample, {}, 0));
+    if (fileWriter == nullptr)
+        return format->getFormatName() + " cannot write " + juce::String(numOutputs) + " channels at " + juce::String(sampleRate) + " Hz";
+    stream.release(); // Owned by the writer
+    writer = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(fileWriter.release(), ioThread, writeBehindSamples);
+
+    // Nobody listens while rendering: no fade on topology swaps, and plugins may use their offline quality
+    renderer.setFadeOutInEnabled(false);
+    graph.dispatchPendingMessages(); // Apply loadState()'s topology before the first plan is compiled
+    graph.setNonRealtime(true);
+    renderer.setNonRealtime(true);
+
+    blockSize = newBlockSize;
+    renderer.setPlayConfigDetails(numInputs, numOutputs, sampleRate, blockSize);
+    renderer.prepareToPlay(sampleRate, blockSize);
+
+    buffer.setSize(juce::jmax(numInputs, numOutputs), blockSize);
+    readPointers.assign((size_t)juce::jmin(fileChannels, buffer.getNumChannels()), nullptr);
+    writePointers.assign((size_t)numOutputs, nullptr);
+    return {};
+}
+
+OfflineRenderJob::Result OfflineRenderJob::render(const std::atomic<bool> &shouldCancel)
+{
+    Result result;
+    result.sampleRate = sampleRate;
+    if (reader == nullptr || writer == nullptr)
+    {
+        result.error = "not prepared";
+        return result;
+    }
+
+    const juce::int64 length = reader->lengthInSamples;
+    const int latency = renderer.getLatencySamples(); // Dropped from the start, so the output lines up with the input
+    juce::int64 readPosition = 0;
+    juce::MidiBuffer midi;
+
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+    while (result.numSamples < length)
+    {
+        if (shouldCancel.load(std::memory_order_relaxed))
+        {
+            result.cancelled = true;
+            break;
+        }
+
+        // Full blocks throughout; past the end of the file the reader returns silence, which flushes the tails
+        buffer.clear();
+        for (size_t ch = 0; ch < readPointers.size(); ++ch)
+            readPointers[ch] = buffer.getWritePointer((int)ch);
+        reader->read(readPointers.data(), (int)readPointers.size(), readPosition, blockSize);
+        readPosition += blockSize;
+
+        midi.clear();
+        renderer.processBlock(buffer, midi);
+
+        const juce::int64 blockEnd = readPosition - latency;
+        const juce::int64 blockStart = blockEnd - blockSize;
+        const juce::int64 from = juce::jmax(blockStart, result.numSamples);
+        const juce::int64 to = juce::jmin(blockEnd, length);
+        if (to <= from)
+            continue;
+
+        const int offset = (int)(from - blockStart);
+        for (int ch = 0; ch < numOutputs; ++ch)
+            writePointers[(size_t)ch] = buffer.getReadPointer(ch, offset);
+        while (!writer->write(writePointers.data(), (int)(to - from)))
+            juce::Thread::sleep(1); // The write-behind buffer is full: let the I/O thread catch up
+
+        result.numSamples = to;
+    }
+
+    writer.reset(); // Waits for the I/O thread to write everything out
+    result.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startMs) * 0.001;
+    return result;
+}
@@ -0,0 +1,105 @@
+/*
+ * OfflineRenderJob.h
+ * LightHost - 離線渲染：以儲存的工作階段處理一個音訊檔（不需音頻設備、不按實際時間節奏）
+ *
+ * 功能說明：
+ * - 每個工作擁有自己的 AudioProcessorGraph、ParallelGraphProcessor 與 GraphSession，
+ *   因此多個檔案可以在不同核心上同時渲染（每個檔案一個圖形實例）
+ * - 以全速逐區塊處理，區塊大小由呼叫端指定；外掛處於 non-realtime 模式
+ * - 讀寫都透過背景執行緒雙緩衝（BufferingAudioReader / ThreadedWriter），
+ *   與 HeadlessAudioIODevice 相同，但讀取會等待資料而不是插入靜音，寫入會等待空間而不是丟棄
+ * - 輸出扣除圖形的延遲：與輸入對齊、長度相同
+ * - 結果包含渲染時間與即時倍率（音訊長度 / 渲染時間）
+ *
+ * 執行緒：
+ * - prepare() 與解構在訊息執行緒（建立與刪除外掛）
+ * - render() 在任何一個執行緒（每個工作同時只能有一個）
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+#include "GraphSession.h"
+#include "ParallelGraphProcessor.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class OfflineRenderJob
+{
+public:
+    struct Result
+    {
+        juce::String error;             // 空字串表示成功
+        juce::int64 numSamples = 0;     // 寫入的樣本數（每通道）
+        double sampleRate = 0.0;
+        double renderSeconds = 0.0;     // render() 的實際耗時
+        bool cancelled = false;
+
+        [[nodiscard]] double getAudioSeconds() const noexcept { return sampleRate > 0.0 ? (double)numSamples / sampleRate : 0.0; }
+
+        /** 音訊長度 / 渲染時間；大於 1 表示比即時快 */
+        [[nodiscard]] double getRealtimeFactor() const noexcept { return renderSeconds > 0.0 ? getAudioSeconds() / renderSeconds : 0.0; }
+    };
+
+    /**
+     * 建構子
+     *
+     * @param knownPlugins 載入工作階段時查詢完整的外掛描述（prepare() 期間不可修改）
+     * @param numWorkers   圖形內平行分支的工作執行緒數；多個檔案同時渲染時通常為 0，
+     *                     -1 表示 ParallelGraphExecutor::getDefaultNumWorkers()
+     */
+    OfflineRenderJob(juce::KnownPluginList &knownPlugins, int numWorkers);
+    ~OfflineRenderJob();
+
+    /**
+     * prepare() 方法
+     * 開啟輸入與輸出檔、以輸入檔的採樣率載入工作階段並準備渲染器
+     *
+     * @param sessionState nodeGraphState XML
+     * @param inputFile    WAV / AIFF（audioFormats 可讀的任何格式）
+     * @param outputFile   依副檔名選擇格式；既有的檔案會被覆寫
+     * @param blockSize    每次 processBlock 的樣本數
+     * @param audioFormats 讀寫音訊檔
+     * @param ioThread     雙緩衝的背景執行緒（可由多個工作共用，需已啟動）
+     * @return 錯誤訊息；成功時為空字串
+     */
+    juce::String prepare(const juce::XmlElement &sessionState, const juce::File &inputFile, const juce::File &outputFile,
+                         int blockSize, juce::AudioFormatManager &audioFormats, juce::TimeSliceThread &ioThread);
+
+    /** 無法載入的外掛名稱（prepare() 之後） */
+    [[nodiscard]] const juce::StringArray &getMissingPlugins() const noexcept { return missingPlugins; }
+
+    [[nodiscard]] const juce::File &getInputFile() const noexcept { return input; }
+    [[nodiscard]] const juce::File &getOutputFile() const noexcept { return output; }
+
+    /**
+     * render() 方法
+     * 處理整個輸入檔並寫完輸出檔（包含排空寫入緩衝區）
+     *
+     * @param shouldCancel 設為 true 時在下一個區塊停止；已寫入的部分保留
+     */
+    Result render(const std::atomic<bool> &shouldCancel);
+
+private:
+    juce::AudioPluginFormatManager formatManager;
+    juce::AudioProcessorGraph graph;
+    ParallelGraphProcessor renderer;
+    GraphSession session;
+
+    juce::File input, output;
+    juce::StringArray missingPlugins;
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> writer;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int numOutputs = 0;
+
+    juce::AudioBuffer<float> buffer;
+    std::vector<float *> readPointers;
+    std::vector<const float *> writePointers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderJob)
+};
@@ -0,0 +1,208 @@
+/*
+ * ParallelGraphExecutor.cpp
+ * LightHost - 以即時工作執行緒池平行執行 GraphRenderPlan 實作
+ */
+
+#include "ParallelGraphExecutor.h"
+
+#include <thread>
+
+//==============================================================================
+class ParallelGraphExecutor::Worker : public juce::Thread
+{
+public:
+    Worker(ParallelGraphExecutor &ownerToUse, int participantIndex)
+        : Thread("LightHost render " + juce::String(participantIndex)), owner(ownerToUse), participant(participantIndex)
+    {
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            owner.wakeUp.acquire();
+            if (threadShouldExit())
+                break;
+
+            // Registered before checking the block, so the audio thread's join cannot miss us
+            owner.activeWorkers.fetch_add(1);
+            if (owner.blockActive.load())
+                owner.participate(participant);
+            owner.activeWorkers.fetch_sub(1);
+        }
+    }
+
+private:
+    ParallelGraphExecutor &owner;
+    const int participant;
+};
+
+//==============================================================================
+void ParallelGraphExecutor::StealingQueue::setCapacity(int minimumCapacity)
+{
+    const int capacity = juce::nextPowerOfTwo(juce::jmax(2, minimumCapacity));
+    items = std::make_unique<std::atomic<int>[]>((size_t)capacity);
+    mask = capacity - 1;
+    reset();
+}
+
+void ParallelGraphExecutor::StealingQueue::reset() noexcept
+{
+    top.store(0, std::memory_order_relaxed);
+    bottom.store(0, std::memory_order_relaxed);
+}
+
+void ParallelGraphExecutor::StealingQueue::push(int item) noexcept
+{
+    const auto b = bottom.load(std::memory_order_relaxed);
+    items[(size_t)(b & mask)].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+int ParallelGraphExecutor::StealingQueue::take() noexcept
+{
+    const auto b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    int item = items[(size_t)(b & mask)].load(std::memory_order_relaxed);
+    if (t == b)
+    {
+        // Last item: race the thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            item = -1;
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+}
+
+int ParallelGraphExecutor::StealingQueue::steal() noexcept
+{
+    auto t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+        return -1;
+
+    const int item = items[(size_t)(t & mask)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return -1;
+    return item;
+}
+
+//==============================================================================
+int ParallelGraphExecutor::getDefaultNumWorkers()
+{
+    return juce::jlimit(0, 7, juce::SystemStats::getNumCpus() - 1);
+}
+
+void ParallelGraphExecutor::start(int numWorkers)
+{
+    stop();
+
+    queues.clear();
+    for (int i = 0; i <= numWorkers; ++i)
+    {
+        queues.push_back(std::make_unique<StealingQueue>());
+        queues.back()->setCapacity(maxParallelSteps);
+    }
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(*this, i + 1));
+        if (!workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(10)))
+            workers.back()->startThread(juce::Thread::Priority::highest);
+    }
+}
+
+void ParallelGraphExecutor::stop()
+{
+    for (auto &worker : workers)
+        worker->signalThreadShouldExit();
+    wakeUp.release((std::ptrdiff_t)workers.size());
+
+    for (auto &worker : workers)
+        worker->stopThread(1000);
+    workers.clear();
+
+    // Tokens left over from blocks that finished before every worker woke up
+    while (wakeUp.try_acquire())
+    {
+    }
+}
+
+void ParallelGraphExecutor::render(GraphRenderPlan &plan, juce::AudioBuffer<float> &buffer) noexcept
+{
+    plan.beginBlock(buffer, buffer.getNumSamples());
+
+    // Wake only as many workers as there are branches to run side by side
+    const int numHelpers = juce::jmin(getNumWorkers(), plan.getParallelWidth() - 1);
+    if (numHelpers <= 0 || queues.empty() || plan.getNumSteps() > maxParallelSteps)
+    {
+        plan.processSerially();
+        plan.endBlock(buffer);
+        return;
+    }
+
+    for (auto &queue : queues)
+        queue->reset();
+    for (const int step : plan.getRootSteps())
+        queues[0]->push(step);
+
+    currentPlan = &plan;
+    remainingSteps.store(plan.getNumSteps(), std::memory_order_relaxed);
+    blockActive.store(true); // Publishes the plan, the queues and the pending counts
+    wakeUp.release(numHelpers);
+
+    participate(0);
+
+    // Join: no worker may still be looking at this block's queues once we return
+    blockActive.store(false);
+    while (activeWorkers.load() != 0)
+        std::this_thread::yield();
+
+    plan.endBlock(buffer);
+}
+
+void ParallelGraphExecutor::participate(int participant) noexcept
+{
+    auto &plan = *currentPlan;
+    auto &ownQueue = *queues[(size_t)participant];
+
+    while (remainingSteps.load(std::memory_order_acquire) > 0)
+    {
+        int step = ownQueue.take();
+        if (step < 0)
+            step = stealFor(participant);
+        if (step < 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        plan.processStep(step);
+
+        for (const int next : plan.getDependents(step))
+            if (plan.releaseDependency(next))
+                ownQueue.push(next);
+
+        remainingSteps.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+int ParallelGraphExecutor::stealFor(int participant) noexcept
+{
+    const int numQueues = (int)queues.size();
+    for (int offset = 1; offset < numQueues; ++offset)
+        if (const int step = queues[(size_t)((participant + offset) % numQueues)]->steal(); step >= 0)
+            return step;
+    return -1;
+}
@@ -0,0 +1,100 @@
+/*
+ * ParallelGraphExecutor.h
+ * LightHost - 以即時工作執行緒池平行執行 GraphRenderPlan
+ *
+ * 功能說明：
+ * - 音頻執行緒本身是參與者 0，另外最多 getNumWorkers() 個即時優先權的工作執行緒
+ * - 每個參與者有一個無鎖的工作竊取佇列（Chase-Lev，固定容量）：
+ *   自己從底部取出，其他參與者從頂部竊取
+ * - 步驟完成時扣除下游的相依計數，歸零的下游推入自己的佇列（通常由同一執行緒接續，快取友善）
+ * - 所有步驟完成後音頻執行緒等待工作執行緒離開本區塊，才累加輸出（join）
+ * - 計畫沒有平行分支、或步驟數超過佇列容量時不喚醒工作執行緒，直接依序處理
+ * - 佇列容量在 start() 時固定：換上新計畫不需要先準備執行器，計畫可在任何時候交給 render()
+ *
+ * 執行緒：
+ * - start() / stop() 在訊息執行緒，且不能與 render() 同時呼叫
+ * - render() 在音頻執行緒；除了喚醒工作執行緒的號誌外不會阻塞或配置記憶體
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+#include "GraphRenderPlan.h"
+
+#include <atomic>
+#include <memory>
+#include <semaphore>
+#include <vector>
+
+class ParallelGraphExecutor
+{
+public:
+    ParallelGraphExecutor() = default;
+    ~ParallelGraphExecutor() { stop(); }
+
+    /** 預設的工作執行緒數：CPU 核心數 - 1（音頻執行緒本身佔一個），最多 7 */
+    [[nodiscard]] static int getDefaultNumWorkers();
+
+    /**
+     * start() 方法
+     * 啟動工作執行緒（已啟動時先停止）
+     *
+     * @param numWorkers 工作執行緒數；0 表示只在音頻執行緒依序處理
+     */
+    void start(int numWorkers);
+
+    /** 停止並結束所有工作執行緒 */
+    void stop();
+
+    [[nodiscard]] int getNumWorkers() const noexcept { return (int)workers.size(); }
+
+    /** 能平行執行的最大步驟數（每個佇列的容量） */
+    static constexpr int maxParallelSteps = 4096;
+
+    /**
+     * render() 方法
+     * 處理一個區塊：複製輸入、平行處理所有步驟、累加輸出（音頻執行緒）
+     *
+     * @param plan   要渲染的計畫
+     * @param buffer 設備緩衝區（就地：輸入在前幾個通道，輸出寫回）
+     */
+    void render(GraphRenderPlan &plan, juce::AudioBuffer<float> &buffer) noexcept;
+
+private:
+    /** Chase-Lev 工作竊取佇列（固定容量，不擴充） */
+    class StealingQueue
+    {
+    public:
+        void setCapacity(int minimumCapacity);
+        void reset() noexcept;
+
+        void push(int item) noexcept;   // Owner only
+        int take() noexcept;            // Owner only; -1 when empty
+        int steal() noexcept;           // Any thread; -1 when empty or lost a race
+
+    private:
+        std::unique_ptr<std::atomic<int>[]> items;
+        int mask = 0;
+        std::atomic<juce::int64> top{0};
+        std::atomic<juce::int64> bottom{0};
+    };
+
+    class Worker;
+
+    /** 參與者 participant 的工作迴圈，直到本區塊的所有步驟完成 */
+    void participate(int participant) noexcept;
+
+    /** 從其他參與者竊取一個步驟；沒有時回傳 -1 */
+    int stealFor(int participant) noexcept;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::unique_ptr<StealingQueue>> queues; // [0] = audio thread, [i + 1] = workers[i]
+
+    GraphRenderPlan *currentPlan = nullptr;
+    std::atomic<int> remainingSteps{0};
+    std::atomic<bool> blockActive{false};
+    std::atomic<int> activeWorkers{0};
+    std::counting_semaphore<> wakeUp{0};
+
+    JUCE_DECLARE_NON_COPYABLE(ParallelGraphExecutor)
+};
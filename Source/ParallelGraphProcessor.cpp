@@ -0,0 +1,250 @@
+/*
+ * ParallelGraphProcessor.cpp
+ * LightHost - 平行渲染 AudioProcessorGraph 的處理器實作
+ */
+
+#include "ParallelGraphProcessor.h"
+
+namespace
+{
+    /** 回收計畫的間隔（毫秒）；計畫只佔記憶體，不急著釋放 */
+    constexpr int reclaimIntervalMs = 250;
+} // namespace
+
+//==============================================================================
+class ParallelGraphProcessor::PlanBuilder : public juce::Thread
+{
+public:
+    explicit PlanBuilder(ParallelGraphProcessor &ownerToUse) : Thread("LightHost plan builder"), owner(ownerToUse) {}
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(-1);
+            if (!threadShouldExit())
+                owner.buildRequestedPlan();
+        }
+    }
+
+private:
+    ParallelGraphProcessor &owner;
+};
+
+//==============================================================================
+ParallelGraphProcessor::ParallelGraphProcessor(juce::AudioProcessorGraph &graphToRender, int numWorkers)
+    : graph(graphToRender),
+      requestedWorkers(numWorkers < 0 ? ParallelGraphExecutor::getDefaultNumWorkers() : numWorkers),
+      builder(std::make_unique<PlanBuilder>(*this))
+{
+    executor.start(requestedWorkers);
+    builder->startThread(juce::Thread::Priority::low);
+    graph.addChangeListener(this);
+    startTimer(reclaimIntervalMs);
+}
+
+ParallelGraphProcessor::~ParallelGraphProcessor()
+{
+    stopTimer();
+    graph.removeChangeListener(this);
+    builder->signalThreadShouldExit();
+    builder->notify();
+    builder->stopThread(5000);
+    executor.stop();
+
+    // No audio, builder or worker thread is left
+    delete pendingPlan.exchange(nullptr);
+    delete std::exchange(activePlan, nullptr);
+    reclaimPlans();
+}
+
+void ParallelGraphProcessor::prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    // The player configured our channels from the device; the graph's I/O nodes follow them
+    graph.setPlayConfigDetails(getTotalNumInputChannels(), getTotalNumOutputChannels(), sampleRate, maximumExpectedSamplesPerBlock);
+    graph.prepareToPlay(sampleRate, maximumExpectedSamplesPerBlock);
+    preparedBlockSize.store(maximumExpectedSamplesPerBlock);
+    setLatencySamples(graph.getLatencySamples());
+    timingMonitor.setSampleRate(sampleRate);
+
+    // Audio is stopped: compile the first plan right here, so the first block already uses it
+    auto plan = GraphRenderPlan::build(GraphRenderPlan::capture(graph), maximumExpectedSamplesPerBlock, &timingMonitor);
+    {
+        const juce::ScopedLock lock(buildLock);
+        {
+            const juce::ScopedLock requestGuard(requestLock);
+            requestedTopology.reset();
+        }
+        if (auto *stale = pendingPlan.exchange(nullptr))
+            discardPlan(std::unique_ptr<GraphRenderPlan>(stale));
+    }
+
+    discardPlan(std::unique_ptr<GraphRenderPlan>(std::exchange(activePlan, plan.release())));
+    oldPlanFadedOut = false;
+    parallel.store(!activePlan->requiresGraphRenderer() && activePlan->getParallelWidth() > 1 && executor.getNumWorkers() > 0,
+                   std::memory_order_relaxed);
+}
+
+void ParallelGraphProcessor::releaseResources()
+{
+    preparedBlockSize.store(0);
+    {
+        const juce::ScopedLock lock(buildLock);
+        if (auto *stale = pendingPlan.exchange(nullptr))
+            discardPlan(std::unique_ptr<GraphRenderPlan>(stale));
+    }
+
+    discardPlan(std::unique_ptr<GraphRenderPlan>(std::exchange(activePlan, nullptr)));
+    oldPlanFadedOut = false;
+    parallel.store(false, std::memory_order_relaxed);
+    graph.releaseResources();
+}
+
+void ParallelGraphProcessor::requestPlan()
+{
+    if (preparedBlockSize.load() <= 0)
+        return; // prepareToPlay() compiles the plan itself
+
+    auto topology = GraphRenderPlan::capture(graph);
+    {
+        const juce::ScopedLock lock(requestLock);
+        requestedTopology = std::move(topology); // An unbuilt older request is simply replaced
+    }
+    builder->notify();
+
+    setLatencySamples(graph.getLatencySamples());
+}
+
+void ParallelGraphProcessor::buildRequestedPlan()
+{
+    const juce::ScopedLock lock(buildLock);
+
+    std::optional<GraphRenderPlan::Topology> topology;
+    {
+        const juce::ScopedLock requestGuard(requestLock);
+        std::swap(topology, requestedTopology);
+    }
+
+    const int blockSize = preparedBlockSize.load();
+    if (!topology.has_value() || blockSize <= 0)
+        return;
+
+    // The topology's node references move into the plan, so nothing is destroyed on this thread
+    publishPlan(GraphRenderPlan::build(std::move(*topology), blockSize, &timingMonitor));
+}
+
+void ParallelGraphProcessor::publishPlan(std::unique_ptr<GraphRenderPlan> plan)
+{
+    if (auto *superseded = pendingPlan.exchange(plan.release(), std::memory_order_acq_rel))
+        discardPlan(std::unique_ptr<GraphRenderPlan>(superseded));
+}
+
+void ParallelGraphProcessor::discardPlan(std::unique_ptr<GraphRenderPlan> plan)
+{
+    if (plan == nullptr)
+        return;
+
+    const juce::ScopedLock lock(requestLock);
+    discardedPlans.push_back(std::move(plan));
+}
+
+void ParallelGraphProcessor::reclaimPlans()
+{
+    const auto scope = retiredFifo.read(retiredFifo.getNumReady());
+    scope.forEach([this](int index)
+                  { delete std::exchange(retiredPlans[(size_t)index], nullptr); });
+
+    std::vector<std::unique_ptr<GraphRenderPlan>> plans;
+    {
+        const juce::ScopedLock lock(requestLock);
+        std::swap(plans, discardedPlans);
+    }
+    // Destroyed outside the lock: the last reference to a removed plugin may go with them
+}
+
+void ParallelGraphProcessor::adoptPendingPlan() noexcept
+{
+    auto *next = pendingPlan.exchange(nullptr, std::memory_order_acq_rel);
+    if (next == nullptr)
+        return;
+
+    if (activePlan != nullptr)
+    {
+        const auto scope = retiredFifo.write(1);
+        jassert(scope.blockSize1 == 1); // Checked by the caller
+        retiredPlans[(size_t)scope.startIndex1] = activePlan;
+    }
+
+    activePlan = next;
+    parallel.store(!activePlan->requiresGraphRenderer() && activePlan->getParallelWidth() > 1 && executor.getNumWorkers() > 0,
+                   std::memory_order_relaxed);
+}
+
+void ParallelGraphProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
+{
+    bool fadeOut = false, fadeIn = false;
+
+    // With a full retire queue the new plan simply waits a block; the audio thread never frees one
+    if (pendingPlan.load(std::memory_order_acquire) != nullptr && retiredFifo.getFreeSpace() > 0)
+    {
+        if (fadeOutInEnabled.load(std::memory_order_relaxed) && activePlan != nullptr && !oldPlanFadedOut)
+        {
+            fadeOut = true; // One last block of the old topology, faded to silence
+        }
+        else
+        {
+            fadeIn = oldPlanFadedOut;
+            oldPlanFadedOut = false;
+            adoptPendingPlan();
+        }
+    }
+
+    renderBlock(buffer, midiMessages);
+
+    if (fadeOut)
+    {
+        buffer.applyGainRamp(0, buffer.getNumSamples(), 1.0f, 0.0f);
+        oldPlanFadedOut = true;
+    }
+    else if (fadeIn)
+    {
+        buffer.applyGainRamp(0, buffer.getNumSamples(), 0.0f, 1.0f);
+    }
+}
+
+void ParallelGraphProcessor::renderBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) noexcept
+{
+    if (activePlan == nullptr || activePlan->requiresGraphRenderer() || buffer.getNumSamples() > activePlan->getMaxBlockSize())
+    {
+        graph.processBlock(buffer, midiMessages);
+        return;
+    }
+
+    executor.render(*activePlan, buffer);
+    midiMessages.clear(); // The plan renders audio connections only
+
+    if (activePlan->hasDelayOverflow())
+        delayOverflow.store(true, std::memory_order_relaxed);
+}
+
+void ParallelGraphProcessor::changeListenerCallback(juce::ChangeBroadcaster *source)
+{
+    if (source == &graph)
+        requestPlan();
+}
+
+void ParallelGraphProcessor::timerCallback()
+{
+    reclaimPlans();
+
+    if (preparedBlockSize.load() > 0)
+        timingMonitor.captureHistory();
+
+    // The graph settles its latency when it rebuilds, after the change message that requested the plan
+    if (const int latency = graph.getLatencySamples(); latency != getLatencySamples())
+        setLatencySamples(latency);
+
+    // A plugin's latency outgrew the plan's delay lines: compile a plan sized for it
+    if (delayOverflow.exchange(false, std::memory_order_relaxed))
+        requestPlan();
+}
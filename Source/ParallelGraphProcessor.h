@@ -0,0 +1,154 @@
+/*
+ * ParallelGraphProcessor.h
+ * LightHost - 平行渲染 AudioProcessorGraph 的處理器
+ *
+ * 功能說明：
+ * - 取代 AudioProcessorGraph 成為 AudioProcessorPlayer 的處理器；圖形本身仍是編輯模型
+ *   （NodeGraphCanvas 照常新增節點與連線），只有渲染改由本類別負責
+ * - 互不相依的分支（例如麥克風鏈與音樂鏈）由 ParallelGraphExecutor 在多個核心上同時處理
+ * - 延遲補償由計畫自己的延遲線處理；外掛延遲超出延遲線容量時重新編譯
+ * - 每個節點的 processBlock 耗時記錄到 getTimingMonitor()，計時器同時記入歷史
+ * - 以下情況改用圖形自己的序列渲染：
+ *   - 尚未有計畫、圖形含有迴圈
+ *   - 區塊大於準備時的大小
+ *
+ * 拓撲交換（圖形變更時）：
+ * 1. 訊息執行緒擷取圖形快照（GraphRenderPlan::capture），交給背景編譯執行緒
+ * 2. 背景執行緒編譯計畫並配置所有緩衝區，以一次原子指標交換發布
+ * 3. 音頻執行緒在區塊開頭取走發布的計畫，舊計畫放入無鎖的回收佇列
+ * 4. 訊息執行緒的計時器釋放回收的計畫（連同已從圖形移除的節點）
+ * 音頻執行緒在交換過程中不取得任何鎖、不配置也不釋放記憶體
+ *
+ * 淡出再淡入（setFadeOutInEnabled，預設關閉）：
+ * - 新舊計畫共用同一批處理器，無法在同一區塊各算一次再交叉淡化（處理器的狀態會前進兩次）
+ * - 開啟時舊拓撲多算一個區塊並淡出到靜音，新拓撲的第一個區塊再淡入：輸出會短暫降到靜音
+ *   約兩個區塊，只適合寧可聽到一次短暫下沉、也不要接線瞬間的不連續的情況
+ *
+ * 通道配置與暫停由 GraphEditTransaction 對個別處理器進行：它關閉節點的 ProcessingGate，
+ * 計畫的步驟看到關閉的閘門就輸出靜音，音頻與工作執行緒都不取得處理器的 callback lock
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+#include "GraphRenderPlan.h"
+#include "NodeTimingMonitor.h"
+#include "ParallelGraphExecutor.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+class ParallelGraphProcessor : public juce::AudioProcessor,
+                               private juce::ChangeListener,
+                               private juce::Timer
+{
+public:
+    /**
+     * 建構子
+     *
+     * @param graphToRender 要渲染的圖形（生命週期需長於本物件）
+     * @param numWorkers    工作執行緒數；-1 表示 ParallelGraphExecutor::getDefaultNumWorkers()
+     */
+    explicit ParallelGraphProcessor(juce::AudioProcessorGraph &graphToRender, int numWorkers = -1);
+    ~ParallelGraphProcessor() override;
+
+    /** 目前的計畫是否以平行方式執行（供顯示與基準測試） */
+    [[nodiscard]] bool isRenderingInParallel() const noexcept { return parallel.load(std::memory_order_relaxed); }
+
+    /** 每個節點的耗時（由計畫渲染時才有資料） */
+    [[nodiscard]] NodeTimingMonitor &getTimingMonitor() noexcept { return timingMonitor; }
+
+    /** 拓撲交換時是否把舊拓撲淡出到靜音、再淡入新拓撲（預設關閉；會有約兩個區塊的音量下沉） */
+    void setFadeOutInEnabled(bool shouldFade) noexcept { fadeOutInEnabled.store(shouldFade, std::memory_order_relaxed); }
+    [[nodiscard]] bool isFadeOutInEnabled() const noexcept { return fadeOutInEnabled.load(std::memory_order_relaxed); }
+
+    /**
+     * requestPlan() 方法
+     * 擷取圖形目前的拓撲，交給背景執行緒編譯（訊息執行緒）；一般由圖形的變更通知觸發
+     * 連續的請求只會編譯最新的一個
+     */
+    void requestPlan();
+
+    //==============================================================================
+    const juce::String getName() const override { return graph.getName(); }
+    void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
+
+    bool isBusesLayoutSupported(const BusesLayout &) const override { return true; }
+
+    double getTailLengthSeconds() const override { return graph.getTailLengthSeconds(); }
+    bool acceptsMidi() const override { return graph.acceptsMidi(); }
+    bool producesMidi() const override { return graph.producesMidi(); }
+
+    juce::AudioProcessorEditor *createEditor() override { return nullptr; }
+    bool hasEditor() const override { return false; }
+
+    int getNumPrograms() override { return 1; }
+    int getCurrentProgram() override { return 0; }
+    void setCurrentProgram(int) override {}
+    const juce::String getProgramName(int) override { return {}; }
+    void changeProgramName(int, const juce::String &) override {}
+
+    void getStateInformation(juce::MemoryBlock &) override {}
+    void setStateInformation(const void *, int) override {}
+
+private:
+    class PlanBuilder;
+
+    /** 回收佇列的容量；滿了時音頻執行緒延後換上新計畫，而不是自己釋放 */
+    static constexpr int maxRetiredPlans = 16;
+
+    void changeListenerCallback(juce::ChangeBroadcaster *source) override;
+    void timerCallback() override;
+
+    /** 編譯最新的請求並發布（背景執行緒） */
+    void buildRequestedPlan();
+
+    /** 發布新計畫，取代尚未被音頻執行緒取走的計畫（非音頻執行緒） */
+    void publishPlan(std::unique_ptr<GraphRenderPlan> plan);
+
+    /** 交給訊息執行緒的計時器釋放（非音頻執行緒） */
+    void discardPlan(std::unique_ptr<GraphRenderPlan> plan);
+
+    /** 釋放音頻執行緒回收與被取代的計畫，並歸還它們的計時槽位（訊息執行緒） */
+    void reclaimPlans();
+
+    /** 換上發布的計畫，舊計畫放入回收佇列（音頻執行緒；呼叫前需確認佇列有空間） */
+    void adoptPendingPlan() noexcept;
+
+    /** 以計畫渲染一個區塊，計畫無法處理時改用圖形自己的渲染序列（音頻執行緒） */
+    void renderBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) noexcept;
+
+    juce::AudioProcessorGraph &graph;
+    const int requestedWorkers;
+
+    NodeTimingMonitor timingMonitor; // Outlives every plan, which record into it
+    ParallelGraphExecutor executor;
+    std::unique_ptr<PlanBuilder> builder;
+
+    juce::CriticalSection requestLock; // Message thread <-> builder; never taken by the audio thread
+    std::optional<GraphRenderPlan::Topology> requestedTopology;
+    std::vector<std::unique_ptr<GraphRenderPlan>> discardedPlans;
+
+    juce::CriticalSection buildLock; // Held while compiling, so prepareToPlay() never races a stale build
+
+    std::atomic<GraphRenderPlan *> pendingPlan{nullptr}; // Published, not yet adopted
+    GraphRenderPlan *activePlan = nullptr;                // Audio thread (or any thread while stopped)
+
+    juce::AbstractFifo retiredFifo{maxRetiredPlans}; // Audio thread -> message thread
+    std::array<GraphRenderPlan *, maxRetiredPlans> retiredPlans{};
+
+    std::atomic<bool> fadeOutInEnabled{false};
+    bool oldPlanFadedOut = false; // Audio thread
+
+    std::atomic<bool> parallel{false};
+    std::atomic<bool> delayOverflow{false}; // Audio thread -> timer: recompile with larger delay lines
+    std::atomic<int> preparedBlockSize{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParallelGraphProcessor)
+};
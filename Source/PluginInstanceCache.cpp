@@ -0,0 +1,193 @@
+/*
+ * PluginInstanceCache.cpp
+ * LightHost - 外掛實例快取實作
+ */
+
+#include "PluginInstanceCache.h"
+#include "GraphRenderPlan.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr int janitorIntervalMs = 1000;
+} // namespace
+
+PluginInstanceCache::PluginInstanceCache(Graph &graphToUse)
+    : Thread("LightHost instance cache"),
+      graph(graphToUse)
+{
+}
+
+PluginInstanceCache::~PluginInstanceCache()
+{
+    stopThread(4000);
+    toRelease.clear(); // Whatever the janitor had not reached yet
+}
+
+void PluginInstanceCache::setLimits(const Limits &newLimits)
+{
+    limits = newLimits;
+    maxAgeMs.store(limits.maxAgeSeconds * 1000.0);
+    enforceLimits(0, 0);
+
+    if (isEnabled() && !isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+}
+
+juce::int64 PluginInstanceCache::getEstimatedBytes() const noexcept
+{
+    juce::int64 total = 0;
+    for (const auto &entry : entries)
+        total += entry.bytes;
+    return total;
+}
+
+juce::int64 PluginInstanceCache::hashState(const juce::MemoryBlock &state) noexcept
+{
+    auto hash = (juce::uint64)0xcbf29ce484222325ull;
+    const auto *bytes = static_cast<const juce::uint8 *>(state.getData());
+    for (size_t i = 0; i < state.getSize(); ++i)
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    return (juce::int64)hash;
+}
+
+bool PluginInstanceCache::needsMessageThread(const juce::PluginDescription &description)
+{
+    // VST3 components and Audio Units expect their state calls on the UI thread; LV2 only allows
+    // other threads for plugins that declare it. VST2 and LADSPA work on any thread.
+    return description.pluginFormatName == "VST3" || description.pluginFormatName == "AudioUnit"
+           || description.pluginFormatName == "LV2";
+}
+
+//==============================================================================
+bool PluginInstanceCache::park(Graph::NodeID nodeId, const juce::PluginDescription &description, const juce::MemoryBlock &state)
+{
+    auto node = graph.getNodeForId(nodeId);
+    if (!isEnabled() || node == nullptr)
+        return false;
+
+    Entry entry;
+    entry.nodeId = nodeId;
+    entry.key = description.createIdentifierString();
+    entry.stateHash = hashState(state);
+    entry.bytes = (juce::int64)state.getSize() + limits.bytesPerInstance;
+    entry.parkedAtMs = juce::Time::getMillisecondCounterHiRes();
+    entry.messageThreadOnly = needsMessageThread(description);
+
+    // An instance bigger than the whole budget would only empty the cache and still break the limit
+    if (entry.bytes > limits.maxBytes)
+        return false;
+
+    // Make room first, so the new entry is never the one evicted
+    enforceLimits(1, entry.bytes);
+
+    // The next render plan leaves the node out; the graph keeps preparing it with everything else
+    node->properties.set(GraphRenderPlan::parkedProperty, true);
+    entries.push_back(entry);
+    updateOldest();
+    graph.sendChangeMessage(); // The renderer recompiles its plan on graph changes
+    return true;
+}
+
+PluginInstanceCache::Graph::Node::Ptr PluginInstanceCache::take(const juce::PluginDescription &description,
+                                                                std::optional<juce::int64> stateHash)
+{
+    const auto key = description.createIdentifierString();
+
+    // Newest first: the instance removed last is the one being brought back
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+    {
+        if (it->key != key || (stateHash.has_value() && it->stateHash != *stateHash))
+            continue;
+
+        auto node = graph.getNodeForId(it->nodeId);
+        entries.erase(std::next(it).base());
+        updateOldest();
+        if (node == nullptr)
+            return nullptr;
+
+        node->properties.remove(GraphRenderPlan::parkedProperty);
+        node->getProcessor()->reset(); // No tail from before it was removed
+        graph.sendChangeMessage();
+        return node;
+    }
+    return nullptr;
+}
+
+void PluginInstanceCache::clear()
+{
+    entries.clear();
+    updateOldest();
+}
+
+//==============================================================================
+void PluginInstanceCache::enforceLimits(int reserveInstances, juce::int64 reserveBytes)
+{
+    auto total = getEstimatedBytes();
+    while (!entries.empty()
+           && ((int)entries.size() + reserveInstances > limits.maxInstances || total + reserveBytes > limits.maxBytes))
+    {
+        total -= entries.front().bytes;
+        evict(0);
+    }
+}
+
+void PluginInstanceCache::evictExpired()
+{
+    expiryPending.store(false);
+
+    const auto now = juce::Time::getMillisecondCounterHiRes();
+    const auto maxAge = maxAgeMs.load();
+    while (!entries.empty() && maxAge > 0.0 && now - entries.front().parkedAtMs >= maxAge)
+        evict(0);
+}
+
+void PluginInstanceCache::evict(size_t index)
+{
+    const auto entry = entries[index];
+    entries.erase(entries.begin() + (std::ptrdiff_t)index);
+    updateOldest();
+
+    // Render plans built before the node was parked may still hold it; whoever lets go last deletes it
+    auto node = graph.removeNode(entry.nodeId, Graph::UpdateKind::async);
+    if (node == nullptr || entry.messageThreadOnly)
+        return;
+
+    const juce::ScopedLock lock(releaseLock);
+    toRelease.push_back(std::move(node));
+    notify();
+}
+
+void PluginInstanceCache::updateOldest() noexcept
+{
+    oldestParkedMs.store(entries.empty() ? 0.0 : entries.front().parkedAtMs);
+}
+
+void PluginInstanceCache::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(janitorIntervalMs);
+
+        // Deleting a plugin can take a while (sample libraries, impulse responses): not on the UI thread
+        std::vector<Graph::Node::Ptr> releasing;
+        {
+            const juce::ScopedLock lock(releaseLock);
+            releasing.swap(toRelease);
+        }
+        releasing.clear();
+
+        const auto oldest = oldestParkedMs.load();
+        const auto maxAge = maxAgeMs.load();
+        if (oldest > 0.0 && maxAge > 0.0 && juce::Time::getMillisecondCounterHiRes() - oldest >= maxAge
+            && !expiryPending.exchange(true))
+        {
+            juce::MessageManager::callAsync([cache = juce::WeakReference<PluginInstanceCache>(this)]
+                                            {
+                                                if (cache != nullptr)
+                                                    cache->evictExpired();
+                                            });
+        }
+    }
+}
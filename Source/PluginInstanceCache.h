@@ -0,0 +1,120 @@
+/*
+ * PluginInstanceCache.h
+ * LightHost - 最近移除的外掛實例快取（立即重新加入與復原刪除）
+ *
+ * 功能說明：
+ * - 刪除外掛節點時不銷毀實例：節點中斷所有連線後「暫存」在圖形中（Node::properties 的
+ *   GraphRenderPlan::parkedProperty），渲染計畫略過它，但圖形準備時仍一併重新準備，
+ *   因此取回時已是目前設備的採樣率與區塊大小，不需要重新建立、準備或還原狀態
+ * - 以外掛描述（createIdentifierString）與狀態雜湊為鍵；復原刪除取回狀態相同的實例，
+ *   從外掛清單重新加入取回同一外掛最近暫存的實例（保留它刪除前的設定）
+ * - LRU：超過實例數或估計記憶體上限時先逐出最久以前暫存的實例；
+ *   超過 maxAgeSeconds 未取回的實例由背景執行緒觸發逐出
+ * - 逐出時節點從圖形移除；VST2 / LADSPA 實例在背景執行緒銷毀（釋放取樣庫等可能很慢），
+ *   VST3 / AU / LV2 實例需要在訊息執行緒銷毀
+ *
+ * 限制：
+ * - 記憶體是估計值（狀態大小 + 每個實例固定的估計），外掛實際配置的記憶體無法得知
+ * - 圖形含有迴圈、改用 AudioProcessorGraph 自己的渲染序列時，暫存的節點仍會被處理（輸入為靜音）
+ *
+ * 執行緒：
+ * - 除非另有說明，所有方法只能在訊息執行緒呼叫（與圖形的編輯方法相同）
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+class PluginInstanceCache : private juce::Thread
+{
+public:
+    using Graph = juce::AudioProcessorGraph;
+
+    struct Limits
+    {
+        int maxInstances = 0;                             // 0 = 停用（刪除的外掛直接銷毀）
+        juce::int64 maxBytes = 512ll * 1024 * 1024;       // 估計的記憶體上限
+        juce::int64 bytesPerInstance = 16ll * 1024 * 1024; // 每個實例除了狀態以外的估計
+        double maxAgeSeconds = 600.0;                     // 超過此時間未取回就逐出；0 = 不限
+    };
+
+    explicit PluginInstanceCache(Graph &graph);
+    ~PluginInstanceCache() override;
+
+    /** 變更上限；超出新上限的實例立即逐出 */
+    void setLimits(const Limits &newLimits);
+    [[nodiscard]] const Limits &getLimits() const noexcept { return limits; }
+    [[nodiscard]] bool isEnabled() const noexcept { return limits.maxInstances > 0; }
+
+    [[nodiscard]] int getNumInstances() const noexcept { return (int)entries.size(); }
+    [[nodiscard]] juce::int64 getEstimatedBytes() const noexcept;
+
+    /** 外掛狀態的雜湊（64 位元 FNV-1a） */
+    [[nodiscard]] static juce::int64 hashState(const juce::MemoryBlock &state) noexcept;
+
+    /** 這些格式的實例只能在訊息執行緒還原狀態與銷毀（VST3、Audio Unit、LV2） */
+    [[nodiscard]] static bool needsMessageThread(const juce::PluginDescription &description);
+
+    /**
+     * park() 方法
+     * 暫存已中斷所有連線的外掛節點；需要時先逐出較舊的實例
+     *
+     * @param nodeId      圖形節點（呼叫端已移除它的連線）
+     * @param description 外掛描述
+     * @param state       目前的狀態（只用於雜湊與記憶體估計）
+     * @return 已暫存；快取停用、節點不存在或實例單獨就超過 maxBytes 時回傳 false，呼叫端應自行移除節點
+     */
+    bool park(Graph::NodeID nodeId, const juce::PluginDescription &description, const juce::MemoryBlock &state);
+
+    /**
+     * take() 方法
+     * 取回暫存的節點並解除暫存標記（呼叫端接上連線並重建後才會被渲染）
+     *
+     * @param description 外掛描述
+     * @param stateHash   要求狀態相同時的雜湊；空值表示取同一外掛最近暫存的實例
+     * @return 節點；沒有符合的實例時為 nullptr
+     */
+    Graph::Node::Ptr take(const juce::PluginDescription &description, std::optional<juce::int64> stateHash);
+
+    /** 忘記所有暫存的節點（呼叫端即將 graph.clear()） */
+    void clear();
+
+private:
+    struct Entry
+    {
+        Graph::NodeID nodeId;
+        juce::String key;
+        juce::int64 stateHash = 0;
+        juce::int64 bytes = 0;
+        double parkedAtMs = 0.0;
+        bool messageThreadOnly = false;
+    };
+
+    /** 背景執行緒：銷毀逐出的實例、觸發到期的逐出 */
+    void run() override;
+
+    /** 逐出到期的實例（訊息執行緒，由背景執行緒觸發） */
+    void evictExpired();
+    /** 逐出直到符合上限；reserveBytes 為即將暫存的實例預留 */
+    void enforceLimits(int reserveInstances, juce::int64 reserveBytes);
+    void evict(size_t index);
+    void updateOldest() noexcept;
+
+    Graph &graph;
+    Limits limits;
+    std::vector<Entry> entries; // Oldest first; message thread only
+
+    juce::CriticalSection releaseLock;
+    std::vector<Graph::Node::Ptr> toRelease; // Evicted nodes whose last reference the janitor drops
+
+    std::atomic<double> oldestParkedMs{0.0}; // 0 = empty; read by the janitor
+    std::atomic<double> maxAgeMs{0.0};
+    std::atomic<bool> expiryPending{false};
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(PluginInstanceCache)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginInstanceCache)
+};
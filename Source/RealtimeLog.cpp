@@ -0,0 +1,259 @@
+/*
+ * RealtimeLog.cpp
+ * LightHost - 即時安全日誌的背景處理
+ *
+ * 環形緩衝區演算法：Dmitry Vyukov 的 bounded MPMC queue
+ * - 每個 cell 帶有序號；生產者以 CAS 取得位置，寫完記錄後發布序號
+ * - 消費者（背景執行緒）只讀取已發布的 cell
+ *
+ * 日誌檔輪替：
+ * - LightHost.log 超過 maxLogFileSize 時依序改名為 LightHost.1.log ... LightHost.N.log
+ */
+
+#include "RealtimeLog.h"
+
+namespace
+{
+    constexpr juce::int64 maxLogFileSize = 1024 * 1024; // 1 MB
+    constexpr int numRotatedFiles = 3;
+    constexpr int drainIntervalMs = 20;
+
+    const char *levelName(RealtimeLog::Level level)
+    {
+        switch (level)
+        {
+        case RealtimeLog::Level::debug:
+            return "DEBUG";
+        case RealtimeLog::Level::info:
+            return "INFO ";
+        case RealtimeLog::Level::warning:
+            return "WARN ";
+        case RealtimeLog::Level::error:
+            return "ERROR";
+        }
+        return "?";
+    }
+} // namespace
+
+//==============================================================================
+/**
+ * DrainThread 類別
+ * 定期取出環形緩衝區中的記錄並寫入日誌檔
+ *
+ * 以輪詢代替事件通知：音頻執行緒不能呼叫會加鎖的 WaitableEvent::signal()
+ */
+class RealtimeLog::DrainThread : public juce::Thread
+{
+public:
+    explicit DrainThread(RealtimeLog &ownerToUse) : Thread("LightHost log writer"), owner(ownerToUse) {}
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            owner.drain();
+            wait(drainIntervalMs);
+        }
+    }
+
+private:
+    RealtimeLog &owner;
+};
+
+//==============================================================================
+RealtimeLog &RealtimeLog::getInstance()
+{
+    static RealtimeLog instance;
+    return instance;
+}
+
+RealtimeLog::RealtimeLog()
+{
+    for (std::size_t i = 0; i < (std::size_t)capacity; ++i)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+
+    anchorTicks = juce::Time::getHighResolutionTicks();
+    anchorMillis = juce::Time::currentTimeMillis();
+}
+
+RealtimeLog::~RealtimeLog()
+{
+    stop();
+}
+
+void RealtimeLog::start(const juce::File &logDirectory)
+{
+    if (drainThread != nullptr)
+        return;
+
+    logDirectory.createDirectory();
+    logFile = logDirectory.getChildFile("LightHost.log");
+    logStream = std::make_unique<juce::FileOutputStream>(logFile);
+    if (logStream->failedToOpen())
+        logStream = nullptr;
+
+    drainThread = std::make_unique<DrainThread>(*this);
+    drainThread->startThread(juce::Thread::Priority::low);
+}
+
+void RealtimeLog::stop()
+{
+    if (drainThread != nullptr)
+    {
+        drainThread->stopThread(1000);
+        drainThread = nullptr;
+    }
+
+    drain(); // Whatever is still queued
+    logStream = nullptr;
+}
+
+//==============================================================================
+bool RealtimeLog::tryPush(const Record &record) noexcept
+{
+    auto position = enqueuePosition.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto &cell = cells[position & (capacity - 1)];
+        const auto sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto difference = (std::intptr_t)sequence - (std::intptr_t)position;
+
+        if (difference == 0)
+        {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                cell.record = record;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false; // Full
+        }
+        else
+        {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool RealtimeLog::tryPop(Record &record) noexcept
+{
+    auto position = dequeuePosition.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto &cell = cells[position & (capacity - 1)];
+        const auto sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto difference = (std::intptr_t)sequence - (std::intptr_t)(position + 1);
+
+        if (difference == 0)
+        {
+            if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                record = cell.record;
+                cell.sequence.store(position + capacity, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false; // Empty
+        }
+        else
+        {
+            position = dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//==============================================================================
+juce::String RealtimeLog::formatRecord(const Record &record) const
+{
+    const auto millis = anchorMillis + (juce::int64)(juce::Time::highResolutionTicksToSeconds(record.ticks - anchorTicks) * 1000.0);
+    juce::String line = juce::Time(millis).toString(true, true, true, true) + "  " + levelName(record.level) + "  ";
+
+    int argIndex = 0;
+    const char *literal = record.format;
+    for (const char *p = record.format; p != nullptr && *p != 0; ++p)
+    {
+        if (p[0] != '{' || p[1] != '}' || argIndex >= record.numArgs)
+            continue;
+
+        line << juce::String(literal, (size_t)(p - literal));
+
+        const auto &arg = record.args[argIndex++];
+        switch (arg.type)
+        {
+        case Arg::Type::integer:
+            line << (juce::int64)arg.i;
+            break;
+        case Arg::Type::real:
+            line << juce::String(arg.d, 3);
+            break;
+        case Arg::Type::text:
+            line << (arg.s != nullptr ? arg.s : "(null)");
+            break;
+        }
+
+        literal = ++p + 1;
+    }
+
+    if (literal != nullptr)
+        line << literal;
+
+    return line;
+}
+
+void RealtimeLog::drain()
+{
+    Record record;
+    while (tryPop(record))
+        writeLine(formatRecord(record));
+
+    const auto dropped = numDropped.load(std::memory_order_relaxed);
+    if (dropped != numDroppedReported)
+    {
+        writeLine("RealtimeLog: " + juce::String((juce::int64)(dropped - numDroppedReported)) + " records dropped (queue full)");
+        numDroppedReported = dropped;
+    }
+
+    if (logStream != nullptr)
+        logStream->flush();
+}
+
+void RealtimeLog::writeLine(const juce::String &line)
+{
+    juce::Logger::outputDebugString(line);
+
+    if (logStream == nullptr)
+        return;
+
+    logStream->writeText(line + juce::newLine, false, false, nullptr);
+    rotateIfNeeded();
+}
+
+void RealtimeLog::rotateIfNeeded()
+{
+    if (logStream->getPosition() < maxLogFileSize)
+        return;
+
+    logStream = nullptr;
+
+    // LightHost.log -> LightHost.1.log -> ... -> LightHost.N.log (oldest dropped)
+    auto rotated = [this](int index)
+    {
+        return logFile.getSiblingFile(logFile.getFileNameWithoutExtension() + "." + juce::String(index) + logFile.getFileExtension());
+    };
+
+    rotated(numRotatedFiles).deleteFile();
+    for (int i = numRotatedFiles - 1; i >= 1; --i)
+        rotated(i).moveFileTo(rotated(i + 1));
+    logFile.moveFileTo(rotated(1));
+
+    logStream = std::make_unique<juce::FileOutputStream>(logFile);
+    if (logStream->failedToOpen())
+        logStream = nullptr;
+}
@@ -0,0 +1,222 @@
+/*
+ * RealtimeLog.h
+ * LightHost - 音頻執行緒可用的即時安全日誌
+ *
+ * 功能說明：
+ * - 固定容量、無鎖的日誌記錄環形緩衝區（Vyukov bounded MPMC queue）
+ * - 音頻執行緒只寫入二進位記錄（時間戳、等級、格式字串指標、數值參數），
+ *   不配置記憶體、不格式化字串、不呼叫系統 API
+ * - 背景執行緒取出記錄、格式化並寫入輪替日誌檔，同時輸出到除錯器
+ * - 支援日誌等級；LIGHTHOST_RTLOG_ENABLED=0 時所有 RTLOG_* 巨集完全移除
+ *
+ * 使用方式：
+ *   RTLOG_INFO("STARTING: sr={} buf={}", sampleRate, bufferSize);
+ *
+ * 注意：
+ * - 格式字串與 const char* 參數必須是字串常量（只保存指標）
+ * - 參數只接受整數、浮點數、bool 與字串常量，最多 maxArgs 個
+ * - 環形緩衝區已滿時記錄會被丟棄並計數，不會阻塞
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// 編譯期開關：預設只在除錯版本啟用，發行版本的 RTLOG_* 巨集不產生任何程式碼
+#ifndef LIGHTHOST_RTLOG_ENABLED
+#if JUCE_DEBUG
+#define LIGHTHOST_RTLOG_ENABLED 1
+#else
+#define LIGHTHOST_RTLOG_ENABLED 0
+#endif
+#endif
+
+/**
+ * RealtimeLog 類別
+ *
+ * 單例；start() 啟動背景寫檔執行緒，stop() 寫出剩餘記錄並停止。
+ * 未啟動時 push() 仍然安全，記錄會留在環形緩衝區直到啟動或被丟棄。
+ */
+class RealtimeLog
+{
+public:
+    enum class Level : std::uint8_t
+    {
+        debug,
+        info,
+        warning,
+        error
+    };
+
+    static constexpr int maxArgs = 6;
+    static constexpr int capacity = 1024; // 必須是 2 的次方
+
+    /**
+     * Arg 結構
+     * 單一格式參數的二進位表示
+     */
+    struct Arg
+    {
+        enum class Type : std::uint8_t
+        {
+            integer,
+            real,
+            text
+        };
+
+        Type type = Type::integer;
+        union
+        {
+            std::int64_t i;
+            double d;
+            const char *s;
+        };
+
+        Arg() noexcept : i(0) {}
+    };
+
+    /**
+     * Record 結構
+     * 環形緩衝區中的一筆記錄
+     */
+    struct Record
+    {
+        std::int64_t ticks = 0; // juce::Time::getHighResolutionTicks()
+        const char *format = nullptr;
+        Level level = Level::info;
+        std::uint8_t numArgs = 0;
+        Arg args[maxArgs];
+    };
+
+    static RealtimeLog &getInstance();
+
+    /**
+     * start() 方法
+     * 啟動背景寫檔執行緒（訊息執行緒）
+     *
+     * @param logDirectory 日誌檔所在目錄；不存在時會建立
+     */
+    void start(const juce::File &logDirectory);
+
+    /** 寫出剩餘記錄並停止背景執行緒 */
+    void stop();
+
+    /** 設定執行期最低等級（低於此等級的記錄在 push() 時直接略過） */
+    void setMinimumLevel(Level newLevel) noexcept { minimumLevel.store(newLevel, std::memory_order_relaxed); }
+
+    [[nodiscard]] bool isLevelEnabled(Level level) const noexcept
+    {
+        return level >= minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    /** 因環形緩衝區已滿而被丟棄的記錄數 */
+    [[nodiscard]] std::uint64_t getNumDropped() const noexcept { return numDropped.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] juce::File getLogFile() const { return logFile; }
+
+    /**
+     * push() 方法
+     * 寫入一筆記錄；不配置記憶體、不加鎖，可在音頻執行緒呼叫
+     *
+     * @param level  日誌等級
+     * @param format 含 {} 佔位符的字串常量
+     * @param args   數值或字串常量參數
+     */
+    template <typename... Args>
+    void push(Level level, const char *format, Args... args) noexcept
+    {
+        static_assert(sizeof...(Args) <= maxArgs, "Too many RealtimeLog arguments");
+
+        if (!isLevelEnabled(level))
+            return;
+
+        Record record;
+        record.ticks = juce::Time::getHighResolutionTicks();
+        record.format = format;
+        record.level = level;
+        record.numArgs = (std::uint8_t)sizeof...(Args);
+
+        int index = 0;
+        (encode(record.args[index++], args), ...);
+        juce::ignoreUnused(index);
+
+        if (!tryPush(record))
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** 將記錄格式化為一行文字（背景執行緒使用） */
+    [[nodiscard]] juce::String formatRecord(const Record &record) const;
+
+private:
+    RealtimeLog();
+    ~RealtimeLog();
+
+    template <typename T>
+    static void encode(Arg &arg, T value) noexcept
+    {
+        if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>)
+        {
+            arg.type = Arg::Type::text;
+            arg.s = value;
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            arg.type = Arg::Type::real;
+            arg.d = (double)value;
+        }
+        else
+        {
+            static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "RealtimeLog only accepts numbers and string literals");
+            arg.type = Arg::Type::integer;
+            arg.i = (std::int64_t)value;
+        }
+    }
+
+    bool tryPush(const Record &record) noexcept;
+    bool tryPop(Record &record) noexcept;
+
+    void drain();
+    void writeLine(const juce::String &line);
+    void rotateIfNeeded();
+
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence{0};
+        Record record;
+    };
+
+    class DrainThread;
+
+    Cell cells[capacity];
+    alignas(64) std::atomic<std::size_t> enqueuePosition{0};
+    alignas(64) std::atomic<std::size_t> dequeuePosition{0};
+    alignas(64) std::atomic<std::uint64_t> numDropped{0};
+    std::uint64_t numDroppedReported = 0;
+    std::atomic<Level> minimumLevel{Level::debug};
+
+    // Wall-clock anchor used to turn high resolution ticks into timestamps
+    std::int64_t anchorTicks = 0;
+    juce::int64 anchorMillis = 0;
+
+    juce::File logFile;
+    std::unique_ptr<juce::FileOutputStream> logStream;
+    std::unique_ptr<DrainThread> drainThread;
+
+    JUCE_DECLARE_NON_COPYABLE(RealtimeLog)
+};
+
+#if LIGHTHOST_RTLOG_ENABLED
+#define RTLOG_DEBUG(format, ...) RealtimeLog::getInstance().push(RealtimeLog::Level::debug, format, ##__VA_ARGS__)
+#define RTLOG_INFO(format, ...) RealtimeLog::getInstance().push(RealtimeLog::Level::info, format, ##__VA_ARGS__)
+#define RTLOG_WARNING(format, ...) RealtimeLog::getInstance().push(RealtimeLog::Level::warning, format, ##__VA_ARGS__)
+#define RTLOG_ERROR(format, ...) RealtimeLog::getInstance().push(RealtimeLog::Level::error, format, ##__VA_ARGS__)
+#else
+#define RTLOG_DEBUG(format, ...) ((void)0)
+#define RTLOG_INFO(format, ...) ((void)0)
+#define RTLOG_WARNING(format, ...) ((void)0)
+#define RTLOG_ERROR(format, ...) ((void)0)
+#endif
@@ -25,14 +25,19 @@
 #include "JuceHeader.h"
 #include "VoicemeeterAudioDevice.h"
 
-#if JUCE_WINDOWS // Windows 平台專用
+#if JUCE_WINDOWS || LIGHTHOST_VOICEMEETER_STANDIN // Windows 平台專用（或 stand-in 建置）
 #include <array>
 #include <string_view>
 #include <ranges>
 
+#if JUCE_WINDOWS
 #include <windows.h>
+#endif
 #include <cstring>
 
+#include "VoicemeeterLayout.h"
+#include "RealtimeLog.h"
+
 // ==================== 日誌系統 ====================
 
 /**
@@ -50,6 +55,10 @@
  * 查看日誌：
  * - Windows 系統：使用 DebugView (Sysinternals)
  * - Visual Studio：Debug > Windows > Output
+ * - 其他平台（stand-in 建置）：輸出到 stderr
+ *
+ * 注意：會配置記憶體並呼叫系統 API，只能在非即時執行緒使用；
+ * 音頻回調中請改用 RealtimeLog.h 的 RTLOG_* 巨集
  *
  * @param msg 要輸出的訊息字符串
  */
@@ -57,13 +66,18 @@ static void vmLog(const juce::String &msg)
 {
     // 建立帶時間戳的日誌行
     juce::String line = juce::Time::getCurrentTime().toString(true, true, true, true) + "  " + msg + "\n";
+#if JUCE_WINDOWS
     // 發送到 Windows 調試系統
     OutputDebugStringW(line.toWideCharPointer());
+#else
+    juce::Logger::outputDebugString(line.trimEnd());
+#endif
 }
 
 // 方便的日誌宏
 #define VMLOG(x) vmLog(x)
 
+#if ! LIGHTHOST_VOICEMEETER_STANDIN
 // ==================== Windows Registry 設定 ====================
 
 /**
@@ -98,6 +112,7 @@ constexpr std::wstring_view vmDllName = L"VoicemeeterRemote64.dll"; // 64 位 DL
 #else
 constexpr std::wstring_view vmDllName = L"VoicemeeterRemote.dll"; // 32 位 DLL
 #endif
+#endif // ! LIGHTHOST_VOICEMEETER_STANDIN
 
 // ==================== 靜態音頻回調 ====================
 
@@ -135,6 +150,50 @@ static long __stdcall voicemeeterStaticCallback(void *lpUser, long nCommand,
     return 0; // 返回成功
 }
 
+// ==================== 直通輔助函數 ====================
+
+/**
+ * copyThrough() 函數
+ * 將輸入通道原樣送到輸出通道（直通模式）
+ *
+ * 輸入與輸出指向同一塊記憶體（原地插入）時不做任何事；
+ * 沒有對應輸入的輸出通道會被清為靜音
+ */
+static void copyThrough(const float *const *inputs, int numInputs,
+                        float *const *outputs, int numOutputs, int numSamples) noexcept
+{
+    for (int ch = 0; ch < numOutputs; ++ch)
+    {
+        if (ch >= numInputs)
+            juce::FloatVectorOperations::clear(outputs[ch], numSamples);
+        else if (outputs[ch] != inputs[ch])
+            juce::FloatVectorOperations::copy(outputs[ch], inputs[ch], numSamples);
+    }
+}
+
+/**
+ * crossfadeToDry() 函數
+ * 在一個緩衝區內於處理結果（outputs）與原始輸入（dry）之間線性交叉淡化
+ *
+ * @param toDry true = 處理結果淡出、原始輸入淡入（進入直通）；false 則相反
+ */
+static void crossfadeToDry(float *const *outputs, int numOutputs,
+                           const juce::AudioBuffer<float> &dry, int numSamples, bool toDry) noexcept
+{
+    const float step = 1.0f / (float)numSamples;
+    for (int ch = 0; ch < numOutputs; ++ch)
+    {
+        float *out = outputs[ch];
+        const float *in = dry.getReadPointer(ch);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float dryGain = toDry ? (float)(i + 1) * step : 1.0f - (float)(i + 1) * step;
+            out[i] = out[i] * (1.0f - dryGain) + in[i] * dryGain;
+        }
+    }
+}
+
+#if ! LIGHTHOST_VOICEMEETER_STANDIN
 // ==================== Registry 讀取輔助函數 ====================
 
 /**
@@ -163,6 +222,7 @@ static juce::String readRegistryString(std::wstring_view keyPath, std::wstring_v
 
     return juce::String(buffer.data());
 }
+#endif // ! LIGHTHOST_VOICEMEETER_STANDIN
 
 //==============================================================================
 // VoicemeeterAPI Singleton
@@ -174,6 +234,39 @@ VoicemeeterAPI &VoicemeeterAPI::getInstance()
     return instance;
 }
 
+#if LIGHTHOST_VOICEMEETER_STANDIN
+
+VoicemeeterAPI::VoicemeeterAPI()
+{
+    memset(&vmr, 0, sizeof(vmr));
+
+    // Headless builds link the in-process stand-in instead of loading the DLL
+#define VM_BIND(name) \
+    vmr.name = &::name
+    VM_BIND(VBVMR_Login);
+    VM_BIND(VBVMR_Logout);
+    VM_BIND(VBVMR_GetVoicemeeterType);
+    VM_BIND(VBVMR_GetVoicemeeterVersion);
+    VM_BIND(VBVMR_IsParametersDirty);
+    VM_BIND(VBVMR_AudioCallbackRegister);
+    VM_BIND(VBVMR_AudioCallbackStart);
+    VM_BIND(VBVMR_AudioCallbackStop);
+    VM_BIND(VBVMR_AudioCallbackUnregister);
+#undef VM_BIND
+
+    dllLoaded = true;
+    VMLOG("Voicemeeter stand-in bound (no DLL loaded)");
+}
+
+VoicemeeterAPI::~VoicemeeterAPI() = default;
+
+int VoicemeeterAPI::detectTypeFromRegistry() const
+{
+    return 0; // No registry: scanForDevices() asks the stand-in via GetVoicemeeterType
+}
+
+#else
+
 VoicemeeterAPI::VoicemeeterAPI()
 {
     memset(&vmr, 0, sizeof(vmr));
@@ -265,6 +358,8 @@ int VoicemeeterAPI::detectTypeFromRegistry() const
         return 1; // Standard (1 output bus A1)
 }
 
+#endif // LIGHTHOST_VOICEMEETER_STANDIN
+
 //==============================================================================
 // VoicemeeterAudioIODevice
 //==============================================================================
@@ -272,23 +367,40 @@ int VoicemeeterAPI::detectTypeFromRegistry() const
 VoicemeeterAudioIODevice::VoicemeeterAudioIODevice(const juce::String &outputBusName,
                                                    const juce::String &inBusName,
                                                    int inBusIdx,
-                                                   int outBusIdx)
+                                                   int outBusIdx,
+                                                   VoicemeeterLayout layout,
+                                                   InsertPoint insert)
     : AudioIODevice(outputBusName, "Voicemeeter"),
       inputBusIndex(inBusIdx),
       outputBusIndex(outBusIdx),
-      inputBusName(inBusName)
+      inputBusName(inBusName),
+      busLayout(layout),
+      insertPoint(insert)
 {
 }
 
 VoicemeeterAudioIODevice::~VoicemeeterAudioIODevice()
 {
-    aliveFlag->store(false);
+    cancelPendingUpdate();
     close();
 }
 
 juce::StringArray VoicemeeterAudioIODevice::getOutputChannelNames()
 {
     juce::StringArray names;
+    if (insertPoint == InsertPoint::main)
+    {
+        // Every bus: A1..An, B1..Bn
+        for (int bus = 0; bus < busLayout.getNumBuses(); ++bus)
+        {
+            const auto busName = bus < busLayout.numHardwareBuses ? "A" + juce::String(bus + 1)
+                                                                  : "B" + juce::String(bus - busLayout.numHardwareBuses + 1);
+            for (int i : std::views::iota(1, channelsPerBus + 1))
+                names.add(busName + " Channel " + juce::String(i));
+        }
+        return names;
+    }
+
     for (int i : std::views::iota(1, channelsPerBus + 1))
         names.add("Channel " + juce::String(i));
     return names;
@@ -296,7 +408,20 @@ juce::StringArray VoicemeeterAudioIODevice::getOutputChannelNames()
 
 juce::StringArray VoicemeeterAudioIODevice::getInputChannelNames()
 {
-    return getOutputChannelNames(); // Same channels for insert mode
+    if (insertPoint != InsertPoint::main)
+        return getOutputChannelNames(); // Same channels for insert mode
+
+    // Buses first so input channel n is the unprocessed signal of output channel n,
+    // then every input strip
+    auto names = getOutputChannelNames();
+    for (int strip = 0; strip < busLayout.getNumStrips(); ++strip)
+    {
+        const auto stripName = strip < busLayout.numHardwareStrips ? "Hardware Input " + juce::String(strip + 1)
+                                                                   : "Virtual Input " + juce::String(strip - busLayout.numHardwareStrips + 1);
+        for (int i : std::views::iota(1, channelsPerBus + 1))
+            names.add(stripName + " Channel " + juce::String(i));
+    }
+    return names;
 }
 
 std::optional<juce::BigInteger> VoicemeeterAudioIODevice::getDefaultOutputChannels() const
@@ -333,7 +458,7 @@ juce::String VoicemeeterAudioIODevice::open(const juce::BigInteger &inputChannel
                                             double sampleRate,
                                             int bufferSizeSamples)
 {
-    VMLOG("=== open() outBus=" + getName() + "(" + juce::String(outputBusIndex) + ")" + " inBus=" + inputBusName + "(" + juce::String(inputBusIndex) + ")" + " sr=" + juce::String(sampleRate) + " buf=" + juce::String(bufferSizeSamples));
+    VMLOG("=== open() insert=" + juce::String(insertPoint == InsertPoint::inputStrip ? "input strip" : insertPoint == InsertPoint::main ? "main" : "output bus") + " outBus=" + getName() + "(" + juce::String(outputBusIndex) + ")" + " inBus=" + inputBusName + "(" + juce::String(inputBusIndex) + ")" + " sr=" + juce::String(sampleRate) + " buf=" + juce::String(bufferSizeSamples));
     VMLOG("  inChans=" + inputChannels.toString(2) + " outChans=" + outputChannels.toString(2));
     close();
 
@@ -351,11 +476,13 @@ juce::String VoicemeeterAudioIODevice::open(const juce::BigInteger &inputChannel
 
     loggedIn = true;
 
-    // Register audio callback — always use OUT mode which provides all bus
-    // read channels (audiobuffer_r) and write channels (audiobuffer_w).
-    // This lets us read from any input bus and write to any output bus.
+    // Register audio callback. OUT mode provides all bus read channels
+    // (audiobuffer_r) and write channels (audiobuffer_w), so we can read from
+    // any bus and write to any bus. IN mode provides every input strip before
+    // Voicemeeter's mixer, which is where a mic chain belongs. MAIN mode
+    // provides every strip and bus at once for the single wide device.
     char clientName[64] = "LightHost";
-    long mode = VBVMR_AUDIOCALLBACK_OUT;
+    const long mode = getCallbackMode();
     VMLOG("VBVMR_AudioCallbackRegister mode=" + juce::String(mode));
     long regResult = vmr.VBVMR_AudioCallbackRegister(mode,
                                                      voicemeeterStaticCallback,
@@ -383,20 +510,66 @@ juce::String VoicemeeterAudioIODevice::open(const juce::BigInteger &inputChannel
     callbackRegistered = true;
 
     // Store requested settings.
-    // Limit active channels to channelsPerBus — the raw bitmask from JUCE may
-    // have hundreds of bits set, which would confuse AudioProcessorPlayer.
+    // Limit active channels to the device's channels — the raw bitmask from JUCE
+    // may have hundreds of bits set, which would confuse AudioProcessorPlayer.
+    const int numDeviceInputs = getNumDeviceInputs();
+    const int numDeviceOutputs = getNumDeviceOutputs();
     activeInputChannels = 0;
     activeOutputChannels = 0;
-    for (int ch : std::views::iota(0, channelsPerBus))
-    {
+    VoicemeeterChannelMap::Mask inputMask, outputMask;
+    for (int ch : std::views::iota(0, numDeviceInputs))
         if (inputChannels[ch])
+        {
             activeInputChannels.setBit(ch);
+            inputMask.set((size_t)ch);
+        }
+    for (int ch : std::views::iota(0, numDeviceOutputs))
         if (outputChannels[ch])
+        {
             activeOutputChannels.setBit(ch);
+            outputMask.set((size_t)ch);
+        }
+    currentSampleRate.store(sampleRate);
+    currentBufferSize.store(bufferSizeSamples);
+    VMLOG("open() activeChannels limited to " + juce::String(numDeviceInputs) + " in / " + juce::String(numDeviceOutputs) + " out");
+
+    // Precompute the channel pointer tables for the expected buffer (one bus or
+    // strip, or in MAIN mode all of them). A different nbi/nbo rebuilds them in place.
+    int inputSlots[VoicemeeterChannelMap::maxChannels], outputSlots[VoicemeeterChannelMap::maxChannels];
+    const int numBusChannels = busLayout.getNumBusChannels();
+    const int numStripChannels = busLayout.getNumStripChannels();
+    for (int ch = 0; ch < numDeviceInputs; ++ch)
+    {
+        if (insertPoint == InsertPoint::main) // audiobuffer_r = strips, then buses
+            inputSlots[ch] = ch < numBusChannels ? numStripChannels + ch : ch - numBusChannels;
+        else
+            inputSlots[ch] = inputBusIndex * channelsPerBus + ch;
     }
-    currentSampleRate = sampleRate;
-    currentBufferSize = bufferSizeSamples;
-    VMLOG("open() activeChannels set to " + juce::String(channelsPerBus) + " channels");
+    for (int ch = 0; ch < numDeviceOutputs; ++ch)
+        outputSlots[ch] = insertPoint == InsertPoint::main ? ch : outputBusIndex * channelsPerBus + ch;
+
+    channelMap.setSelection(inputSlots, numDeviceInputs, inputMask, outputSlots, numDeviceOutputs, outputMask);
+    channelMap.resolve(getNumBufferInputs(), getNumBufferOutputs());
+
+    // MAIN mode owns every bus: the ones the graph does not drive are copied through
+    untouchedBusChannels.clear();
+    if (insertPoint == InsertPoint::main)
+        for (int ch = 0; ch < numBusChannels; ++ch)
+            if (!outputMask[(size_t)ch])
+                untouchedBusChannels.push_back(ch);
+
+    silenceBuffer.clear();
+    scratchBuffer.clear();
+    ensureBufferCapacity(bufferSizeSamples);
+    recoveryStartTicks = 0;
+    deadlineMonitor.reset();
+    passThroughActive = passThroughRequested.load();
+
+    reblocker.prepare(juce::jmax(numDeviceInputs, numDeviceOutputs), fixedBlockSize);
+    reblocker.reset(bufferSizeSamples);
+    if (reblocker.isActive())
+        VMLOG("open() re-blocking " + juce::String(bufferSizeSamples) + " -> " + juce::String(reblocker.getBlockSize()) + " samples, latency=" + juce::String(reblocker.getLatencySamples()));
+    VMLOG("open() channel map numActiveIn=" + juce::String(channelMap.getInput().numActive) + " numActiveOut=" + juce::String(channelMap.getOutput().numActive) + " nbi=" + juce::String(getNumBufferInputs()) + " nbo=" + juce::String(getNumBufferOutputs()));
 
     deviceOpen = true;
     lastError = {};
@@ -451,10 +624,17 @@ void VoicemeeterAudioIODevice::start(juce::AudioIODeviceCallback *callback)
 
         // ALWAYS notify the callback with current settings so the plugin graph
         // is prepared before any audio buffers arrive.
-        VMLOG("Calling audioDeviceAboutToStart sr=" + juce::String(currentSampleRate) + " buf=" + juce::String(currentBufferSize));
+        VMLOG("Calling audioDeviceAboutToStart sr=" + juce::String(currentSampleRate.load()) + " buf=" + juce::String(currentBufferSize.load()));
         callback->audioDeviceAboutToStart(this);
         VMLOG("audioDeviceAboutToStart() returned OK");
 
+        // The graph is ready for the requested configuration; STARTING only
+        // re-prepares if Voicemeeter reports a different one
+        preparedSampleRate.store(currentSampleRate.load());
+        preparedBufferSize.store(currentBufferSize.load());
+        restartPending.store(false);
+        streamStatus.store(packStatus(generationOf(streamStatus.load()), StreamState::running), std::memory_order_release);
+
         auto &api = VoicemeeterAPI::getInstance();
         if (api.isAvailable())
         {
@@ -468,6 +648,12 @@ void VoicemeeterAudioIODevice::start(juce::AudioIODeviceCallback *callback)
         }
 
         devicePlaying = true;
+
+        // Watch the connection from here on; a stream that never starts counts as stalled
+        lastSeenBufferCount = bufferCounter.load(std::memory_order_acquire);
+        lastProgressMs = juce::Time::getMillisecondCounterHiRes();
+        reconnecting = false;
+        startTimer(watchdogIntervalMs);
         VMLOG("start() complete");
     }
 }
@@ -477,6 +663,10 @@ void VoicemeeterAudioIODevice::stop()
     VMLOG("=== stop() devicePlaying=" + juce::String((int)devicePlaying));
     if (devicePlaying)
     {
+        stopTimer();
+        reconnecting = false;
+        gapStartTicks.store(0);
+
         auto &api = VoicemeeterAPI::getInstance();
         if (api.isAvailable())
             api.getInterface().VBVMR_AudioCallbackStop();
@@ -484,6 +674,13 @@ void VoicemeeterAudioIODevice::stop()
         auto *cb = juceCallback.exchange(nullptr);
         devicePlaying = false;
 
+        // The player releases the graph in audioDeviceStopped()
+        cancelPendingUpdate();
+        restartPending.store(false);
+        streamStatus.store(packStatus(generationOf(streamStatus.load()) + 1, StreamState::stopped), std::memory_order_release);
+        preparedSampleRate.store(0.0);
+        preparedBufferSize.store(0);
+
         if (cb != nullptr)
             cb->audioDeviceStopped();
     }
@@ -496,12 +693,13 @@ bool VoicemeeterAudioIODevice::isPlaying()
 
 int VoicemeeterAudioIODevice::getCurrentBufferSizeSamples()
 {
-    return currentBufferSize;
+    // With re-blocking the graph is prepared for the fixed block size, not Voicemeeter's
+    return fixedBlockSize > 0 ? fixedBlockSize : currentBufferSize.load();
 }
 
 double VoicemeeterAudioIODevice::getCurrentSampleRate()
 {
-    return currentSampleRate;
+    return currentSampleRate.load();
 }
 
 int VoicemeeterAudioIODevice::getCurrentBitDepth()
@@ -511,12 +709,15 @@ int VoicemeeterAudioIODevice::getCurrentBitDepth()
 
 int VoicemeeterAudioIODevice::getOutputLatencyInSamples()
 {
-    return currentBufferSize;
+    // Voicemeeter's output buffer, the re-blocking FIFO and the longest
+    // wired path through the plugin graph
+    return currentBufferSize.load() + reblocker.getLatencySamples() + getGraphLatencySamples();
 }
 
 int VoicemeeterAudioIODevice::getInputLatencyInSamples()
 {
-    return currentBufferSize;
+    // Input reaches the graph one Voicemeeter buffer late
+    return currentBufferSize.load();
 }
 
 juce::BigInteger VoicemeeterAudioIODevice::getActiveOutputChannels() const
@@ -534,6 +735,23 @@ juce::String VoicemeeterAudioIODevice::getLastError()
     return lastError;
 }
 
+VoicemeeterAudioIODevice::RecoveryStats VoicemeeterAudioIODevice::getRecoveryStats() const noexcept
+{
+    return {numRecoveries.load(), lastRecoveryMs.load(), maxRecoveryMs.load()};
+}
+
+VoicemeeterAudioIODevice::ReconnectStats VoicemeeterAudioIODevice::getReconnectStats() const noexcept
+{
+    return {numReconnects.load(), numReconnectAttempts.load(), lastGapMs.load(), maxGapMs.load()};
+}
+
+long VoicemeeterAudioIODevice::getCallbackMode() const noexcept
+{
+    return insertPoint == InsertPoint::inputStrip ? VBVMR_AUDIOCALLBACK_IN
+         : insertPoint == InsertPoint::main       ? VBVMR_AUDIOCALLBACK_MAIN
+                                                  : VBVMR_AUDIOCALLBACK_OUT;
+}
+
 void VoicemeeterAudioIODevice::handleVoicemeeterCallback(long nCommand, void *lpData, long /*nnn*/)
 {
     switch (nCommand)
@@ -541,126 +759,420 @@ void VoicemeeterAudioIODevice::handleVoicemeeterCallback(long nCommand, void *lp
     case VBVMR_CBCOMMAND_STARTING:
     {
         auto *info = (VBVMR_LPT_AUDIOINFO)lpData;
-        currentSampleRate = (double)info->samplerate;
-        currentBufferSize = (int)info->nbSamplePerFrame;
-        VMLOG("STARTING: sr=" + juce::String(currentSampleRate) + " buf=" + juce::String(currentBufferSize));
-
-        // audioDeviceAboutToStart MUST be called on the message thread
-        // (it calls prepareToPlay which may allocate memory).
-        // Post it asynchronously; BUFFER callbacks may arrive before it runs
-        // but the player was already prepared in start(), so audio still flows.
-        auto flag = aliveFlag;
-        auto sr = currentSampleRate;
-        auto bs = currentBufferSize;
-        juce::MessageManager::callAsync([this, flag, sr, bs]()
-                                        {
-                if (! flag->load()) return;
-                auto* cb = juceCallback.load();
-                if (cb != nullptr)
-                {
-                    VMLOG ("STARTING async: audioDeviceAboutToStart sr=" + juce::String (sr)
-                           + " buf=" + juce::String (bs));
-                    cb->audioDeviceAboutToStart (this);
-                    VMLOG ("STARTING async: done");
-                } });
+        const double sampleRate = (double)info->samplerate;
+        const int bufferSize = (int)info->nbSamplePerFrame;
+        currentSampleRate.store(sampleRate);
+        currentBufferSize.store(bufferSize);
+
+        // nbi/nbo are not part of AUDIOINFO: resolve for the detected layout,
+        // the first buffer rebuilds the tables if Voicemeeter reports otherwise
+        channelMap.resolve(getNumBufferInputs(), getNumBufferOutputs());
+        reblocker.reset(bufferSize);
+
+        // Only the message thread leaves `preparing`, so while a prepare is in
+        // flight every STARTING supersedes it with a new generation
+        const auto status = streamStatus.load(std::memory_order_acquire);
+        const bool alreadyPrepared = stateOf(status) != StreamState::preparing
+                                     && preparedSampleRate.load() == sampleRate
+                                     && preparedBufferSize.load() == bufferSize;
+
+        if (alreadyPrepared)
+        {
+            streamStatus.store(packStatus(generationOf(status), StreamState::running), std::memory_order_release);
+            RTLOG_INFO("STARTING: sr={} buf={} (graph already prepared)", sampleRate, bufferSize);
+        }
+        else
+        {
+            // audioDeviceAboutToStart calls prepareToPlay, which may allocate:
+            // hold the output at silence until the message thread has run it
+            beginRecovery();
+            streamStatus.store(packStatus(generationOf(status) + 1, StreamState::preparing), std::memory_order_release);
+            triggerAsyncUpdate();
+            RTLOG_INFO("STARTING: sr={} buf={} -> re-prepare generation {}", sampleRate, bufferSize, (int)generationOf(status) + 1);
+        }
         break;
     }
 
     case VBVMR_CBCOMMAND_ENDING:
-        VMLOG("ENDING: Voicemeeter audio stream ended");
+        RTLOG_INFO("ENDING: Voicemeeter audio stream ended");
         break;
 
     case VBVMR_CBCOMMAND_CHANGE:
     {
-        // Audio stream parameters changed - restart the stream.
-        // Post to the message thread so we don't block the audio thread.
-        auto flag = aliveFlag;
-        juce::MessageManager::callAsync([this, flag]()
-                                        {
-                if (flag->load() && devicePlaying)
-                {
-                    auto& api = VoicemeeterAPI::getInstance();
-                    if (api.isAvailable())
-                        api.getInterface().VBVMR_AudioCallbackStart();
-                } });
+        channelMap.invalidate();
+
+        // The stream parameters changed and Voicemeeter stops streaming: nothing
+        // reaches the plugins until STARTING reports the new configuration.
+        // A prepare that is already in flight stays in charge of the state.
+        beginRecovery();
+        auto status = streamStatus.load(std::memory_order_acquire);
+        while (stateOf(status) == StreamState::running
+               && !streamStatus.compare_exchange_weak(status, packStatus(generationOf(status), StreamState::stopped), std::memory_order_acq_rel))
+        {
+        }
+
+        // AudioCallbackStart must not be called from inside the callback
+        restartPending.store(true);
+        triggerAsyncUpdate();
+        RTLOG_INFO("CHANGE: restarting the Voicemeeter stream");
         break;
     }
 
     case VBVMR_CBCOMMAND_BUFFER_IN:
     case VBVMR_CBCOMMAND_BUFFER_OUT:
+    case VBVMR_CBCOMMAND_BUFFER_MAIN:
     {
+        auto *buffer = (VBVMR_LPT_AUDIOBUFFER)lpData;
+        const int nbs = buffer->audiobuffer_nbs;
+
+        // Everything until the end of this case counts against Voicemeeter's deadline
+        const DeadlineMonitor::ScopedTimer deadlineTimer(deadlineMonitor, nbs, (double)buffer->audiobuffer_sr);
+
+        // Liveness for the watchdog; the first buffer after a lost connection closes the gap
+        const auto nowTicks = juce::Time::getHighResolutionTicks();
+        if (gapStartTicks.load(std::memory_order_relaxed) != 0)
+        {
+            if (const auto gapStart = gapStartTicks.exchange(0); gapStart != 0)
+            {
+                const double milliseconds = juce::Time::highResolutionTicksToSeconds(nowTicks - gapStart) * 1000.0;
+                lastGapMs.store(milliseconds);
+                if (milliseconds > maxGapMs.load())
+                    maxGapMs.store(milliseconds);
+                numReconnects.fetch_add(1);
+                RTLOG_INFO("reconnected: audio gap {} ms", milliseconds);
+            }
+        }
+        lastBufferTicks.store(nowTicks, std::memory_order_relaxed);
+        bufferCounter.store(bufferCounter.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
         auto *callback = juceCallback.load();
         if (callback == nullptr)
             break;
 
-        auto *buffer = (VBVMR_LPT_AUDIOBUFFER)lpData;
-        const int nbs = buffer->audiobuffer_nbs;
-        const int nbi = buffer->audiobuffer_nbi;
-        const int nbo = buffer->audiobuffer_nbo;
-        const int inBase = inputBusIndex * channelsPerBus;
-        const int outBase = outputBusIndex * channelsPerBus;
+        if (stateOf(streamStatus.load(std::memory_order_acquire)) != StreamState::running)
+        {
+            // The graph is not prepared for this stream: write silence without
+            // touching the buffers the message thread may be resizing
+            const float *inputPtrs[VoicemeeterChannelMap::maxChannels] = {};
+            float *outputPtrs[VoicemeeterChannelMap::maxChannels] = {};
+            channelMap.gather(*buffer, inputPtrs, outputPtrs, nullptr, nullptr);
+            for (int ch = 0; ch < channelMap.getOutput().numActive; ++ch)
+                if (outputPtrs[ch] != nullptr)
+                    juce::FloatVectorOperations::clear(outputPtrs[ch], nbs);
+            copyUntouchedBuses(*buffer);
+
+            ++silencedBuffers;
+            break;
+        }
+
+        if (recoveryStartTicks != 0)
+        {
+            const double milliseconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - recoveryStartTicks) * 1000.0;
+            lastRecoveryMs.store(milliseconds);
+            if (milliseconds > maxRecoveryMs.load())
+                maxRecoveryMs.store(milliseconds);
+            numRecoveries.fetch_add(1);
+            RTLOG_INFO("stream recovered in {} ms ({} buffers silenced)", milliseconds, silencedBuffers);
+            recoveryStartTicks = 0;
+        }
+
+        // Gather channel pointers from the precomputed tables; channels outside
+        // the buffer read silence and write to a discarded scratch buffer.
+        const float *inputPtrs[VoicemeeterChannelMap::maxChannels];
+        float *outputPtrs[VoicemeeterChannelMap::maxChannels];
+        const bool haveSubstitutes = nbs <= (int)silenceBuffer.size();
+        const bool rebuilt = channelMap.gather(*buffer, inputPtrs, outputPtrs,
+                                               haveSubstitutes ? silenceBuffer.data() : nullptr,
+                                               haveSubstitutes ? scratchBuffer.data() : nullptr);
 
-        // Log only on first few calls to avoid spam
-        static std::atomic<int> bufferCallCount{0};
-        if (bufferCallCount.fetch_add(1) < 3)
-            VMLOG("BUFFER nCommand=" + juce::String(nCommand) + " nbs=" + juce::String(nbs) + " nbi=" + juce::String(nbi) + " nbo=" + juce::String(nbo) + " inBase=" + juce::String(inBase) + " outBase=" + juce::String(outBase));
+        const int numActiveIn = channelMap.getInput().numActive;
+        const int numActiveOut = channelMap.getOutput().numActive;
 
-        // Check our bus channels are within the buffer range
-        const int availableIn = juce::jmin(channelsPerBus, juce::jmax(0, nbi - inBase));
-        const int availableOut = juce::jmin(channelsPerBus, juce::jmax(0, nbo - outBase));
+        if (rebuilt)
+            RTLOG_DEBUG("BUFFER channel map rebuilt nCommand={} nbs={} nbi={} nbo={} numActiveIn={} numActiveOut={}",
+                        nCommand, nbs, buffer->audiobuffer_nbi, buffer->audiobuffer_nbo, numActiveIn, numActiveOut);
 
-        if (availableIn <= 0 && availableOut <= 0)
+        copyUntouchedBuses(*buffer);
+
+        if (channelMap.isOutOfRange())
         {
-            VMLOG("WARNING: buses out of range inBase=" + juce::String(inBase) + " outBase=" + juce::String(outBase) + " nbi=" + juce::String(nbi) + " nbo=" + juce::String(nbo));
+            if (rebuilt)
+                RTLOG_WARNING("buses out of range inBase={} outBase={} nbi={} nbo={}",
+                              channelMap.getInput().base, channelMap.getOutput().base,
+                              buffer->audiobuffer_nbi, buffer->audiobuffer_nbo);
             break;
         }
 
-        // Build active channel pointer arrays for JUCE callback.
-        // Read from input bus, write to output bus (independent routing).
-        const float *inputPtrs[channelsPerBus] = {};
-        float *outputPtrs[channelsPerBus] = {};
-        int numActiveIn = 0;
-        int numActiveOut = 0;
+        if (reblocker.isActive())
+        {
+            // The graph always sees fixed blocks of reblocker.getBlockSize() samples
+            reblocker.process(inputPtrs, numActiveIn, outputPtrs, numActiveOut, nbs,
+                              [this, callback, numActiveIn, numActiveOut](const float *const *in, float *const *out, int numSamples)
+                              { renderBlock(callback, in, numActiveIn, out, numActiveOut, numSamples); });
+        }
+        else
+        {
+            renderBlock(callback, inputPtrs, numActiveIn, outputPtrs, numActiveOut, nbs);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
 
-        for (int ch : std::views::iota(0, channelsPerBus))
+void VoicemeeterAudioIODevice::renderBlock(juce::AudioIODeviceCallback *callback,
+                                           const float *const *inputs, int numInputs,
+                                           float *const *outputs, int numOutputs,
+                                           int numSamples)
+{
+    // Pass-through fast path: the graph is Input -> Output only
+    const bool wantPassThrough = passThroughRequested.load(std::memory_order_acquire);
+    if (wantPassThrough && passThroughActive)
+    {
+        copyThrough(inputs, numInputs, outputs, numOutputs, numSamples);
+        return;
+    }
+
+    // Entering or leaving pass-through: keep what the other mode would have
+    // produced and crossfade to it over this buffer
+    const bool crossfade = wantPassThrough != passThroughActive && numSamples <= dryBuffer.getNumSamples();
+    if (crossfade)
+    {
+        auto *const *dry = dryBuffer.getArrayOfWritePointers();
+        for (int ch = 0; ch < numOutputs; ++ch)
         {
-            if (activeInputChannels[ch])
-            {
-                float *r = nullptr;
-                if (ch < availableIn)
-                    r = buffer->audiobuffer_r[inBase + ch];
-                inputPtrs[numActiveIn++] = r;
-            }
+            if (ch < numInputs)
+                juce::FloatVectorOperations::copy(dry[ch], inputs[ch], numSamples);
+            else
+                juce::FloatVectorOperations::clear(dry[ch], numSamples);
         }
+    }
+
+    if (numInputs > 0 || numOutputs > 0)
+    {
+        juce::AudioIODeviceCallbackContext context;
+        callback->audioDeviceIOCallbackWithContext(
+            numInputs > 0 ? inputs : nullptr, numInputs,
+            numOutputs > 0 ? outputs : nullptr, numOutputs,
+            numSamples, context);
+    }
+
+    if (wantPassThrough != passThroughActive)
+    {
+        if (crossfade)
+            crossfadeToDry(outputs, numOutputs, dryBuffer, numSamples, wantPassThrough);
+        else if (wantPassThrough)
+            copyThrough(inputs, numInputs, outputs, numOutputs, numSamples);
+
+        passThroughActive = wantPassThrough;
+        RTLOG_DEBUG("pass-through {}", wantPassThrough ? "on" : "off");
+    }
+}
+
+int VoicemeeterAudioIODevice::getNumDeviceInputs() const noexcept
+{
+    return insertPoint == InsertPoint::main ? busLayout.getNumBusChannels() + busLayout.getNumStripChannels() : channelsPerBus;
+}
 
-        for (int ch : std::views::iota(0, channelsPerBus))
+int VoicemeeterAudioIODevice::getNumDeviceOutputs() const noexcept
+{
+    return insertPoint == InsertPoint::main ? busLayout.getNumBusChannels() : channelsPerBus;
+}
+
+int VoicemeeterAudioIODevice::getNumBufferInputs() const noexcept
+{
+    switch (insertPoint)
+    {
+    case InsertPoint::inputStrip:
+        return busLayout.getNumStripChannels();
+    case InsertPoint::main:
+        return busLayout.getNumStripChannels() + busLayout.getNumBusChannels();
+    default:
+        return busLayout.getNumBusChannels();
+    }
+}
+
+int VoicemeeterAudioIODevice::getNumBufferOutputs() const noexcept
+{
+    return insertPoint == InsertPoint::inputStrip ? busLayout.getNumStripChannels() : busLayout.getNumBusChannels();
+}
+
+void VoicemeeterAudioIODevice::copyUntouchedBuses(const VBVMR_T_AUDIOBUFFER &buffer) noexcept
+{
+    // MAIN mode: audiobuffer_r holds the strips and then the buses, audiobuffer_w the buses
+    const int busOffset = (int)buffer.audiobuffer_nbi - (int)buffer.audiobuffer_nbo;
+    if (busOffset < 0)
+        return;
+
+    for (const int ch : untouchedBusChannels)
+    {
+        if (ch >= buffer.audiobuffer_nbo)
+            break;
+
+        const float *source = buffer.audiobuffer_r[busOffset + ch];
+        float *destination = buffer.audiobuffer_w[ch];
+        if (source != destination)
+            juce::FloatVectorOperations::copy(destination, source, (int)buffer.audiobuffer_nbs);
+    }
+}
+
+void VoicemeeterAudioIODevice::beginRecovery() noexcept
+{
+    if (recoveryStartTicks == 0)
+    {
+        recoveryStartTicks = juce::Time::getHighResolutionTicks();
+        silencedBuffers = 0;
+    }
+}
+
+void VoicemeeterAudioIODevice::handleAsyncUpdate()
+{
+    if (restartPending.exchange(false) && devicePlaying)
+    {
+        auto &api = VoicemeeterAPI::getInstance();
+        if (api.isAvailable())
         {
-            if (activeOutputChannels[ch])
-            {
-                float *w = nullptr;
-                if (ch < availableOut)
-                    w = buffer->audiobuffer_w[outBase + ch];
-                outputPtrs[numActiveOut++] = w;
-            }
+            const long result = api.getInterface().VBVMR_AudioCallbackStart();
+            VMLOG("CHANGE: VBVMR_AudioCallbackStart() = " + juce::String(result));
         }
+    }
 
-        if (bufferCallCount.load() <= 3)
-            VMLOG("  numActiveIn=" + juce::String(numActiveIn) + " numActiveOut=" + juce::String(numActiveOut));
+    const auto status = streamStatus.load(std::memory_order_acquire);
+    if (stateOf(status) == StreamState::preparing)
+        prepareStream(generationOf(status));
+}
 
-        if (numActiveIn > 0 || numActiveOut > 0)
+void VoicemeeterAudioIODevice::timerCallback()
+{
+    if (!devicePlaying)
+        return;
+
+    const double now = juce::Time::getMillisecondCounterHiRes();
+    const auto count = bufferCounter.load(std::memory_order_acquire);
+    if (count != lastSeenBufferCount)
+    {
+        lastSeenBufferCount = count;
+        lastProgressMs = now;
+        if (reconnecting)
         {
-            juce::AudioIODeviceCallbackContext context;
-            callback->audioDeviceIOCallbackWithContext(
-                numActiveIn > 0 ? inputPtrs : nullptr, numActiveIn,
-                numActiveOut > 0 ? outputPtrs : nullptr, numActiveOut,
-                nbs, context);
+            VMLOG("watchdog: stream is back");
+            reconnecting = false;
         }
-        break;
+        return;
     }
 
-    default:
-        break;
+    auto &api = VoicemeeterAPI::getInstance();
+    if (!api.isAvailable())
+        return;
+
+    if (!reconnecting)
+    {
+        // IsParametersDirty: -1 = error, -2 = no server; it is optional in older DLLs
+        auto &vmr = api.getInterface();
+        const long dirty = vmr.VBVMR_IsParametersDirty != nullptr ? vmr.VBVMR_IsParametersDirty() : 0;
+        const double stalledMs = now - lastProgressMs;
+        if (dirty >= 0 && stalledMs < stallTimeoutMs)
+            return;
+
+        VMLOG("watchdog: connection lost (IsParametersDirty=" + juce::String(dirty) + ", no buffer for " + juce::String(stalledMs, 0) + " ms)");
+        reconnecting = true;
+        backoffMs = initialBackoffMs;
+        nextAttemptMs = now;
+
+        const auto lastTicks = lastBufferTicks.load(std::memory_order_relaxed);
+        gapStartTicks.store(lastTicks != 0 ? lastTicks : juce::Time::getHighResolutionTicks());
     }
+
+    if (now < nextAttemptMs)
+        return;
+
+    // Every attempt waits out its backoff: a successful start that still delivers
+    // no buffers is retried just like a failed one
+    numReconnectAttempts.fetch_add(1);
+    const bool started = reconnect();
+    VMLOG("watchdog: reconnect " + juce::String(started ? "started" : "failed") + ", next check in " + juce::String(backoffMs) + " ms");
+    nextAttemptMs = now + backoffMs;
+    backoffMs = juce::jmin(backoffMs * 2, maxBackoffMs);
+}
+
+bool VoicemeeterAudioIODevice::reconnect()
+{
+    auto &vmr = VoicemeeterAPI::getInstance().getInterface();
+
+    // juceCallback, the prepared configuration and the stream state stay as they
+    // are: STARTING finds the graph already prepared and resumes immediately
+    if (callbackRegistered)
+    {
+        vmr.VBVMR_AudioCallbackStop();
+        vmr.VBVMR_AudioCallbackUnregister();
+        callbackRegistered = false;
+    }
+
+    if (loggedIn)
+    {
+        vmr.VBVMR_Logout();
+        loggedIn = false;
+    }
+
+    const long loginResult = vmr.VBVMR_Login();
+    VMLOG("watchdog: VBVMR_Login() = " + juce::String(loginResult));
+    if (loginResult < 0)
+        return false;
+
+    loggedIn = true;
+    if (loginResult == 1)
+        return false; // Logged in, but Voicemeeter itself is not running yet
+
+    char clientName[64] = "LightHost";
+    const long regResult = vmr.VBVMR_AudioCallbackRegister(getCallbackMode(), voicemeeterStaticCallback, this, clientName);
+    VMLOG("watchdog: VBVMR_AudioCallbackRegister() = " + juce::String(regResult) + " clientName=" + juce::String(clientName));
+    if (regResult != 0)
+        return false;
+
+    callbackRegistered = true;
+
+    const long startResult = vmr.VBVMR_AudioCallbackStart();
+    VMLOG("watchdog: VBVMR_AudioCallbackStart() = " + juce::String(startResult));
+    return startResult == 0;
+}
+
+void VoicemeeterAudioIODevice::prepareStream(std::uint32_t generation)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    const double sampleRate = currentSampleRate.load();
+    const int bufferSize = currentBufferSize.load();
+
+    // Nothing on the audio thread reads these while the state is `preparing`
+    ensureBufferCapacity(bufferSize);
+
+    if (auto *callback = juceCallback.load())
+        callback->audioDeviceAboutToStart(this);
+
+    preparedSampleRate.store(sampleRate);
+    preparedBufferSize.store(bufferSize);
+
+    // Publish only if no STARTING arrived meanwhile; otherwise the newer
+    // generation has already queued its own prepare
+    auto expected = packStatus(generation, StreamState::preparing);
+    const bool published = streamStatus.compare_exchange_strong(expected, packStatus(generation, StreamState::running),
+                                                                std::memory_order_acq_rel);
+
+    const double milliseconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    VMLOG("prepareStream() generation=" + juce::String((int)generation) + " sr=" + juce::String(sampleRate) + " buf=" + juce::String(bufferSize)
+          + " took " + juce::String(milliseconds, 2) + " ms" + (published ? "" : " (superseded)"));
+}
+
+void VoicemeeterAudioIODevice::ensureBufferCapacity(int numSamples)
+{
+    const auto size = (size_t)juce::jmax(numSamples, minSubstituteBufferSize);
+    if (silenceBuffer.size() >= size)
+        return;
+
+    silenceBuffer.assign(size, 0.0f);
+    scratchBuffer.assign(size, 0.0f);
+    dryBuffer.setSize(juce::jmax(getNumDeviceInputs(), getNumDeviceOutputs()), (int)size);
 }
 
 //==============================================================================
@@ -678,7 +1190,7 @@ void VoicemeeterAudioIODeviceType::scanForDevices()
 {
     deviceNames.clear();
     deviceBusIndices.clear();
-    deviceIsInput.clear();
+    deviceInsertPoints.clear();
     voicemeeterType = 0;
 
     VMLOG("=== scanForDevices ===");
@@ -729,38 +1241,40 @@ void VoicemeeterAudioIODeviceType::scanForDevices()
 
     VMLOG("Final voicemeeterType = " + juce::String(voicemeeterType) + " (1=Standard, 2=Banana, 3=Potato)");
 
-    int numHwOut = 2, numVirtOut = 1;
-    switch (voicemeeterType)
-    {
-    case 1:
-        numHwOut = 2;
-        numVirtOut = 1;
-        break; // Standard:  A1+A2, B1
-    case 2:
-        numHwOut = 3;
-        numVirtOut = 2;
-        break; // Banana:    A1-A3, B1-B2
-    case 3:
-        numHwOut = 5;
-        numVirtOut = 3;
-        break; // Potato:    A1-A5, B1-B3
-    default:
-        break;
-    }
+    const auto layout = VoicemeeterLayout::forType(voicemeeterType);
+    const int numHwOut = layout.numHardwareBuses;
+    const int numVirtOut = layout.numVirtualBuses;
 
     // Add Output (hardware) buses
     for (int i = 0; i < numHwOut; ++i)
     {
         deviceNames.add("Output A" + juce::String(i + 1));
         deviceBusIndices.add(i);
-        deviceIsInput.add(false);
+        deviceInsertPoints.add(VoicemeeterAudioIODevice::InsertPoint::outputBus);
     }
     // Add Output (virtual) buses
     for (int i = 0; i < numVirtOut; ++i)
     {
         deviceNames.add("Output B" + juce::String(i + 1));
         deviceBusIndices.add(numHwOut + i);
-        deviceIsInput.add(false);
+        deviceInsertPoints.add(VoicemeeterAudioIODevice::InsertPoint::outputBus);
+    }
+    // Every strip and bus in one wide device (single MAIN-mode callback)
+    deviceNames.add("All Strips and Buses");
+    deviceBusIndices.add(0);
+    deviceInsertPoints.add(VoicemeeterAudioIODevice::InsertPoint::main);
+    // Add Input strips (hardware, then virtual) for pre-mixer insert
+    for (int i = 0; i < layout.numHardwareStrips; ++i)
+    {
+        deviceNames.add("Hardware Input " + juce::String(i + 1));
+        deviceBusIndices.add(i);
+        deviceInsertPoints.add(VoicemeeterAudioIODevice::InsertPoint::inputStrip);
+    }
+    for (int i = 0; i < layout.numVirtualStrips; ++i)
+    {
+        deviceNames.add("Virtual Input " + juce::String(i + 1));
+        deviceBusIndices.add(layout.numHardwareStrips + i);
+        deviceInsertPoints.add(VoicemeeterAudioIODevice::InsertPoint::inputStrip);
     }
 
     VMLOG("Device list: " + deviceNames.joinIntoString(", "));
@@ -806,6 +1320,17 @@ juce::AudioIODevice *VoicemeeterAudioIODeviceType::createDevice(const juce::Stri
     if (inIndex < 0)
         inIndex = outIndex;
 
+    // The output selection decides the insert point. Strips, buses and the
+    // MAIN device use different callback buffers, so an input of another kind
+    // is replaced by the output itself.
+    const int insertIndex = outIndex >= 0 ? outIndex : inIndex;
+    const auto insertPoint = insertIndex >= 0 ? deviceInsertPoints[insertIndex] : VoicemeeterAudioIODevice::InsertPoint::outputBus;
+    if (inIndex >= 0 && insertIndex >= 0 && deviceInsertPoints[inIndex] != insertPoint)
+    {
+        VMLOG("createDevice input " + deviceNames[inIndex] + " cannot feed " + deviceNames[insertIndex] + ", using the output itself");
+        inIndex = insertIndex;
+    }
+
     // Use output bus name as device name (shown in audio settings)
     juce::String devName = outIndex >= 0 ? deviceNames[outIndex] : deviceNames[inIndex];
     juce::String inName = inIndex >= 0 ? deviceNames[inIndex] : devName;
@@ -814,7 +1339,9 @@ juce::AudioIODevice *VoicemeeterAudioIODeviceType::createDevice(const juce::Stri
 
     VMLOG("createDevice outBus=" + devName + "(" + juce::String(outBus) + ")" + " inBus=" + inName + "(" + juce::String(inBus) + ")");
 
-    return new VoicemeeterAudioIODevice(devName, inName, inBus, outBus);
+    auto *device = new VoicemeeterAudioIODevice(devName, inName, inBus, outBus, VoicemeeterLayout::forType(voicemeeterType), insertPoint);
+    device->setFixedBlockSize(fixedBlockSize);
+    return device;
 }
 
-#endif // JUCE_WINDOWS
+#endif // JUCE_WINDOWS || LIGHTHOST_VOICEMEETER_STANDIN
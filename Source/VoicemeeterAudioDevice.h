@@ -8,6 +8,8 @@
  * - 使用 Voicemeeter Remote API 進行音頻處理
  * - 通過輸出總線插入點實現音頻效果處理
  * - 支援多個 Voicemeeterr 總線（A1-A5）
+ * - 也可插入在輸入條（麥克風等）進入 Voicemeeter 混音器之前
+ * - MAIN 模式以單一回調、單次圖形處理同時服務所有輸入條與總線
  *
  * Voicemeeter 背景：
  * Voicemeeter 是功能強大的虛擬音頻混音機，允許：
@@ -27,17 +29,29 @@
  * - Windows 平台專用
  * - 需要安裝 Voicemeeter
  * - 自動檢測 registry 查找 Voicemeeter 安裝位置
+ * - 定義 LIGHTHOST_VOICEMEETER_STANDIN=1 時改為連結本地 stand-in，
+ *   可在 Linux 上無頭執行（見 Benchmarks/）
  */
 
 #pragma once
 
 #include "JuceHeader.h"
 
-#if JUCE_WINDOWS // Windows 平台專用
+#ifndef LIGHTHOST_VOICEMEETER_STANDIN
+#define LIGHTHOST_VOICEMEETER_STANDIN 0
+#endif
+
+#if JUCE_WINDOWS || LIGHTHOST_VOICEMEETER_STANDIN // Windows 平台專用（或 stand-in 建置）
 
 #include "VoicemeeterRemote.h"
+#include "VoicemeeterLayout.h"
+#include "VoicemeeterChannelMap.h"
+#include "VoicemeeterReblocker.h"
+#include "DeadlineMonitor.h"
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 // ==================== VoicemeeterAPI 單例類別 ====================
 
@@ -200,10 +214,39 @@ private:
  * - 提供 JUCE AudioIODevice 標準介面
  * - 支援不同的採樣率和緩衝區大小
  * - 非同步音頻回調處理
+ *
+ * 串流狀態（STARTING / CHANGE 時的重新準備）：
+ * - stopped：尚未開始或 Voicemeeter 已送出 CHANGE，BUFFER 輸出靜音
+ * - preparing：STARTING 帶來新的採樣率或緩衝區大小，訊息執行緒正在重新準備圖形，
+ *   BUFFER 輸出靜音且不呼叫外掛
+ * - running：圖形已依目前配置準備好，BUFFER 正常處理
+ * 狀態與世代編號存放在同一個原子變數中；只有與目前世代相符的準備結果才會切換為 running
+ *
+ * 連線看門狗（Voicemeeter 重新啟動或引擎重設）：
+ * - 播放期間每 watchdogIntervalMs 檢查一次 VBVMR_IsParametersDirty 與回調是否仍在進行
+ * - 伺服器離線（< 0）或超過 stallTimeoutMs 沒有任何緩衝區時視為連線失效
+ * - 失效後重新 Logout / Login / AudioCallbackRegister / AudioCallbackStart，
+ *   失敗則以指數退避（initialBackoffMs 起，最多 maxBackoffMs）重試
+ * - 重新連線期間不呼叫 audioDeviceStopped()，圖形保持已準備狀態；
+ *   STARTING 帶回相同配置時直接恢復處理
+ * - 音頻中斷時間（最後一個緩衝區到恢復後第一個緩衝區）記錄在 getReconnectStats()
  */
-class VoicemeeterAudioIODevice : public juce::AudioIODevice
+class VoicemeeterAudioIODevice : public juce::AudioIODevice,
+                                 private juce::AsyncUpdater,
+                                 private juce::Timer
 {
 public:
+    /**
+     * InsertPoint 列舉
+     * 外掛鏈插入 Voicemeeter 的位置
+     */
+    enum class InsertPoint
+    {
+        outputBus,  // VBVMR_AUDIOCALLBACK_OUT：輸出總線（A1..An、B1..Bn）
+        inputStrip, // VBVMR_AUDIOCALLBACK_IN：輸入條，在混音器之前處理
+        main        // VBVMR_AUDIOCALLBACK_MAIN：所有輸入條與總線合為一個多通道設備
+    };
+
     /**
      * VoicemeeterAudioIODevice 建構子
      *
@@ -219,11 +262,18 @@ public:
      *                      用於 Voicemeeter API 調用
      * @param outputBusIndex 輸出總線索引（A1~A5 對應 0~4）
      *                       用於音頻回調的主線索引
+     * @param busLayout 偵測到的 Voicemeeter 總線配置
+     *                  用於在 open() 時預先建立通道對照表
+     * @param insertPoint 插入輸出總線、輸入條或 MAIN；輸入條模式下兩個索引都是輸入條索引，
+     *                    MAIN 模式下索引不使用：
+     *                    輸出通道 = 所有總線，輸入通道 = 所有總線（處理前）後接所有輸入條
      */
     VoicemeeterAudioIODevice(const juce::String &outputBusName,
                              const juce::String &inputBusName,
                              int inputBusIndex,
-                             int outputBusIndex);
+                             int outputBusIndex,
+                             VoicemeeterLayout busLayout = {},
+                             InsertPoint insertPoint = InsertPoint::outputBus);
 
     /**
      * ~VoicemeeterAudioIODevice 解構子
@@ -402,8 +452,16 @@ public:
     [[nodiscard]] int getCurrentBufferSizeSamples() override;
     [[nodiscard]] double getCurrentSampleRate() override;
     [[nodiscard]] int getCurrentBitDepth() override;
+
+    /**
+     * getOutputLatencyInSamples() 方法
+     * 輸出延遲 = Voicemeeter 緩衝區 + 重新分塊延遲 + 圖形最長路徑的外掛延遲
+     *
+     * 與 getInputLatencyInSamples()（一個 Voicemeeter 緩衝區）相加即為往返延遲
+     */
     [[nodiscard]] int getOutputLatencyInSamples() override;
     [[nodiscard]] int getInputLatencyInSamples() override;
+
     [[nodiscard]] juce::BigInteger getActiveOutputChannels() const override;
     [[nodiscard]] juce::BigInteger getActiveInputChannels() const override;
     [[nodiscard]] juce::String getLastError() override;
@@ -411,15 +469,185 @@ public:
     /** Returns the selected input/output bus names for index lookup. */
     [[nodiscard]] const juce::String &getInputBusName() const noexcept { return inputBusName; }
     [[nodiscard]] const juce::String &getOutputBusName() const { return getName(); }
+    [[nodiscard]] InsertPoint getInsertPoint() const noexcept { return insertPoint; }
+
+    /**
+     * setPassThrough() 方法
+     * 告知設備目前的圖形等同直通（Input -> Output，沒有啟用中的外掛）
+     *
+     * 直通時 BUFFER 回調不再呼叫 AudioProcessorPlayer：
+     * - 輸入與輸出指向同一緩衝區（原地插入）時不做任何事
+     * - 否則直接複製輸入到輸出
+     * 進入或離開直通的那個緩衝區會在處理結果與原始輸入之間交叉淡化，避免爆音
+     *
+     * 可在任何執行緒呼叫；下一個緩衝區生效
+     *
+     * @param shouldPassThrough true 表示略過圖形處理
+     */
+    void setPassThrough(bool shouldPassThrough) noexcept { passThroughRequested.store(shouldPassThrough, std::memory_order_release); }
+    [[nodiscard]] bool isPassThrough() const noexcept { return passThroughRequested.load(std::memory_order_acquire); }
+
+    /**
+     * setGraphLatencySamples() 方法
+     * 告知設備目前圖形（渲染器）的延遲，計入 getOutputLatencyInSamples()
+     * 設備不依賴回調的具體型別：AudioDeviceManager 註冊的是它自己的回調
+     *
+     * 可在任何執行緒呼叫
+     */
+    void setGraphLatencySamples(int numSamples) noexcept { graphLatencySamples.store(juce::jmax(0, numSamples), std::memory_order_relaxed); }
+
+    /**
+     * setFixedBlockSize() 方法
+     * 啟用重新分塊：圖形固定以 blockSize 個樣本處理，與 Voicemeeter 的區塊大小無關
+     *
+     * - 0 表示停用（圖形直接使用 Voicemeeter 的區塊大小）
+     * - 增加的延遲為 blockSize - gcd(Voicemeeter 區塊大小, blockSize)，
+     *   並反映在 getOutputLatencyInSamples()
+     * - 下一次 open() 時生效
+     *
+     * @param blockSize 固定區塊大小（建議為 2 的次方），或 0
+     */
+    void setFixedBlockSize(int blockSize) noexcept { fixedBlockSize = juce::jmax(0, blockSize); }
+    [[nodiscard]] int getFixedBlockSize() const noexcept { return fixedBlockSize; }
+
+    /**
+     * RecoveryStats 結構
+     * 從串流中斷（CHANGE 或需要重新準備的 STARTING）到第一個正常處理的緩衝區之間的時間
+     */
+    struct RecoveryStats
+    {
+        int numRecoveries = 0;
+        double lastMilliseconds = 0.0;
+        double maxMilliseconds = 0.0;
+    };
+
+    /** 取得重新準備的恢復時間統計（任何執行緒） */
+    [[nodiscard]] RecoveryStats getRecoveryStats() const noexcept;
+
+    /**
+     * ReconnectStats 結構
+     * 看門狗重新連線的次數、嘗試次數與音頻中斷時間
+     */
+    struct ReconnectStats
+    {
+        int numReconnects = 0;
+        int numAttempts = 0;
+        double lastGapMilliseconds = 0.0;
+        double maxGapMilliseconds = 0.0;
+    };
+
+    /** 取得看門狗重新連線統計（任何執行緒） */
+    [[nodiscard]] ReconnectStats getReconnectStats() const noexcept;
+
+    /** 每次 BUFFER 回調相對於緩衝區週期的耗時統計（open() 時清除） */
+    [[nodiscard]] DeadlineMonitor &getDeadlineMonitor() noexcept { return deadlineMonitor; }
 
     /** Called from the static Voicemeeter callback on the audio thread. */
     void handleVoicemeeterCallback(long nCommand, void *lpData, long nnn);
 
 private:
+    enum class StreamState : std::uint32_t
+    {
+        stopped = 0,
+        preparing = 1,
+        running = 2
+    };
+
+    // streamStatus = (generation << 2) | state
+    [[nodiscard]] static constexpr std::uint32_t packStatus(std::uint32_t generation, StreamState state) noexcept
+    {
+        return (generation << 2) | (std::uint32_t)state;
+    }
+    [[nodiscard]] static constexpr StreamState stateOf(std::uint32_t status) noexcept { return (StreamState)(status & 3u); }
+    [[nodiscard]] static constexpr std::uint32_t generationOf(std::uint32_t status) noexcept { return status >> 2; }
+
+    /**
+     * handleAsyncUpdate() 方法
+     * 訊息執行緒：CHANGE 後重新啟動串流，並執行待處理的重新準備
+     */
+    void handleAsyncUpdate() override;
+
+    /**
+     * timerCallback() 方法
+     * 訊息執行緒：連線看門狗，偵測失效並依退避時間重新連線
+     */
+    void timerCallback() override;
+
+    /**
+     * reconnect() 方法
+     * 訊息執行緒：重新登入、註冊並啟動回調；不改動 JUCE 回調與串流狀態
+     *
+     * @return true 如果 AudioCallbackStart 成功
+     */
+    bool reconnect();
+
+    /** 依插入點選擇 VBVMR_AUDIOCALLBACK_IN / OUT / MAIN */
+    [[nodiscard]] long getCallbackMode() const noexcept;
+
+    /**
+     * prepareStream() 方法
+     * 訊息執行緒：依目前的採樣率與緩衝區大小重新準備圖形，
+     * 若期間沒有新的 STARTING，則原子地切換為 running
+     *
+     * @param generation 觸發此次準備的世代編號
+     */
+    void prepareStream(std::uint32_t generation);
+
+    /** 確保替代緩衝區與交叉淡化緩衝區至少能容納 numSamples（訊息執行緒，串流未處理時） */
+    void ensureBufferCapacity(int numSamples);
+
+    /** 設備提供給 JUCE 的通道數（單一總線或輸入條為 8；MAIN 為全部） */
+    [[nodiscard]] int getNumDeviceInputs() const noexcept;
+    [[nodiscard]] int getNumDeviceOutputs() const noexcept;
+
+    /** 預期的回調緩衝區通道數（audiobuffer_nbi / audiobuffer_nbo） */
+    [[nodiscard]] int getNumBufferInputs() const noexcept;
+    [[nodiscard]] int getNumBufferOutputs() const noexcept;
+
+    /** MAIN 模式：把圖形未輸出的總線通道原樣複製（音頻執行緒） */
+    void copyUntouchedBuses(const VBVMR_T_AUDIOBUFFER &buffer) noexcept;
+
+    /** 音頻執行緒：記錄恢復時間的起點（已在計時中則不變） */
+    void beginRecovery() noexcept;
+
+    /**
+     * renderBlock() 方法
+     * 處理一個區塊：直通、交叉淡化或呼叫 JUCE 回調（音頻執行緒）
+     */
+    void renderBlock(juce::AudioIODeviceCallback *callback,
+                     const float *const *inputs, int numInputs,
+                     float *const *outputs, int numOutputs,
+                     int numSamples);
+
+    /** setGraphLatencySamples() 設定的圖形延遲 */
+    [[nodiscard]] int getGraphLatencySamples() const noexcept { return graphLatencySamples.load(std::memory_order_relaxed); }
+
     static constexpr int channelsPerBus = 8;
     int inputBusIndex = 0;
     int outputBusIndex = 0;
     juce::String inputBusName;
+    VoicemeeterLayout busLayout;
+    InsertPoint insertPoint = InsertPoint::outputBus;
+
+    // Precomputed audiobuffer_r / audiobuffer_w indices, owned by the audio thread once started
+    VoicemeeterChannelMap channelMap;
+
+    // MAIN mode: bus channels without an active output (filled in open())
+    std::vector<int> untouchedBusChannels;
+
+    // Stand-ins for channels that fall outside the Voicemeeter buffer (sized in open())
+    static constexpr int minSubstituteBufferSize = 4096;
+    std::vector<float> silenceBuffer;
+    std::vector<float> scratchBuffer;
+
+    // Pass-through fast path: requested by the message thread, applied by the audio thread
+    std::atomic<bool> passThroughRequested{false};
+    bool passThroughActive = false;
+    juce::AudioBuffer<float> dryBuffer; // Input copy for the one-buffer crossfade (sized in open())
+
+    // Optional fixed-size re-blocking between Voicemeeter and the graph (0 = off)
+    int fixedBlockSize = 0;
+    VoicemeeterReblocker reblocker;
 
     bool deviceOpen = false;
     bool devicePlaying = false;
@@ -431,12 +659,53 @@ private:
     juce::BigInteger activeInputChannels;
     juce::BigInteger activeOutputChannels;
 
-    double currentSampleRate = 48000.0;
-    int currentBufferSize = 512;
+    // Voicemeeter's current stream configuration (written by STARTING on the audio thread)
+    std::atomic<double> currentSampleRate{48000.0};
+    std::atomic<int> currentBufferSize{512};
+    std::atomic<int> graphLatencySamples{0}; // Pushed by the host whenever the renderer's latency changes
     juce::String lastError;
 
-    // Flag for safe async restart on CHANGE command
-    std::shared_ptr<std::atomic<bool>> aliveFlag = std::make_shared<std::atomic<bool>>(true);
+    // Stream state machine, see the class comment
+    std::atomic<std::uint32_t> streamStatus{packStatus(0, StreamState::stopped)};
+    std::atomic<bool> restartPending{false};
+
+    // Configuration the graph was last prepared for (0 = not prepared)
+    std::atomic<double> preparedSampleRate{0.0};
+    std::atomic<int> preparedBufferSize{0};
+
+    // Recovery timing: start is owned by the audio thread, results are read anywhere
+    juce::int64 recoveryStartTicks = 0;
+    int silencedBuffers = 0;
+    std::atomic<int> numRecoveries{0};
+    std::atomic<double> lastRecoveryMs{0.0};
+    std::atomic<double> maxRecoveryMs{0.0};
+
+    // Callback time against the buffer period, written by the audio thread
+    DeadlineMonitor deadlineMonitor;
+
+    // Connection watchdog, see the class comment
+    static constexpr int watchdogIntervalMs = 250;
+    static constexpr int stallTimeoutMs = 2000;
+    static constexpr int initialBackoffMs = 500;
+    static constexpr int maxBackoffMs = 8000;
+
+    // Liveness, written by the audio thread on every buffer
+    std::atomic<std::uint32_t> bufferCounter{0};
+    std::atomic<juce::int64> lastBufferTicks{0};
+    // Set by the watchdog when the connection is lost, consumed by the first buffer after it
+    std::atomic<juce::int64> gapStartTicks{0};
+
+    // Watchdog state, message thread only
+    std::uint32_t lastSeenBufferCount = 0;
+    double lastProgressMs = 0.0;
+    bool reconnecting = false;
+    int backoffMs = initialBackoffMs;
+    double nextAttemptMs = 0.0;
+
+    std::atomic<int> numReconnects{0};
+    std::atomic<int> numReconnectAttempts{0};
+    std::atomic<double> lastGapMs{0.0};
+    std::atomic<double> maxGapMs{0.0};
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoicemeeterAudioIODevice)
 };
@@ -444,9 +713,9 @@ private:
 //==============================================================================
 /**
     AudioIODeviceType for Voicemeeter integration.
-    Lists available Voicemeeter output buses as selectable audio devices.
-    Automatically detects the installed Voicemeeter variant
-    (Standard, Banana, or Potato) and exposes the corresponding buses.
+    Lists available Voicemeeter output buses and input strips as selectable
+    audio devices, plus one MAIN-mode device exposing all of them at once. Automatically detects the installed Voicemeeter variant
+    (Standard, Banana, or Potato) and exposes the corresponding buses/strips.
 */
 class VoicemeeterAudioIODeviceType : public juce::AudioIODeviceType
 {
@@ -462,13 +731,18 @@ public:
     [[nodiscard]] juce::AudioIODevice *createDevice(const juce::String &outputDeviceName,
                                                     const juce::String &inputDeviceName) override;
 
+    /** Fixed graph block size applied to devices created from now on (0 = off). */
+    void setFixedBlockSize(int blockSize) noexcept { fixedBlockSize = juce::jmax(0, blockSize); }
+    [[nodiscard]] int getFixedBlockSize() const noexcept { return fixedBlockSize; }
+
 private:
     juce::StringArray deviceNames;
     juce::Array<int> deviceBusIndices;
-    juce::Array<bool> deviceIsInput;
+    juce::Array<VoicemeeterAudioIODevice::InsertPoint> deviceInsertPoints;
     int voicemeeterType = 0;
+    int fixedBlockSize = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoicemeeterAudioIODeviceType)
 };
 
-#endif // JUCE_WINDOWS
+#endif // JUCE_WINDOWS || LIGHTHOST_VOICEMEETER_STANDIN
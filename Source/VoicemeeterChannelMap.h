@@ -0,0 +1,235 @@
+/*
+ * VoicemeeterChannelMap.h
+ * LightHost - Voicemeeter 緩衝區通道指標對照表
+ *
+ * 功能說明：
+ * - 在 open() 與 VBVMR_CBCOMMAND_STARTING / CHANGE 時預先計算
+ *   「JUCE 通道 -> audiobuffer_r / audiobuffer_w 索引」對照表
+ * - 每次 BUFFER 回調只需收集指標，不再測試 juce::BigInteger 位元
+ * - 對連續的 2 通道與 8 通道配置提供特化路徑
+ * - 單一匯流排（8 通道）或 MAIN 模式的整個緩衝區（最多 128 通道）皆可描述
+ * - 純 C++、固定大小陣列，不配置記憶體，可在音頻執行緒上重建
+ */
+
+#pragma once
+
+#include "VoicemeeterRemote.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+
+/**
+ * VoicemeeterChannelMap 類別
+ *
+ * 使用方式：
+ * 1. setSelection()：設定每個 JUCE 通道對應的緩衝區索引與啟用的通道（訊息執行緒，open() 時）
+ * 2. resolve()：依緩衝區實際的 nbi / nbo 建立對照表（open()、STARTING、CHANGE）
+ * 3. gather()：每次 BUFFER 回調時收集指標；若 nbi / nbo 與對照表不符會先重建
+ */
+class VoicemeeterChannelMap
+{
+public:
+    static constexpr int channelsPerBus = 8; // 每條匯流排的通道數
+    static constexpr int maxChannels = 128;  // audiobuffer_r / audiobuffer_w 的容量
+
+    using Mask = std::bitset<maxChannels>;
+
+    /**
+     * Kind 列舉
+     * 單一方向（輸入或輸出）的收集方式
+     */
+    enum class Kind
+    {
+        none,   // 沒有啟用的通道
+        stereo, // 2 個啟用通道，索引連續且在範圍內：base, base+1
+        octet,  // 8 個啟用通道，索引連續且在範圍內：base .. base+7
+        generic // 任意組合，逐一查表（超出範圍者以 -1 表示）
+    };
+
+    /**
+     * Direction 結構
+     * 單一方向的預先計算結果
+     */
+    struct Direction
+    {
+        Kind kind = Kind::none;
+        int numActive = 0;
+        int base = 0;
+        int numAvailable = 0;          // 選取的通道中在緩衝區內實際存在的數量
+        int index[maxChannels] = {};   // audiobuffer 索引；-1 = 超出緩衝區範圍
+    };
+
+    /**
+     * setSelection() 方法
+     * 設定使用的匯流排與啟用的通道（單一 8 通道匯流排）
+     *
+     * @param inputBase  輸入匯流排第一個通道在 audiobuffer_r 中的索引
+     * @param outputBase 輸出匯流排第一個通道在 audiobuffer_w 中的索引
+     * @param inputMask  啟用的輸入通道位元（bit n = 通道 n）
+     * @param outputMask 啟用的輸出通道位元
+     */
+    void setSelection(int inputBase, int outputBase, std::uint32_t inputMask, std::uint32_t outputMask) noexcept
+    {
+        int inputSlots[channelsPerBus], outputSlots[channelsPerBus];
+        for (int ch = 0; ch < channelsPerBus; ++ch)
+        {
+            inputSlots[ch] = inputBase + ch;
+            outputSlots[ch] = outputBase + ch;
+        }
+
+        const std::uint32_t busMask = (1u << channelsPerBus) - 1u;
+        setSelection(inputSlots, channelsPerBus, Mask(inputMask & busMask),
+                     outputSlots, channelsPerBus, Mask(outputMask & busMask));
+    }
+
+    /**
+     * setSelection() 方法
+     * 以明確的索引表設定每個 JUCE 通道對應的緩衝區通道
+     *
+     * @param inputSlots  JUCE 輸入通道 n 在 audiobuffer_r 中的索引
+     * @param numInputs   inputSlots 的長度（最多 maxChannels）
+     * @param inputMask   啟用的輸入通道
+     * @param outputSlots JUCE 輸出通道 n 在 audiobuffer_w 中的索引
+     * @param numOutputs  outputSlots 的長度（最多 maxChannels）
+     * @param outputMask  啟用的輸出通道
+     */
+    void setSelection(const int *inputSlots, int numInputs, const Mask &inputMask,
+                      const int *outputSlots, int numOutputs, const Mask &outputMask) noexcept
+    {
+        numInSlots = std::clamp(numInputs, 0, maxChannels);
+        numOutSlots = std::clamp(numOutputs, 0, maxChannels);
+        std::copy(inputSlots, inputSlots + numInSlots, inSlots);
+        std::copy(outputSlots, outputSlots + numOutSlots, outSlots);
+        inMask = inputMask;
+        outMask = outputMask;
+        invalidate();
+    }
+
+    /** 讓下一次 gather() 依實際緩衝區重新建立對照表 */
+    void invalidate() noexcept
+    {
+        resolvedNbi = -1;
+        resolvedNbo = -1;
+    }
+
+    /**
+     * resolve() 方法
+     * 依緩衝區通道數建立對照表
+     *
+     * @param nbi audiobuffer_nbi
+     * @param nbo audiobuffer_nbo
+     */
+    void resolve(int nbi, int nbo) noexcept
+    {
+        resolvedNbi = nbi;
+        resolvedNbo = nbo;
+        build(input, inSlots, numInSlots, inMask, nbi);
+        build(output, outSlots, numOutSlots, outMask, nbo);
+    }
+
+    [[nodiscard]] bool matches(int nbi, int nbo) const noexcept { return nbi == resolvedNbi && nbo == resolvedNbo; }
+
+    [[nodiscard]] const Direction &getInput() const noexcept { return input; }
+    [[nodiscard]] const Direction &getOutput() const noexcept { return output; }
+
+    /** 匯流排完全不在緩衝區內（兩個方向都沒有可用通道） */
+    [[nodiscard]] bool isOutOfRange() const noexcept { return input.numAvailable <= 0 && output.numAvailable <= 0; }
+
+    /**
+     * gather() 方法
+     * 收集 JUCE 回調使用的通道指標
+     *
+     * 超出緩衝區範圍的通道：輸入指向 silence（全零），輸出指向 scratch（丟棄）
+     *
+     * @return true 如果對照表是新建立的（nbi / nbo 改變）
+     */
+    bool gather(const VBVMR_T_AUDIOBUFFER &buffer, const float **inputs, float **outputs,
+                const float *silence, float *scratch) noexcept
+    {
+        const bool rebuilt = !matches((int)buffer.audiobuffer_nbi, (int)buffer.audiobuffer_nbo);
+        if (rebuilt)
+            resolve((int)buffer.audiobuffer_nbi, (int)buffer.audiobuffer_nbo);
+
+        gatherDirection(input, buffer.audiobuffer_r, inputs, silence);
+        gatherDirection(output, buffer.audiobuffer_w, outputs, scratch);
+        return rebuilt;
+    }
+
+private:
+    static void build(Direction &d, const int *slots, int numSlots, const Mask &mask, int numBufferChannels) noexcept
+    {
+        d.numAvailable = 0;
+        d.numActive = 0;
+        bool contiguous = true;
+
+        for (int ch = 0; ch < numSlots; ++ch)
+        {
+            const bool inRange = slots[ch] >= 0 && slots[ch] < numBufferChannels;
+            if (inRange)
+                ++d.numAvailable;
+
+            if (!mask[(size_t)ch])
+                continue;
+
+            const int index = inRange ? slots[ch] : -1;
+            if (index < 0 || (d.numActive > 0 && index != d.index[d.numActive - 1] + 1))
+                contiguous = false;
+            d.index[d.numActive++] = index;
+        }
+
+        d.base = d.numActive > 0 ? d.index[0] : 0;
+
+        if (d.numActive == 0)
+            d.kind = Kind::none;
+        else if (contiguous && d.numActive == 2)
+            d.kind = Kind::stereo;
+        else if (contiguous && d.numActive == 8)
+            d.kind = Kind::octet;
+        else
+            d.kind = Kind::generic;
+    }
+
+    template <typename Destination>
+    static void gatherDirection(const Direction &d, float *const *source, Destination *dest, Destination fallback) noexcept
+    {
+        switch (d.kind)
+        {
+        case Kind::stereo:
+            dest[0] = source[d.base];
+            dest[1] = source[d.base + 1];
+            break;
+
+        case Kind::octet:
+        {
+            float *const *first = source + d.base;
+            dest[0] = first[0];
+            dest[1] = first[1];
+            dest[2] = first[2];
+            dest[3] = first[3];
+            dest[4] = first[4];
+            dest[5] = first[5];
+            dest[6] = first[6];
+            dest[7] = first[7];
+            break;
+        }
+
+        case Kind::generic:
+            for (int i = 0; i < d.numActive; ++i)
+            {
+                const int index = d.index[i];
+                dest[i] = index >= 0 ? source[index] : fallback;
+            }
+            break;
+
+        case Kind::none:
+            break;
+        }
+    }
+
+    Direction input, output;
+    int inSlots[maxChannels] = {}, outSlots[maxChannels] = {};
+    int numInSlots = 0, numOutSlots = 0;
+    Mask inMask, outMask;
+    int resolvedNbi = -1, resolvedNbo = -1;
+};
@@ -0,0 +1,54 @@
+/*
+ * VoicemeeterLayout.h
+ * LightHost - Voicemeeter 各版本的總線配置
+ *
+ * 功能說明：
+ * - 描述 Standard / Banana / Potato 的輸出總線與輸入條（strip）數量
+ * - 由 VoicemeeterAudioIODeviceType（列出設備）與 stand-in（產生緩衝區）共用，
+ *   確保兩者對 audiobuffer_nbi / audiobuffer_nbo 的理解一致
+ */
+
+#pragma once
+
+/**
+ * VoicemeeterLayout 結構
+ *
+ * 每條總線固定 8 個通道；輸出插入（VBVMR_AUDIOCALLBACK_OUT）模式下
+ * audiobuffer_r / audiobuffer_w 依序排列 A1..An、B1..Bn 的所有通道
+ *
+ * 輸入插入（VBVMR_AUDIOCALLBACK_IN）模式下則依序排列所有輸入條，
+ * 硬體輸入條與虛擬輸入條同樣各佔 8 個通道
+ */
+struct VoicemeeterLayout
+{
+    static constexpr int channelsPerBus = 8;
+
+    int numHardwareBuses = 2; // A1..An
+    int numVirtualBuses = 1;  // B1..Bn
+    int numHardwareStrips = 2; // Hardware Input 1..n
+    int numVirtualStrips = 1;  // Virtual Input 1..n
+
+    [[nodiscard]] constexpr int getNumBuses() const noexcept { return numHardwareBuses + numVirtualBuses; }
+    [[nodiscard]] constexpr int getNumBusChannels() const noexcept { return getNumBuses() * channelsPerBus; }
+    [[nodiscard]] constexpr int getNumStrips() const noexcept { return numHardwareStrips + numVirtualStrips; }
+    [[nodiscard]] constexpr int getNumStripChannels() const noexcept { return getNumStrips() * channelsPerBus; }
+
+    /**
+     * forType() 方法
+     * 依 Voicemeeter 類型取得總線配置
+     *
+     * @param voicemeeterType 1 = Standard, 2 = Banana, 3 = Potato；其他值視為 Standard
+     */
+    [[nodiscard]] static constexpr VoicemeeterLayout forType(int voicemeeterType) noexcept
+    {
+        switch (voicemeeterType)
+        {
+        case 2:
+            return {3, 2, 3, 2}; // Banana:    A1-A3, B1-B2, 3 hardware + 2 virtual inputs
+        case 3:
+            return {5, 3, 5, 3}; // Potato:    A1-A5, B1-B3, 5 hardware + 3 virtual inputs
+        default:
+            return {2, 1, 2, 1}; // Standard:  A1+A2, B1, 2 hardware + 1 virtual input
+        }
+    }
+};
@@ -0,0 +1,81 @@
+/*
+ * VoicemeeterReblocker.cpp
+ * LightHost - 固定區塊大小的重新分塊 FIFO 實作
+ */
+
+#include "VoicemeeterReblocker.h"
+
+void VoicemeeterReblocker::prepare(int numChannels, int newBlockSize)
+{
+    blockSize = juce::jmax(0, newBlockSize);
+    latency.store(0, std::memory_order_relaxed);
+
+    if (blockSize == 0)
+    {
+        inputBlock.setSize(0, 0);
+        outputBlock.setSize(0, 0);
+        outputRing.setSize(0, 0);
+        return;
+    }
+
+    inputBlock.setSize(numChannels, blockSize);
+    outputBlock.setSize(numChannels, blockSize);
+    outputRing.setSize(numChannels, blockSize * 2);
+    reset(blockSize);
+}
+
+void VoicemeeterReblocker::reset(int hostBlockSize) noexcept
+{
+    if (blockSize == 0)
+        return;
+
+    const int newLatency = latencyFor(hostBlockSize, blockSize);
+    latency.store(newLatency, std::memory_order_relaxed);
+
+    inputBlock.clear();
+    outputBlock.clear();
+    outputRing.clear();
+    inputFill = 0;
+    ringRead = 0;
+    ringCount = newLatency; // Prefilled with silence
+}
+
+void VoicemeeterReblocker::pushOutput(int numOutputs) noexcept
+{
+    const int capacity = outputRing.getNumSamples();
+    jassert(ringCount + blockSize <= capacity);
+
+    const int writePosition = (ringRead + ringCount) % capacity;
+    const int first = juce::jmin(blockSize, capacity - writePosition);
+
+    for (int ch = 0; ch < numOutputs; ++ch)
+    {
+        outputRing.copyFrom(ch, writePosition, outputBlock, ch, 0, first);
+        if (first < blockSize)
+            outputRing.copyFrom(ch, 0, outputBlock, ch, first, blockSize - first);
+    }
+
+    ringCount = juce::jmin(capacity, ringCount + blockSize);
+}
+
+void VoicemeeterReblocker::popOutput(float *const *outputs, int numOutputs, int offset, int numSamples) noexcept
+{
+    const int capacity = outputRing.getNumSamples();
+    const int available = juce::jmin(numSamples, ringCount);
+    const int first = juce::jmin(available, capacity - ringRead);
+
+    for (int ch = 0; ch < numOutputs; ++ch)
+    {
+        float *destination = outputs[ch] + offset;
+        juce::FloatVectorOperations::copy(destination, outputRing.getReadPointer(ch, ringRead), first);
+        if (first < available)
+            juce::FloatVectorOperations::copy(destination + first, outputRing.getReadPointer(ch, 0), available - first);
+
+        // Cannot happen with the latency from latencyFor(), but never leave stale samples behind
+        if (available < numSamples)
+            juce::FloatVectorOperations::clear(destination + available, numSamples - available);
+    }
+
+    ringRead = (ringRead + available) % capacity;
+    ringCount -= available;
+}
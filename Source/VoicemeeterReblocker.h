@@ -0,0 +1,105 @@
+/*
+ * VoicemeeterReblocker.h
+ * LightHost - 固定區塊大小的重新分塊 FIFO
+ *
+ * 功能說明：
+ * - Voicemeeter 每次回調的樣本數 N 取決於其引擎設定（例如 48 kHz 時為 480）
+ * - 部分外掛在奇數或變動的區塊大小下效率較差或行為異常
+ * - 本類別在 Voicemeeter 緩衝區與圖形之間插入 FIFO，讓圖形永遠以固定的 B 個樣本處理
+ *
+ * 延遲：
+ * - 每收滿 B 個輸入樣本就立即處理，輸出 FIFO 預先填入 L 個零
+ * - 不發生欠載所需的最小 L = B - gcd(N, B)
+ *   例如 N = 480、B = 512 -> L = 480；N = 1024、B = 256 -> L = 0
+ * - 輸出 FIFO 內容永遠不超過 L + B <= 2B，與 N 無關
+ *
+ * 執行緒：
+ * - prepare() 會配置記憶體，只能在訊息執行緒（open()）呼叫
+ * - reset() 與 process() 不配置記憶體，可在音頻執行緒呼叫
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <atomic>
+#include <numeric>
+
+class VoicemeeterReblocker
+{
+public:
+    /** 計算將 N 樣本的回調重新分塊為 B 樣本所需的最小延遲 */
+    [[nodiscard]] static constexpr int latencyFor(int hostBlockSize, int blockSize) noexcept
+    {
+        return (hostBlockSize > 0 && blockSize > 0) ? blockSize - std::gcd(hostBlockSize, blockSize) : 0;
+    }
+
+    /**
+     * prepare() 方法
+     * 配置緩衝區；blockSize <= 0 表示停用重新分塊
+     *
+     * @param numChannels 最大通道數
+     * @param blockSize   圖形使用的固定區塊大小 B
+     */
+    void prepare(int numChannels, int blockSize);
+
+    /**
+     * reset() 方法
+     * 依 Voicemeeter 目前的區塊大小 N 重新計算延遲並清空 FIFO（音頻執行緒安全）
+     */
+    void reset(int hostBlockSize) noexcept;
+
+    [[nodiscard]] bool isActive() const noexcept { return blockSize > 0; }
+    [[nodiscard]] int getBlockSize() const noexcept { return blockSize; }
+    /** 目前的延遲；reset() 在音頻執行緒更新，可在任何執行緒讀取 */
+    [[nodiscard]] int getLatencySamples() const noexcept { return latency.load(std::memory_order_relaxed); }
+
+    /**
+     * process() 方法
+     * 將 numSamples 個輸入樣本送入 FIFO，每收滿 B 個樣本呼叫一次 processBlock，
+     * 並從輸出 FIFO 取出 numSamples 個樣本
+     *
+     * @param processBlock 簽名為 void(const float* const* in, float* const* out, int numSamples)
+     */
+    template <typename ProcessBlock>
+    void process(const float *const *inputs, int numInputs,
+                 float *const *outputs, int numOutputs,
+                 int numSamples, ProcessBlock &&processBlock) noexcept
+    {
+        numInputs = juce::jmin(numInputs, inputBlock.getNumChannels());
+        numOutputs = juce::jmin(numOutputs, outputBlock.getNumChannels());
+
+        for (int position = 0; position < numSamples;)
+        {
+            const int chunk = juce::jmin(numSamples - position, blockSize - inputFill);
+
+            for (int ch = 0; ch < numInputs; ++ch)
+                juce::FloatVectorOperations::copy(inputBlock.getWritePointer(ch, inputFill), inputs[ch] + position, chunk);
+            inputFill += chunk;
+
+            if (inputFill == blockSize)
+            {
+                processBlock(inputBlock.getArrayOfReadPointers(), outputBlock.getArrayOfWritePointers(), blockSize);
+                pushOutput(numOutputs);
+                inputFill = 0;
+            }
+
+            popOutput(outputs, numOutputs, position, chunk);
+            position += chunk;
+        }
+    }
+
+private:
+    void pushOutput(int numOutputs) noexcept;
+    void popOutput(float *const *outputs, int numOutputs, int offset, int numSamples) noexcept;
+
+    int blockSize = 0;
+    std::atomic<int> latency{0}; // Audio thread (reset) -> device latency queries
+
+    juce::AudioBuffer<float> inputBlock;  // B samples being collected
+    juce::AudioBuffer<float> outputBlock; // Graph output for one block
+    juce::AudioBuffer<float> outputRing;  // 2B-sample ring holding delayed output
+    int inputFill = 0;
+    int ringRead = 0;
+    int ringCount = 0;
+};
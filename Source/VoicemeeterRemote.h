@@ -20,6 +20,16 @@
 
 #pragma once
 
+// 非 Windows 平台（例如 Linux 上的 stand-in 基準測試）沒有 __stdcall 呼叫約定
+#if !defined(_WIN32) && !defined(__stdcall)
+#define __stdcall
+#endif
+
+// 1 = 直接連結本地 stand-in 實作，而非從 registry 載入 VoicemeeterRemote DLL
+#ifndef LIGHTHOST_VOICEMEETER_STANDIN
+#define LIGHTHOST_VOICEMEETER_STANDIN 0
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -400,6 +410,28 @@ extern "C"
         T_VBVMR_AudioCallbackUnregister VBVMR_AudioCallbackUnregister;
     } T_VBVMR_INTERFACE; // ==================== API 函數結構結束 ====================
 
+#if LIGHTHOST_VOICEMEETER_STANDIN
+    // ==================== 直接連結入口點 ====================
+
+    /**
+     * 與 DLL 匯出同名的函數宣告
+     *
+     * 只在 LIGHTHOST_VOICEMEETER_STANDIN 建置中使用：
+     * 由 Benchmarks/VoicemeeterRemoteStandIn.cpp 提供實作，
+     * 讓 VoicemeeterAPI 無需 Windows 與 Voicemeeter 即可運作
+     */
+    long __stdcall VBVMR_Login(void);
+    long __stdcall VBVMR_Logout(void);
+    long __stdcall VBVMR_GetVoicemeeterType(long *pType);
+    long __stdcall VBVMR_GetVoicemeeterVersion(long *pVersion);
+    long __stdcall VBVMR_IsParametersDirty(void);
+    long __stdcall VBVMR_AudioCallbackRegister(long mode, T_VBVMR_VBAUDIOCALLBACK pCallback,
+                                               void *lpUser, char szClientName[64]);
+    long __stdcall VBVMR_AudioCallbackStart(void);
+    long __stdcall VBVMR_AudioCallbackStop(void);
+    long __stdcall VBVMR_AudioCallbackUnregister(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,146 @@
+/*
+ * WireChannelMap.h
+ * LightHost - 連線的通道對照（來源通道 -> 目的通道）
+ *
+ * 功能說明：
+ * - 每條 NodeWire 帶有一組通道路由，取代固定的立體聲（0 -> 0、1 -> 1）
+ * - 例如 1-2 -> 3-4、或 Voicemeeter 匯流排的全部 8 個通道（7.1）
+ * - 通道索引為 AudioProcessorGraph 節點的通道索引（從 0 起算，跨所有匯流排）
+ * - 序列化格式："0>0 1>1"（工作階段儲存用）；顯示格式："1-2 → 3-4"（從 1 起算）
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+#include <algorithm>
+#include <vector>
+
+struct WireChannelMap
+{
+    struct Route
+    {
+        int source = 0;
+        int destination = 0;
+
+        bool operator==(const Route &other) const noexcept = default;
+    };
+
+    std::vector<Route> routes;
+
+    /** 預設：立體聲 0 -> 0、1 -> 1（舊工作階段沒有通道資訊時使用） */
+    [[nodiscard]] static WireChannelMap stereo() { return straight(0, 0, 2); }
+
+    /** 連續的 numChannels 個通道：firstSource.. -> firstDestination.. */
+    [[nodiscard]] static WireChannelMap straight(int firstSource, int firstDestination, int numChannels)
+    {
+        WireChannelMap map;
+        for (int ch = 0; ch < numChannels; ++ch)
+            map.routes.push_back({firstSource + ch, firstDestination + ch});
+        return map;
+    }
+
+    [[nodiscard]] bool isEmpty() const noexcept { return routes.empty(); }
+    [[nodiscard]] bool isStereo() const { return *this == stereo(); }
+
+    /** 需要的來源輸出通道數 / 目的輸入通道數（最大索引 + 1） */
+    [[nodiscard]] int getNumSourceChannels() const noexcept
+    {
+        int count = 0;
+        for (const auto &route : routes)
+            count = std::max(count, route.source + 1);
+        return count;
+    }
+
+    [[nodiscard]] int getNumDestinationChannels() const noexcept
+    {
+        int count = 0;
+        for (const auto &route : routes)
+            count = std::max(count, route.destination + 1);
+        return count;
+    }
+
+    /** 序列化為 "0>0 1>1" */
+    [[nodiscard]] juce::String toString() const
+    {
+        juce::StringArray tokens;
+        for (const auto &route : routes)
+            tokens.add(juce::String(route.source) + ">" + juce::String(route.destination));
+        return tokens.joinIntoString(" ");
+    }
+
+    /** 解析 toString() 的格式；空字串或無效內容回傳立體聲 */
+    [[nodiscard]] static WireChannelMap fromString(const juce::String &text)
+    {
+        WireChannelMap map;
+        for (const auto &token : juce::StringArray::fromTokens(text, " ,", {}))
+        {
+            if (!token.containsChar('>'))
+                continue;
+            const int source = token.upToFirstOccurrenceOf(">", false, false).getIntValue();
+            const int destination = token.fromFirstOccurrenceOf(">", false, false).getIntValue();
+            if (source >= 0 && destination >= 0)
+                map.routes.push_back({source, destination});
+        }
+        return map.isEmpty() ? stereo() : map;
+    }
+
+    /**
+     * parseDescription() 函數
+     * 解析使用者輸入的 "1-2>3-4"、"1-8"、"1>2, 2>1" 等（從 1 起算）
+     * 只寫一邊表示來源與目的相同；兩邊通道數不同時回傳空對照
+     */
+    [[nodiscard]] static WireChannelMap parseDescription(const juce::String &text)
+    {
+        auto parseRange = [](const juce::String &range, int &first, int &count)
+        {
+            const auto trimmed = range.trim();
+            first = trimmed.upToFirstOccurrenceOf("-", false, false).getIntValue() - 1;
+            const int last = trimmed.containsChar('-') ? trimmed.fromFirstOccurrenceOf("-", false, false).getIntValue() - 1 : first;
+            count = last - first + 1;
+            return first >= 0 && count > 0;
+        };
+
+        WireChannelMap map;
+        for (const auto &part : juce::StringArray::fromTokens(text.replace(juce::CharPointer_UTF8("\xe2\x86\x92"), ">"), ",", {}))
+        {
+            const auto sourceText = part.upToFirstOccurrenceOf(">", false, false);
+            const auto destinationText = part.containsChar('>') ? part.fromFirstOccurrenceOf(">", false, false) : sourceText;
+
+            int source = 0, numSources = 0, destination = 0, numDestinations = 0;
+            if (!parseRange(sourceText, source, numSources) || !parseRange(destinationText, destination, numDestinations)
+                || numSources != numDestinations)
+                return {};
+
+            for (int ch = 0; ch < numSources; ++ch)
+                map.routes.push_back({source + ch, destination + ch});
+        }
+        return map;
+    }
+
+    /** 顯示用文字，連續的路由合併為範圍，例如 "1-2 → 3-4" */
+    [[nodiscard]] juce::String describe() const
+    {
+        auto range = [](int first, int count)
+        { return count == 1 ? juce::String(first + 1) : juce::String(first + 1) + "-" + juce::String(first + count); };
+
+        juce::StringArray parts;
+        for (size_t i = 0; i < routes.size();)
+        {
+            size_t run = 1;
+            while (i + run < routes.size()
+                   && routes[i + run].source == routes[i].source + (int)run
+                   && routes[i + run].destination == routes[i].destination + (int)run)
+                ++run;
+
+            const auto &first = routes[i];
+            parts.add(first.source == first.destination
+                          ? range(first.source, (int)run)
+                          : range(first.source, (int)run) + juce::String(juce::CharPointer_UTF8(" \xe2\x86\x92 ")) + range(first.destination, (int)run));
+            i += run;
+        }
+        return parts.joinIntoString(", ");
+    }
+
+    bool operator==(const WireChannelMap &other) const = default;
+};
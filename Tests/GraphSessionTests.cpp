@@ -0,0 +1,186 @@
+/*
+ * GraphSessionTests.cpp
+ * LightHost - GraphSession 的單元測試
+ *
+ * 以測試用的外掛格式（LightHostTest）建立立體聲直通實例，不需要任何外掛檔案。
+ * 執行 "LightHost" 類別的所有 juce::UnitTest；有失敗時回傳 1
+ *
+ * 用法：
+ *   LightHostTests
+ */
+
+#include "JuceHeader.h"
+#include "GraphSession.h"
+
+namespace
+{
+    /** 立體聲直通的外掛實例；狀態只有一個位元組 */
+    class TestPluginInstance : public juce::AudioPluginInstance
+    {
+    public:
+        explicit TestPluginInstance(const juce::PluginDescription &descriptionToUse)
+            : AudioPluginInstance(BusesProperties()
+                                      .withInput("Input", juce::AudioChannelSet::stereo())
+                                      .withOutput("Output", juce::AudioChannelSet::stereo())),
+              description(descriptionToUse)
+        {
+        }
+
+        void fillInPluginDescription(juce::PluginDescription &d) const override { d = description; }
+        const juce::String getName() const override { return description.name; }
+
+        void prepareToPlay(double, int) override {}
+        void releaseResources() override {}
+        void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override {}
+
+        double getTailLengthSeconds() const override { return 0.0; }
+        bool acceptsMidi() const override { return false; }
+        bool producesMidi() const override { return false; }
+        juce::AudioProcessorEditor *createEditor() override { return nullptr; }
+        bool hasEditor() const override { return false; }
+
+        int getNumPrograms() override { return 1; }
+        int getCurrentProgram() override { return 0; }
+        void setCurrentProgram(int) override {}
+        const juce::String getProgramName(int) override { return {}; }
+        void changeProgramName(int, const juce::String &) override {}
+
+        void getStateInformation(juce::MemoryBlock &destData) override { destData.append(&value, 1); }
+        void setStateInformation(const void *data, int sizeInBytes) override
+        {
+            if (sizeInBytes > 0)
+                value = *static_cast<const char *>(data);
+        }
+
+    private:
+        juce::PluginDescription description;
+        char value = 1;
+    };
+
+    /** 依描述的名稱建立 TestPluginInstance 的外掛格式；不掃描任何路徑 */
+    class TestPluginFormat : public juce::AudioPluginFormat
+    {
+    public:
+        static juce::PluginDescription describe(const juce::String &name)
+        {
+            juce::PluginDescription d;
+            d.name = name;
+            d.pluginFormatName = "LightHostTest";
+            d.fileOrIdentifier = name;
+            d.uniqueId = d.deprecatedUid = name.hashCode();
+            d.numInputChannels = d.numOutputChannels = 2;
+            return d;
+        }
+
+        juce::String getName() const override { return "LightHostTest"; }
+        void findAllTypesForFile(juce::OwnedArray<juce::PluginDescription> &, const juce::String &) override {}
+        bool fileMightContainThisPluginType(const juce::String &) override { return false; }
+        juce::String getNameOfPluginFromIdentifier(const juce::String &identifier) override { return identifier; }
+        bool pluginNeedsRescanning(const juce::PluginDescription &) override { return false; }
+        bool doesPluginStillExist(const juce::PluginDescription &) override { return true; }
+        bool canScanForPlugins() const override { return false; }
+        bool isTrivialToScan() const override { return true; }
+        juce::StringArray searchPathsForPlugins(const juce::FileSearchPath &, bool, bool) override { return {}; }
+        juce::FileSearchPath getDefaultLocationsToSearch() override { return {}; }
+
+    private:
+        void createPluginInstance(const juce::PluginDescription &description, double, int,
+                                  PluginCreationCallback callback) override
+        {
+            callback(std::make_unique<TestPluginInstance>(description), {});
+        }
+
+        bool requiresUnblockedMessageThreadDuringCreation(const juce::PluginDescription &) const override { return false; }
+    };
+
+    //==============================================================================
+    class GraphSessionUndoTests : public juce::UnitTest
+    {
+    public:
+        GraphSessionUndoTests() : juce::UnitTest("GraphSession undo remove", "LightHost") {}
+
+        void runTest() override
+        {
+            // Without the cache undo re-creates the instance; with it, undo takes the parked node back
+            for (const int maxInstances : {0, 8})
+            {
+                beginTest("Undo brings back a wired and an unwired plugin (cache " + juce::String(maxInstances) + ")");
+
+                juce::AudioProcessorGraph graph;
+                juce::AudioPluginFormatManager formatManager;
+                formatManager.addFormat(new TestPluginFormat());
+                juce::KnownPluginList knownPlugins;
+
+                GraphSession session(graph, formatManager, knownPlugins);
+                PluginInstanceCache::Limits limits;
+                limits.maxInstances = maxInstances;
+                session.getInstanceCache().setLimits(limits);
+                session.resetGraph();
+
+                const int input = session.addDeviceNode("Input", NodeType::Input, {0, 0});
+                const int output = session.addDeviceNode("Output", NodeType::Output, {400, 0});
+
+                juce::String error;
+                const int wired = session.addPlugin(TestPluginFormat::describe("Wired"), {200, 0}, error);
+                const int unwired = session.addPlugin(TestPluginFormat::describe("Unwired"), {200, 200}, error);
+                expect(wired > 0 && unwired > 0, error);
+
+                expect(session.addWire(input, wired));
+                expect(session.addWire(wired, output));
+                session.setWireGain(wired, output, -6.0f);
+
+                session.removeNode(unwired);
+                session.removeNode(wired);
+                expect(session.findNode(wired) == nullptr && session.findNode(unwired) == nullptr);
+                expect(session.getWires().empty());
+
+                // Most recent removal first, each exactly once
+                expectEquals(session.undoRemoveNode(error), wired, error);
+                expectNodeInGraph(session, graph, wired, juce::Point<int>(200, 0));
+                expectEquals((int)session.getWires().size(), 2);
+                expect(session.findWire(input, wired) != nullptr);
+                const auto *gainWire = session.findWire(wired, output);
+                expect(gainWire != nullptr);
+                if (gainWire != nullptr)
+                    expectWithinAbsoluteError(gainWire->gainDecibels, -6.0f, 1.0e-4f);
+                expect(!graph.getConnections().empty());
+
+                expectEquals(session.undoRemoveNode(error), unwired, error);
+                expectNodeInGraph(session, graph, unwired, juce::Point<int>(200, 200));
+                expectEquals((int)session.getWires().size(), 2);
+
+                expect(!session.canUndoRemoveNode());
+                expectEquals(session.undoRemoveNode(error), -1);
+            }
+        }
+
+    private:
+        void expectNodeInGraph(const GraphSession &session, const juce::AudioProcessorGraph &graph, int nodeId,
+                               juce::Point<int> pos)
+        {
+            const auto *node = session.findNode(nodeId);
+            expect(node != nullptr, "node " + juce::String(nodeId) + " missing");
+            if (node == nullptr)
+                return;
+
+            expect(node->pos == pos);
+            expect(graph.getNodeForId(node->graphNodeId) != nullptr, "node " + juce::String(nodeId) + " has no graph node");
+        }
+    };
+
+    GraphSessionUndoTests graphSessionUndoTests;
+} // namespace
+
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("LightHost");
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        if (runner.getResult(i)->failures > 0)
+            return 1;
+    return 0;
+}